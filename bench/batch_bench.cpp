@@ -0,0 +1,139 @@
+#include "bench.h"
+#include "signal_kernels.h"
+#include "sma_crossover_strategy.h"
+#include "rsi_strategy.h"
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace {
+
+// per-bar reference: a fresh strategy walked over bars [first, last)
+std::vector<Signal> perBar(Strategy& strategy, const MarketData& data, size_t first, size_t last) {
+    std::vector<Signal> signals(last - first);
+    for (size_t i = first; i < last; i++) {
+        signals[i - first] = strategy.analyze(data, i);
+    }
+    return signals;
+}
+
+size_t countMismatches(const std::vector<Signal>& a, const std::vector<Signal>& b) {
+    size_t mismatches = a.size() > b.size() ? a.size() - b.size() : b.size() - a.size();
+    for (size_t i = 0; i < a.size() && i < b.size(); i++) {
+        mismatches += a[i] != b[i];
+    }
+    return mismatches;
+}
+
+// make(true) reads its series from the IndicatorCache, make(false) runs the fused kernel
+using StrategyMaker = std::function<std::unique_ptr<Strategy>(bool cached)>;
+
+void printRow(const char* path, double barsPerSecond, double speedup, size_t mismatches) {
+    std::cout << std::left << std::setw(18) << "" << std::setw(8) << path << std::right
+              << std::fixed << std::setprecision(1) << std::setw(10) << barsPerSecond / 1e6
+              << std::setw(9) << speedup << "x"
+              << std::setw(10) << mismatches << std::defaultfloat << std::endl;
+}
+
+// analyzeAll, a flat-price series and a mid-series range against the per-bar path
+size_t checkIdentical(const StrategyMaker& make, bool cached, const MarketData& data, const MarketData& flatData,
+                      const std::vector<Signal>& reference) {
+    size_t rows = data.size();
+    size_t mismatches = countMismatches(make(cached)->analyzeAll(data), reference);
+
+    // prices on a coarse grid, so flat bars and all-gain/all-loss windows happen
+    mismatches += countMismatches(make(cached)->analyzeAll(flatData), perBar(*make(false), flatData, 0, flatData.size()));
+
+    // a range starting mid-series rebuilds exactly like analyze() does
+    size_t first = rows / 3;
+    size_t last = first + rows / 5;
+    std::vector<Signal> range(last - first);
+    make(cached)->analyzeRange(data, first, last, range.data());
+    mismatches += countMismatches(range, perBar(*make(false), data, first, last));
+    return mismatches;
+}
+
+void benchStrategy(const char* name, const StrategyMaker& make,
+                   const MarketData& data, const MarketData& flatData) {
+    size_t rows = data.size();
+    std::vector<Signal> reference;
+    double perBarSeconds = bestOf(2, [&] {
+        std::unique_ptr<Strategy> strategy = make(false);
+        reference = perBar(*strategy, data, 0, rows);
+    });
+    std::cout << std::left << std::setw(18) << name << std::setw(8) << "per-bar" << std::right
+              << std::fixed << std::setprecision(1) << std::setw(10) << rows / perBarSeconds / 1e6
+              << std::setw(10) << "" << std::defaultfloat << std::endl;
+
+    SignalKernels::Level supported = SignalKernels::supportedLevel();
+    for (int level = 0; level <= static_cast<int>(supported); level++) {
+        SignalKernels::setLevel(static_cast<SignalKernels::Level>(level));
+
+        double batchSeconds = bestOf(3, [&] {
+            benchSink = static_cast<double>(make(false)->analyzeAll(data).back());
+        });
+        size_t mismatches = checkIdentical(make, false, data, flatData, reference);
+        printRow(SignalKernels::levelName(static_cast<SignalKernels::Level>(level)), rows / batchSeconds,
+                 perBarSeconds / batchSeconds, mismatches);
+    }
+    SignalKernels::setLevel(supported);
+
+    // through the IndicatorCache: "cold" computes the series, "warm" finds them
+    double coldSeconds = bestOf(3, [&] {
+        data.indicatorCache().clear();
+        benchSink = static_cast<double>(make(true)->analyzeAll(data).back());
+    });
+    double warmSeconds = bestOf(3, [&] {
+        benchSink = static_cast<double>(make(true)->analyzeAll(data).back());
+    });
+    size_t mismatches = checkIdentical(make, true, data, flatData, reference);
+    printRow("cold", rows / coldSeconds, perBarSeconds / coldSeconds, mismatches);
+    printRow("warm", rows / warmSeconds, perBarSeconds / warmSeconds, mismatches);
+    data.indicatorCache().clear();
+}
+
+}
+
+void runBatchBench(size_t rows) {
+    MarketData data(makeRandomWalkBars(rows), MarketData::Layout::Columns);
+
+    std::vector<Bar> flatBars = makeRandomWalkBars(rows, 7);
+    for (Bar& bar : flatBars) {
+        bar.close = std::round(bar.close);
+    }
+    MarketData flatData(flatBars, MarketData::Layout::Columns);
+
+    std::cout << "cpu supports " << SignalKernels::levelName(SignalKernels::supportedLevel()) << std::endl;
+    std::cout << std::left << std::setw(18) << "strategy" << std::setw(8) << "path" << std::right
+              << std::setw(10) << "Mbars/s" << std::setw(10) << "speedup" << std::setw(10) << "sig.diff" << std::endl;
+
+    for (int period : {5, 50, 200}) {
+        std::string name = "SMA(" + std::to_string(period) + "," + std::to_string(period * 2) + ")";
+        benchStrategy(name.c_str(), [period](bool cached) {
+            auto strategy = std::unique_ptr<SMACrossoverStrategy>(new SMACrossoverStrategy(period, period * 2));
+            strategy->setIndicatorCache(cached);
+            return std::unique_ptr<Strategy>(std::move(strategy));
+        }, data, flatData);
+    }
+    for (int period : {5, 14, 200}) {
+        std::string name = "RSI(" + std::to_string(period) + ")";
+        benchStrategy(name.c_str(), [period](bool cached) {
+            auto strategy = std::unique_ptr<RSIStrategy>(new RSIStrategy(period));
+            strategy->setIndicatorCache(cached);
+            return std::unique_ptr<Strategy>(std::move(strategy));
+        }, data, flatData);
+    }
+
+    // Layout::Rows has to gather the closes first
+    MarketData rowData(makeRandomWalkBars(rows), MarketData::Layout::Rows);
+    SMACrossoverStrategy crossover(50, 100);
+    crossover.setIndicatorCache(false);
+    double seconds = bestOf(3, [&] {
+        benchSink = static_cast<double>(crossover.analyzeAll(rowData).back());
+    });
+    std::cout << "\nSMA(50,100) on Layout::Rows: " << std::fixed << std::setprecision(1)
+              << rows / seconds / 1e6 << " Mbars/s" << std::defaultfloat << std::endl;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "market_data.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// deterministic random walk bars so runs are comparable without data files
+std::vector<Bar> makeRandomWalkBars(size_t rows, uint64_t seed = 42);
+
+// synthetic OHLCV from geometric Brownian motion, one minute bars. Symbol s
+// of a universe draws from its own PathRandom stream, so every series only
+// depends on (seed, s) and not on how many symbols are generated
+struct SyntheticSpec {
+    size_t rows = 100000;        // bars per symbol
+    size_t symbols = 1;
+    uint64_t seed = 42;
+    double start = 100.0;
+    double drift = 0.0;          // per bar
+    double volatility = 0.002;   // per bar
+};
+std::vector<Bar> makeGBMBars(const SyntheticSpec& spec, size_t symbol = 0);
+std::vector<std::vector<Bar>> makeGBMUniverse(const SyntheticSpec& spec);
+
+// "timestamp,open,high,low,close,volume" rows like the data/ files
+bool writeCsv(const std::string& file, const std::vector<Bar>& bars, bool newestFirst = false);
+
+// --symbols, for the groups that generate a universe
+extern size_t benchSymbols;
+
+// one line of the --json report: `stage` of the running group over `rows`
+// bars took `seconds`, stored as ns/bar and rows/s. --compare checks the
+// ns/bar of every stage against the same stage in a saved report
+void recordResult(const std::string& stage, size_t rows, double seconds);
+
+// keeps results alive so the optimiser can't drop the measured loop
+extern volatile double benchSink;
+
+// operator new calls made by the whole process so far, counted by the
+// replacement global operator new in bench_main.cpp
+size_t allocationCount();
+
+// best wall time of `repeats` runs, in seconds
+template <typename Fn>
+double bestOf(int repeats, Fn&& fn) {
+    double best = 1e300;
+    for (int i = 0; i < repeats; i++) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (seconds < best) {
+            best = seconds;
+        }
+    }
+    return best;
+}
+
+// one function per benchmark group, each prints its own table
+void runLayoutBench(size_t rows);
+void runIndicatorBench(size_t rows);
+void runBatchBench(size_t rows);
+void runSweepBench(size_t rows);
+void runEngineBench(size_t rows);
+void runEventsBench(size_t rows);
+void runLedgerBench(size_t rows);
+void runStaticBench(size_t rows);
+void runStreamBench(size_t rows);
+void runUniverseBench(size_t rows);
+void runPortfolioBench(size_t rows);
+void runTopKBench(size_t rows);
+void runWalkForwardBench(size_t rows);
+void runMonteCarloBench(size_t rows);
+void runStageBench(size_t rows);
+void runProfileBench(size_t rows);
+void runReplayBench(size_t rows);
+void runResampleBench(size_t rows);
+void runPriceBench(size_t rows);
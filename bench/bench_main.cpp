@@ -0,0 +1,325 @@
+#include "bench.h"
+#include "monte_carlo.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <new>
+#include <sstream>
+#include <string>
+
+volatile double benchSink = 0.0;
+size_t benchSymbols = 4;
+
+namespace {
+
+std::atomic<size_t> allocations{0};
+
+struct BenchResult {
+    std::string name;  // "group/stage"
+    size_t rows;
+    double nsPerBar;
+    double rowsPerSecond;
+};
+
+std::vector<BenchResult> results;
+std::string currentGroup;
+
+bool writeReport(const std::string& file, size_t rows) {
+    std::ofstream out(file);
+    if (!out) {
+        return false;
+    }
+    out << "{\n  \"rows\": " << rows << ",\n  \"symbols\": " << benchSymbols << ",\n  \"results\": [";
+    out << std::setprecision(6);
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& result = results[i];
+        out << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << result.name << "\", \"rows\": " << result.rows
+            << ", \"ns_per_bar\": " << result.nsPerBar << ", \"rows_per_s\": " << result.rowsPerSecond << "}";
+    }
+    out << "\n  ]\n}\n";
+    return static_cast<bool>(out);
+}
+
+// reads back what writeReport() wrote: the name and ns/bar of every result
+bool readReport(const std::string& file, std::vector<BenchResult>& report) {
+    std::ifstream in(file);
+    if (!in) {
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    std::string text = buffer.str();
+    const std::string nameKey = "\"name\": \"";
+    const std::string nsKey = "\"ns_per_bar\": ";
+    for (size_t at = text.find(nameKey); at != std::string::npos; at = text.find(nameKey, at)) {
+        at += nameKey.size();
+        size_t nameEnd = text.find('"', at);
+        size_t ns = text.find(nsKey, nameEnd);
+        if (nameEnd == std::string::npos || ns == std::string::npos) {
+            return false;
+        }
+        BenchResult result{text.substr(at, nameEnd - at), 0, std::strtod(text.c_str() + ns + nsKey.size(), nullptr),
+                           0.0};
+        report.push_back(result);
+        at = ns;
+    }
+    return true;
+}
+
+// every stage in both reports, slower by more than `threshold` percent is a
+// regression. Returns the number of regressions
+size_t compareReports(const std::vector<BenchResult>& baseline, double threshold) {
+    std::cout << "\n=== compare (regression above +" << threshold << "%) ===" << std::endl;
+    std::cout << std::left << std::setw(40) << "stage" << std::right << std::setw(12) << "base ns/bar"
+              << std::setw(12) << "ns/bar" << std::setw(10) << "change" << std::endl;
+    size_t regressions = 0;
+    for (const BenchResult& result : results) {
+        auto base = std::find_if(baseline.begin(), baseline.end(),
+                                 [&result](const BenchResult& b) { return b.name == result.name; });
+        std::cout << std::left << std::setw(40) << result.name << std::right << std::fixed << std::setprecision(2);
+        if (base == baseline.end() || base->nsPerBar <= 0.0) {
+            std::cout << std::setw(12) << "-" << std::setw(12) << result.nsPerBar << "  (new)" << std::endl;
+            continue;
+        }
+        double change = (result.nsPerBar / base->nsPerBar - 1.0) * 100.0;
+        bool regressed = change > threshold;
+        regressions += regressed;
+        std::cout << std::setw(12) << base->nsPerBar << std::setw(12) << result.nsPerBar << std::setw(9)
+                  << std::showpos << std::setprecision(1) << change << "%" << std::noshowpos
+                  << (regressed ? "  REGRESSION" : "") << std::endl;
+    }
+    std::cout << std::defaultfloat << regressions << " regression(s)" << std::endl;
+    return regressions;
+}
+
+}
+
+// counting replacements, the array and nothrow forms fall back to these
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size == 0 ? 1 : size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+// std::pmr::new_delete_resource() allocates through the aligned form
+void* operator new(size_t size, std::align_val_t alignment) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    size_t align = std::max(static_cast<size_t>(alignment), sizeof(void*));
+    if (void* memory = std::aligned_alloc(align, (std::max<size_t>(size, 1) + align - 1) / align * align)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+size_t allocationCount() {
+    return allocations.load(std::memory_order_relaxed);
+}
+
+std::vector<Bar> makeRandomWalkBars(size_t rows, uint64_t seed) {
+    std::vector<Bar> bars(rows);
+    uint64_t state = seed;
+    double price = 100.0;
+
+    for (size_t i = 0; i < rows; i++) {
+        // xorshift64, mapped to a +-1% step
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        double step = (static_cast<double>(state >> 11) / 9007199254740992.0 - 0.5) * 0.02;
+
+        double open = price;
+        price *= 1.0 + step;
+        bars[i].timestamp = static_cast<int64_t>(i) * 60 * 1000000000;  // one minute apart
+        bars[i].open = open;
+        bars[i].high = (open > price ? open : price) * 1.002;
+        bars[i].low = (open < price ? open : price) * 0.998;
+        bars[i].close = price;
+        bars[i].volume = static_cast<double>(1000000 + (state & 0xFFFFF));
+    }
+    return bars;
+}
+
+std::vector<Bar> makeGBMBars(const SyntheticSpec& spec, size_t symbol) {
+    std::vector<Bar> bars(spec.rows);
+    PathRandom random(spec.seed, symbol);
+    double step = spec.drift - 0.5 * spec.volatility * spec.volatility;
+    double price = spec.start;
+
+    for (size_t i = 0; i < spec.rows; i++) {
+        double open = price;
+        price *= std::exp(step + spec.volatility * random.normal());
+        // the wicks reach up to one volatility past the body
+        double up = 1.0 + spec.volatility * random.uniform();
+        double down = 1.0 - spec.volatility * random.uniform();
+        bars[i].timestamp = static_cast<int64_t>(i) * 60 * 1000000000;  // one minute apart
+        bars[i].open = open;
+        bars[i].high = std::max(open, price) * up;
+        bars[i].low = std::min(open, price) * down;
+        bars[i].close = price;
+        bars[i].volume = std::floor(500000.0 + 1000000.0 * random.uniform());
+    }
+    return bars;
+}
+
+std::vector<std::vector<Bar>> makeGBMUniverse(const SyntheticSpec& spec) {
+    std::vector<std::vector<Bar>> universe;
+    for (size_t symbol = 0; symbol < spec.symbols; symbol++) {
+        universe.push_back(makeGBMBars(spec, symbol));
+    }
+    return universe;
+}
+
+bool writeCsv(const std::string& file, const std::vector<Bar>& bars, bool newestFirst) {
+    std::FILE* out = std::fopen(file.c_str(), "w");
+    if (!out) {
+        return false;
+    }
+    std::fputs("timestamp,open,high,low,close,volume\n", out);
+    for (size_t n = 0; n < bars.size(); n++) {
+        const Bar& bar = bars[newestFirst ? bars.size() - 1 - n : n];
+        std::fprintf(out, "%s,%.17g,%.17g,%.17g,%.17g,%.17g\n", MarketData::formatTimestamp(bar.timestamp).c_str(),
+                     bar.open, bar.high, bar.low, bar.close, bar.volume);
+    }
+    return std::fclose(out) == 0;
+}
+
+void recordResult(const std::string& stage, size_t rows, double seconds) {
+    results.push_back({currentGroup + "/" + stage, rows, seconds * 1e9 / rows, rows / seconds});
+}
+
+struct BenchGroup {
+    const char* name;
+    void (*run)(size_t rows);
+};
+
+void printUsage(std::ostream& out, const BenchGroup* groups, size_t count) {
+    out << "usage: backtester_bench [--rows N] [--symbols N] [--json FILE] [--compare FILE] [--threshold PCT]"
+           " [group...]\ngroups (all when none given):";
+    for (size_t i = 0; i < count; i++) {
+        out << " " << groups[i].name;
+    }
+    out << std::endl;
+}
+
+int main(int argc, char** argv) {
+    const BenchGroup groups[] = {
+        {"layout", runLayoutBench},
+        {"indicators", runIndicatorBench},
+        {"batch", runBatchBench},
+        {"sweep", runSweepBench},
+        {"engine", runEngineBench},
+        {"events", runEventsBench},
+        {"ledger", runLedgerBench},
+        {"static", runStaticBench},
+        {"stream", runStreamBench},
+        {"universe", runUniverseBench},
+        {"portfolio", runPortfolioBench},
+        {"topk", runTopKBench},
+        {"walkforward", runWalkForwardBench},
+        {"montecarlo", runMonteCarloBench},
+        {"stages", runStageBench},
+        {"profile", runProfileBench},
+        {"replay", runReplayBench},
+        {"resample", runResampleBench},
+        {"prices", runPriceBench},
+    };
+
+    size_t rows = 1000000;
+    std::vector<std::string> selected;
+    std::string jsonFile;
+    std::string baselineFile;
+    double threshold = 10.0;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--rows") == 0 && i + 1 < argc) {
+            rows = std::stoull(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--symbols") == 0 && i + 1 < argc) {
+            benchSymbols = std::max<size_t>(std::stoull(argv[++i]), 1);
+        }
+        else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonFile = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--compare") == 0 && i + 1 < argc) {
+            baselineFile = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold = std::stod(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0) {
+            printUsage(std::cout, groups, std::size(groups));
+            return 0;
+        }
+        else {
+            selected.push_back(argv[i]);
+        }
+    }
+
+    // a typo must not pass as an empty run, least of all with --compare
+    for (const std::string& name : selected) {
+        bool known = false;
+        for (const BenchGroup& group : groups) {
+            known = known || name == group.name;
+        }
+        if (!known) {
+            std::cerr << "unknown group or option: " << name << std::endl;
+            printUsage(std::cerr, groups, std::size(groups));
+            return 2;
+        }
+    }
+
+    std::cout << "backtester_bench, " << rows << " bars" << std::endl;
+    for (const BenchGroup& group : groups) {
+        bool wanted = selected.empty();
+        for (const std::string& name : selected) {
+            wanted = wanted || name == group.name;
+        }
+        if (wanted) {
+            std::cout << "\n=== " << group.name << " ===" << std::endl;
+            currentGroup = group.name;
+            group.run(rows);
+        }
+    }
+
+    if (!jsonFile.empty()) {
+        if (!writeReport(jsonFile, rows)) {
+            std::cerr << "could not write " << jsonFile << std::endl;
+            return 2;
+        }
+        std::cout << "\n" << results.size() << " results written to " << jsonFile << std::endl;
+    }
+    if (!baselineFile.empty()) {
+        std::vector<BenchResult> baseline;
+        if (!readReport(baselineFile, baseline)) {
+            std::cerr << "could not read " << baselineFile << std::endl;
+            return 2;
+        }
+        // non-zero exit so a script or CI job can stop on a regression
+        return compareReports(baseline, threshold) > 0 ? 1 : 0;
+    }
+    return 0;
+}
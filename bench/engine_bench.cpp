@@ -0,0 +1,64 @@
+#include "bench.h"
+#include "backtest_engine.h"
+#include "rsi_strategy.h"
+#include "sma_crossover_strategy.h"
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+// four crossovers and four RSIs, quiet portfolios
+void addStrategies(BacktestEngine& engine) {
+    for (int period : {5, 10, 20, 50}) {
+        engine.addStrategy("SMA", std::unique_ptr<Strategy>(new SMACrossoverStrategy(period, period * 4)),
+                           Portfolio(10000.0));
+        engine.addStrategy("RSI", std::unique_ptr<Strategy>(new RSIStrategy(period)), Portfolio(10000.0));
+    }
+}
+
+}
+
+void runEngineBench(size_t rows) {
+    MarketData data(makeRandomWalkBars(rows), MarketData::Layout::Columns);
+
+    // the old main.cpp shape: one full traversal per strategy
+    std::vector<double> separateReturns;
+    double separateSeconds = bestOf(2, [&] {
+        separateReturns.clear();
+        for (int period : {5, 10, 20, 50}) {
+            SMACrossoverStrategy sma(period, period * 4);
+            RSIStrategy rsi(period);
+            Strategy* strategies[] = {&sma, &rsi};
+            for (Strategy* strategy : strategies) {
+                Portfolio portfolio(10000.0);
+                for (size_t i = 0; i < data.size(); i++) {
+                    portfolio.executeSignal(strategy->analyze(data, i), data.close()[i], i);
+                }
+                separateReturns.push_back(portfolio.getReturn(data.close()[data.size() - 1]));
+            }
+        }
+    });
+
+    std::cout << std::left << std::setw(26) << "8 strategies" << std::right << std::setw(12) << "ms"
+              << std::setw(14) << "Mbar-strat/s" << std::setw(12) << "same P&L" << std::endl;
+    auto report = [&](const char* name, double seconds, bool same) {
+        std::cout << std::left << std::setw(26) << name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << seconds * 1000.0 << std::setw(14) << 8.0 * rows / seconds / 1e6
+                  << std::setw(12) << (same ? "yes" : "NO") << std::defaultfloat << std::endl;
+    };
+    report("separate passes", separateSeconds, true);
+
+    for (BacktestEngine::Mode mode : {BacktestEngine::Mode::PerBar, BacktestEngine::Mode::Batch}) {
+        bool same = true;
+        double seconds = bestOf(2, [&] {
+            data.indicatorCache().clear();
+            BacktestEngine engine(data);
+            addStrategies(engine);
+            engine.run(mode);
+            for (size_t slot = 0; slot < engine.size(); slot++) {
+                same = same && engine.getReturn(slot) == separateReturns[slot];
+            }
+        });
+        report(mode == BacktestEngine::Mode::PerBar ? "engine, per bar" : "engine, batch", seconds, same);
+    }
+}
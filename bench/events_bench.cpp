@@ -0,0 +1,72 @@
+#include "bench.h"
+#include "event_sink.h"
+#include "parameter_sweep.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace {
+
+void printRow(const char* sink, double seconds, double baseline, size_t events) {
+    std::cout << std::left << std::setw(16) << sink << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << seconds * 1000.0 << std::setw(10) << (seconds / baseline - 1.0) * 100.0 << "%"
+              << std::setw(12) << events << std::defaultfloat << std::endl;
+}
+
+}
+
+void runEventsBench(size_t rows) {
+    // 10,000 combinations, each reporting an event on most bars, so logging cost shows up if there is any
+    size_t bars = std::max<size_t>(rows / 1000, 1000);
+    MarketData data(makeRandomWalkBars(bars), MarketData::Layout::Columns);
+    std::vector<SMAParams> grid = ParameterSweep::smaGrid(2, 101, 102, 201);
+    ParameterSweep sweep(data, 10000.0);
+
+    std::cout << grid.size() << " SMA combinations over " << bars << " bars, events compiled "
+              << (BACKTESTER_ENABLE_EVENTS ? "in" : "out") << std::endl;
+    std::cout << std::left << std::setw(16) << "sink" << std::right << std::setw(10) << "ms"
+              << std::setw(11) << "overhead" << std::setw(12) << "written" << std::endl;
+
+    // warm the indicator cache so every row measures the same work
+    sweep.runSMA(grid);
+
+    sweep.setEventSink(nullptr);
+    double nullSeconds = bestOf(3, [&] { sweep.runSMA(grid); });
+    printRow("none", nullSeconds, nullSeconds, 0);
+
+    std::string asyncPath = "/tmp/backtester_events_async.log";
+    size_t asyncEvents = 0;
+    size_t dropped = 0;
+    double asyncSeconds = 0.0;
+    {
+        AsyncFileSink sink(asyncPath, 1 << 16);
+        sweep.setEventSink(&sink);
+        asyncSeconds = bestOf(3, [&] { sweep.runSMA(grid); });
+        sink.flush();
+        // per sweep, bestOf ran it three times
+        asyncEvents = sink.written() / 3;
+        dropped = sink.dropped() / 3;
+    }
+    printRow("async file", asyncSeconds, nullSeconds, asyncEvents);
+    if (dropped > 0) {
+        std::cout << "  (" << dropped << " events per sweep dropped on full rings)" << std::endl;
+    }
+
+    // the old behaviour: formatting and an unbuffered write on the trading thread
+    std::string consolePath = "/tmp/backtester_events_console.log";
+    double consoleSeconds = 0.0;
+    {
+        std::ofstream out(consolePath);
+        ConsoleSink sink(out);
+        sweep.setEventSink(&sink);
+        consoleSeconds = bestOf(1, [&] { sweep.runSMA(grid); });
+    }
+    printRow("console (file)", consoleSeconds, nullSeconds, asyncEvents + dropped);
+
+    sweep.setEventSink(nullptr);
+    std::remove(asyncPath.c_str());
+    std::remove(consolePath.c_str());
+}
@@ -0,0 +1,126 @@
+#include "bench.h"
+#include "indicators.h"
+#include "sma_crossover_strategy.h"
+#include "rsi_strategy.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+double relativeDifference(double a, double b) {
+    return std::fabs(a - b) / std::max(1.0, std::fabs(b));
+}
+
+Signal rsiSignal(double rsi) {
+    if (rsi < 30) return Signal::Buy;
+    if (rsi > 70) return Signal::Sell;
+    return Signal::Hold;
+}
+
+Signal crossoverSignal(double shortMA, double longMA) {
+    if (shortMA == 0.0 || longMA == 0.0) return Signal::Hold;
+    if (shortMA > longMA) return Signal::Buy;
+    if (shortMA < longMA) return Signal::Sell;
+    return Signal::Hold;
+}
+
+void report(const char* name, int period, size_t rows, double windowSeconds, double rollingSeconds,
+            double maxDifference, size_t mismatches) {
+    std::cout << std::left << std::setw(14) << name << std::right << std::setw(6) << period
+              << std::fixed << std::setprecision(2)
+              << std::setw(12) << windowSeconds * 1e9 / rows
+              << std::setw(12) << rollingSeconds * 1e9 / rows
+              << std::setw(9) << windowSeconds / rollingSeconds << "x"
+              << std::scientific << std::setprecision(1) << std::setw(13) << maxDifference
+              << std::setw(10) << mismatches << std::defaultfloat << std::endl;
+}
+
+}
+
+void runIndicatorBench(size_t rows) {
+    MarketData data(makeRandomWalkBars(rows), MarketData::Layout::Columns);
+    ColumnView<double> close = data.close();
+
+    std::cout << std::left << std::setw(14) << "indicator" << std::right << std::setw(6) << "period"
+              << std::setw(12) << "window" << std::setw(12) << "rolling" << std::setw(10) << "speedup"
+              << std::setw(14) << "max rel.diff" << std::setw(10) << "sig.diff" << std::endl;
+    std::cout << "(ns/bar; window = recompute per bar, rolling = O(1) update)" << std::endl;
+
+    for (int period : {5, 50, 200}) {
+        // moving average
+        std::vector<double> reference(rows);
+        double windowSeconds = bestOf(2, [&] {
+            for (size_t i = 0; i < rows; i++) {
+                reference[i] = SMACrossoverStrategy::calculateMA(data, i, period);
+            }
+        });
+        std::vector<double> rolling(rows);
+        double rollingSeconds = bestOf(2, [&] {
+            RollingSMA sma(period);
+            for (size_t i = 0; i < rows; i++) {
+                rolling[i] = sma.update(close[i]);
+            }
+        });
+        double maxDifference = 0.0;
+        for (size_t i = 0; i < rows; i++) {
+            maxDifference = std::max(maxDifference, relativeDifference(rolling[i], reference[i]));
+        }
+
+        // the strategy on top of it, crossing with an average twice as long
+        std::vector<double> referenceLong(rows);
+        for (size_t i = 0; i < rows; i++) {
+            referenceLong[i] = SMACrossoverStrategy::calculateMA(data, i, period * 2);
+        }
+        SMACrossoverStrategy crossover(period, period * 2);
+        size_t mismatches = 0;
+        for (size_t i = 0; i < rows; i++) {
+            mismatches += crossover.analyze(data, i) != crossoverSignal(reference[i], referenceLong[i]);
+        }
+        report("SMA", period, rows, windowSeconds, rollingSeconds, maxDifference, mismatches);
+
+        // RSI
+        windowSeconds = bestOf(2, [&] {
+            for (size_t i = 0; i < rows; i++) {
+                reference[i] = RSIStrategy::calculateRSI(data, i, period);
+            }
+        });
+        rollingSeconds = bestOf(2, [&] {
+            RollingRSI rsi(period);
+            for (size_t i = 0; i < rows; i++) {
+                rsi.update(close[i]);
+                rolling[i] = rsi.ready() ? rsi.value() : 50.0;
+            }
+        });
+        maxDifference = 0.0;
+        for (size_t i = 0; i < rows; i++) {
+            maxDifference = std::max(maxDifference, relativeDifference(rolling[i], reference[i]));
+        }
+        RSIStrategy rsiStrategy(period);
+        mismatches = 0;
+        for (size_t i = 0; i < rows; i++) {
+            mismatches += rsiStrategy.analyze(data, i) != rsiSignal(reference[i]);
+        }
+        report("RSI", period, rows, windowSeconds, rollingSeconds, maxDifference, mismatches);
+    }
+
+    // the rest of the library, rolling cost only
+    std::cout << std::endl;
+    auto timeOne = [&](const char* name, auto indicator) {
+        double seconds = bestOf(3, [&] {
+            double sum = 0.0;
+            for (size_t i = 0; i < rows; i++) {
+                sum += indicator.update(close[i]);
+            }
+            benchSink = sum;
+        });
+        std::cout << std::left << std::setw(20) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(10) << seconds * 1e9 / rows << " ns/bar" << std::defaultfloat << std::endl;
+    };
+    timeOne("EMA(50)", EMA(50));
+    timeOne("WilderRSI(14)", WilderRSI(14));
+    timeOne("RollingMin(50)", RollingMin(50));
+    timeOne("RollingMax(50)", RollingMax(50));
+    timeOne("RollingStdDev(50)", RollingStdDev(50));
+}
@@ -0,0 +1,52 @@
+#include "bench.h"
+#include "sma_crossover_strategy.h"
+#include "rsi_strategy.h"
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+double sumClose(const MarketData& data) {
+    ColumnView<double> close = data.close();
+    double sum = 0.0;
+    for (size_t i = 0; i < close.size(); i++) {
+        sum += close[i];
+    }
+    return sum;
+}
+
+template <typename StrategyType>
+double runStrategy(StrategyType strategy, const MarketData& data) {
+    double buys = 0.0;
+    for (size_t i = 0; i < data.size(); i++) {
+        buys += strategy.analyze(data, i) == Signal::Buy;
+    }
+    return buys;
+}
+
+void report(const char* name, size_t rows, double rowsSeconds, double columnsSeconds) {
+    std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << rowsSeconds * 1e9 / rows << " ns/bar"
+              << std::setw(10) << columnsSeconds * 1e9 / rows << " ns/bar"
+              << std::setw(8) << rowsSeconds / columnsSeconds << "x" << std::endl;
+}
+
+}
+
+void runLayoutBench(size_t rows) {
+    MarketData byRow(makeRandomWalkBars(rows), MarketData::Layout::Rows);
+    MarketData byColumn(makeRandomWalkBars(rows), MarketData::Layout::Columns);
+
+    std::cout << std::left << std::setw(24) << "" << std::right
+              << std::setw(17) << "rows" << std::setw(17) << "columns" << std::setw(9) << "speedup" << std::endl;
+
+    report("close sum", rows,
+           bestOf(5, [&] { benchSink = sumClose(byRow); }),
+           bestOf(5, [&] { benchSink = sumClose(byColumn); }));
+    report("SMA crossover (20/50)", rows,
+           bestOf(3, [&] { benchSink = runStrategy(SMACrossoverStrategy(20, 50), byRow); }),
+           bestOf(3, [&] { benchSink = runStrategy(SMACrossoverStrategy(20, 50), byColumn); }));
+    report("RSI (14)", rows,
+           bestOf(3, [&] { benchSink = runStrategy(RSIStrategy(14), byRow); }),
+           bestOf(3, [&] { benchSink = runStrategy(RSIStrategy(14), byColumn); }));
+}
@@ -0,0 +1,93 @@
+#include "bench.h"
+#include "parameter_sweep.h"
+#include "portfolio.h"
+#include "sma_crossover_strategy.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <memory_resource>
+
+namespace {
+
+// trades one precomputed signal column, the inner loop of ParameterSweep
+double trade(Portfolio& portfolio, const std::vector<Signal>& signals, ColumnView<double> close) {
+    for (size_t i = 0; i < signals.size(); i++) {
+        if (signals[i] != Signal::Hold) {
+            portfolio.executeSignal(signals[i], close[i], i);
+        }
+    }
+    return portfolio.getReturn(close[signals.size() - 1]);
+}
+
+void printRow(const char* name, double seconds, size_t combinations, size_t allocations) {
+    std::cout << std::left << std::setw(26) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << seconds * 1000.0 << std::setw(16)
+              << static_cast<double>(allocations) / combinations << std::defaultfloat << std::endl;
+}
+
+}
+
+void runLedgerBench(size_t rows) {
+    size_t bars = std::max<size_t>(rows / 10, 1000);
+    MarketData data(makeRandomWalkBars(bars), MarketData::Layout::Columns);
+    ColumnView<double> close = data.close();
+
+    // a handful of signal columns, traded over and over like a sweep would
+    std::vector<std::vector<Signal>> columns;
+    for (int period : {2, 5, 10, 20}) {
+        columns.push_back(SMACrossoverStrategy(period, period * 3).analyzeAll(data));
+    }
+    size_t combinations = 400;
+
+    std::cout << "Trade " << sizeof(Trade) << " bytes, ledger " << TradeLedger::bytesPerTrade()
+              << " bytes per trade" << (BACKTESTER_FLOAT_TRADE_PRICES ? " (float prices)" : "") << std::endl;
+    std::cout << combinations << " combinations over " << bars << " bars" << std::endl;
+    std::cout << std::left << std::setw(26) << "portfolio" << std::right << std::setw(10) << "ms"
+              << std::setw(16) << "allocs/combo" << std::endl;
+
+    // a new Portfolio per combination, its ledger grows from empty each time
+    size_t before = allocationCount();
+    double freshSeconds = bestOf(1, [&] {
+        for (size_t c = 0; c < combinations; c++) {
+            Portfolio portfolio(10000.0);
+            benchSink = trade(portfolio, columns[c % columns.size()], close);
+        }
+    });
+    printRow("new per combination", freshSeconds, combinations, allocationCount() - before);
+
+    // a new Portfolio per combination on a stack arena, released wholesale
+    alignas(64) static unsigned char arena[16 << 20];
+    before = allocationCount();
+    double arenaSeconds = bestOf(1, [&] {
+        for (size_t c = 0; c < combinations; c++) {
+            std::pmr::monotonic_buffer_resource resource(arena, sizeof(arena), std::pmr::null_memory_resource());
+            Portfolio portfolio(10000.0, nullptr, &resource);
+            benchSink = trade(portfolio, columns[c % columns.size()], close);
+        }
+    });
+    printRow("new on an arena", arenaSeconds, combinations, allocationCount() - before);
+
+    // one Portfolio reset between combinations, warmed up once first
+    Portfolio reused(10000.0);
+    for (const std::vector<Signal>& signals : columns) {
+        reused.reset(10000.0);
+        trade(reused, signals, close);
+    }
+    before = allocationCount();
+    double reusedSeconds = bestOf(1, [&] {
+        for (size_t c = 0; c < combinations; c++) {
+            reused.reset(10000.0);
+            benchSink = trade(reused, columns[c % columns.size()], close);
+        }
+    });
+    printRow("reused with reset()", reusedSeconds, combinations, allocationCount() - before);
+
+    // the whole sweep, after a first run warmed the indicator cache and the
+    // per-thread buffers. What is left is per run, not per combination
+    ParameterSweep sweep(data, 10000.0);
+    std::vector<SMAParams> grid = ParameterSweep::smaGrid(2, 21, 22, 41);
+    sweep.runSMA(grid);
+    before = allocationCount();
+    double sweepSeconds = bestOf(1, [&] { sweep.runSMA(grid); });
+    printRow("ParameterSweep::runSMA", sweepSeconds, grid.size(), allocationCount() - before);
+}
@@ -0,0 +1,110 @@
+#include "bench.h"
+#include "monte_carlo.h"
+#include "portfolio.h"
+#include "sma_crossover_strategy.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+void printRow(const char* name, double seconds, size_t paths) {
+    std::cout << std::left << std::setw(34) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << seconds * 1000.0 << std::setw(12) << std::setprecision(0) << paths / seconds
+              << std::defaultfloat << std::endl;
+}
+
+}
+
+void runMonteCarloBench(size_t rows) {
+    size_t bars = std::max<size_t>(rows / 400, 1000);
+    size_t paths = 2000;
+    MarketData data(makeRandomWalkBars(bars), MarketData::Layout::Columns);
+    MonteCarlo::PathStrategy strategy = MonteCarlo::sma(10, 30);
+    GBMParams params = MonteCarlo::fitGBM(data);
+
+    std::cout << paths << " paths of " << bars << " bars, SMA(10, 30)" << std::endl;
+    std::cout << std::left << std::setw(34) << "paths" << std::right << std::setw(10) << "ms"
+              << std::setw(12) << "paths/s" << std::endl;
+
+    // what a loop over the existing classes does: a MarketData, a strategy
+    // and a Portfolio per path, built from the same random draws as gbm()
+    std::vector<double> naiveReturns(paths);
+    double naiveSeconds = bestOf(1, [&] {
+        double step = params.drift - 0.5 * params.volatility * params.volatility;
+        for (size_t path = 0; path < paths; path++) {
+            PathRandom random(42, path);
+            std::vector<Bar> pathBars(bars);
+            double close = params.start;
+            for (size_t i = 0; i < bars; i++) {
+                if (i > 0) {
+                    close *= std::exp(step + params.volatility * random.normal());
+                }
+                pathBars[i] = {static_cast<int64_t>(i), close, close, close, close, 0.0};
+            }
+            MarketData pathData(std::move(pathBars), MarketData::Layout::Columns);
+            SMACrossoverStrategy crossover(10, 30);
+            std::vector<Signal> signals = crossover.analyzeAll(pathData);
+            Portfolio portfolio(10000.0);
+            ColumnView<double> closes = pathData.close();
+            for (size_t i = 0; i < bars; i++) {
+                if (signals[i] != Signal::Hold) {
+                    portfolio.executeSignal(signals[i], closes[i], i);
+                }
+            }
+            naiveReturns[path] = portfolio.getReturn(closes[bars - 1]);
+        }
+    });
+    printRow("MarketData per path", naiveSeconds, paths);
+
+    MonteCarlo monteCarlo(10000.0);
+    MonteCarloResult gbm;
+    size_t allocationsBefore = allocationCount();
+    double gbmSeconds = bestOf(3, [&] { gbm = monteCarlo.gbm(params, bars, strategy, paths); });
+    size_t allocations = allocationCount() - allocationsBefore;
+    printRow("gbm()", gbmSeconds, paths);
+
+    MonteCarloResult boot;
+    double bootSeconds = bestOf(3, [&] { boot = monteCarlo.bootstrap(data, strategy, paths, 20); });
+    printRow("bootstrap(), 20 bar blocks", bootSeconds, paths);
+
+    // a long trade history to shuffle
+    Portfolio traded(10000.0);
+    std::vector<Signal> signals(bars);
+    ColumnView<double> close = data.close();
+    std::vector<double> closes(bars);
+    for (size_t i = 0; i < bars; i++) {
+        closes[i] = close[i];
+    }
+    MonteCarlo::sma(3, 5)(closes.data(), bars, signals.data());
+    for (size_t i = 0; i < bars; i++) {
+        if (signals[i] != Signal::Hold) {
+            traded.executeSignal(signals[i], closes[i], i);
+        }
+    }
+    MonteCarloResult shuffled;
+    double shuffleSeconds = bestOf(3, [&] {
+        shuffled = monteCarlo.shuffleTrades(traded.getTradeHistory(), 10000.0, paths * 10);
+    });
+    std::string shuffleName = "shuffleTrades(), " + std::to_string(traded.getTradeHistory().size()) + " trades";
+    printRow(shuffleName.c_str(), shuffleSeconds, paths * 10);
+
+    bool same = std::equal(naiveReturns.begin(), naiveReturns.end(), gbm.returns.begin());
+    std::cout << "gbm() matches the per-path loop: " << (same ? "yes" : "NO") << ", "
+              << std::fixed << std::setprecision(2) << naiveSeconds / gbmSeconds << "x, "
+              << std::setprecision(1) << static_cast<double>(allocations) / (3 * paths)
+              << " allocations a path" << std::defaultfloat << std::endl;
+
+    // the same seed on a single thread gives the same paths
+    ThreadPool single(1);
+    MonteCarlo oneThread(10000.0, single);
+    MonteCarloResult again = oneThread.bootstrap(data, strategy, paths, 20);
+    std::cout << "1 thread vs " << ThreadPool::shared().size() << " workers: "
+              << (again.returns == boot.returns && again.drawdowns == boot.drawdowns ? "identical" : "DIFFERENT")
+              << std::endl;
+
+    MonteCarlo::printSummary("bootstrap", boot);
+    MonteCarlo::printSummary("gbm", gbm);
+    MonteCarlo::printSummary("shuffled trades", shuffled);
+}
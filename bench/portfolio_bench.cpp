@@ -0,0 +1,100 @@
+#include "bench.h"
+#include "multi_asset_portfolio.h"
+#include "portfolio.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+namespace {
+
+void printRow(const char* name, double seconds, size_t bars) {
+    std::cout << std::left << std::setw(34) << name << std::right << std::fixed << std::setprecision(3)
+              << std::setw(12) << seconds * 1e6 / bars << std::defaultfloat << std::endl;
+}
+
+}
+
+void runPortfolioBench(size_t rows) {
+    // a cross-section of 512 names, rows/512 bars of closes each (row-major:
+    // prices[bar * symbols + symbol])
+    const size_t symbols = 512;
+    size_t bars = std::max<size_t>(rows / symbols, 500);
+    std::vector<double> prices(bars * symbols);
+    std::vector<Signal> signals(bars * symbols);
+    std::mt19937_64 rng(7);
+    std::uniform_int_distribution<int> pick(0, 19);
+    for (size_t s = 0; s < symbols; s++) {
+        std::vector<Bar> walk = makeRandomWalkBars(bars, 100 + s);
+        for (size_t b = 0; b < bars; b++) {
+            prices[b * symbols + s] = walk[b].close;
+            int roll = pick(rng);
+            signals[b * symbols + s] = roll == 0 ? Signal::Buy : roll == 1 ? Signal::Sell : Signal::Hold;
+        }
+    }
+
+    std::cout << symbols << " symbols, " << bars << " bars" << std::endl;
+    std::cout << std::left << std::setw(34) << "per bar" << std::right << std::setw(12) << "us" << std::endl;
+
+    // one Portfolio per symbol, each with its own slice of the cash
+    std::vector<Portfolio> separate(symbols, Portfolio(10000.0 / symbols));
+    MultiAssetPortfolio book(10000.0, symbols);
+    for (size_t b = 0; b < bars; b++) {
+        book.markPrices(&prices[b * symbols]);
+        book.executeSignals(&signals[b * symbols], b);
+        for (size_t s = 0; s < symbols; s++) {
+            if (signals[b * symbols + s] != Signal::Hold) {
+                separate[s].executeSignal(signals[b * symbols + s], prices[b * symbols + s], b);
+            }
+        }
+    }
+    std::cout << "open positions: " << book.openPositions() << " in the book" << std::endl;
+
+    double separateValue = bestOf(5, [&] {
+        for (size_t b = 0; b < bars; b++) {
+            double total = 0.0;
+            for (size_t s = 0; s < symbols; s++) {
+                total += separate[s].getTotalValue(prices[b * symbols + s]);
+            }
+            benchSink = total;
+        }
+    });
+    printRow("revalue, Portfolio per symbol", separateValue, bars);
+
+    double bookValue = bestOf(5, [&] {
+        for (size_t b = 0; b < bars; b++) {
+            book.markPrices(&prices[b * symbols]);
+            benchSink = book.getTotalValue();
+        }
+    });
+    printRow("revalue, MultiAssetPortfolio", bookValue, bars);
+
+    // the whole bar: mark, trade that bar's signals, revalue
+    double bookBar = bestOf(3, [&] {
+        book.reset(10000.0);
+        for (size_t b = 0; b < bars; b++) {
+            book.markPrices(&prices[b * symbols]);
+            book.executeSignals(&signals[b * symbols], b);
+            benchSink = book.getTotalValue();
+        }
+    });
+    printRow("mark + signals + revalue", bookBar, bars);
+
+    // explicit order batches: 16 round lots per bar
+    std::vector<Order> orders;
+    double orderBar = bestOf(3, [&] {
+        book.reset(1e9);
+        for (size_t b = 0; b < bars; b++) {
+            orders.clear();
+            for (uint32_t k = 0; k < 16; k++) {
+                uint32_t symbol = static_cast<uint32_t>((b * 37 + k * 31) % symbols);
+                orders.push_back({symbol, (b + k) % 2 == 0 ? 100 : -100});
+            }
+            book.markPrices(&prices[b * symbols]);
+            book.executeOrders(orders, b);
+            benchSink = book.getTotalValue();
+        }
+    });
+    printRow("mark + 16 orders + revalue", orderBar, bars);
+    std::cout << "trades recorded: " << book.getTradeHistory().size() << std::endl;
+}
@@ -0,0 +1,46 @@
+#include "bench.h"
+#include "portfolio.h"
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+void runPriceBench(size_t rows) {
+    // whole-cent prices, a buy or a sell on every bar: the most cash updates
+    // a Portfolio gets
+    SyntheticSpec spec;
+    spec.rows = rows;
+    std::vector<Bar> bars = makeGBMBars(spec);
+    std::vector<double> prices(rows);
+    for (size_t i = 0; i < rows; i++) {
+        prices[i] = std::round(bars[i].close * 100.0) / 100.0;
+    }
+    std::cout << "price type: " << (BACKTESTER_FIXED_PRICES ? "int64 micro-dollars" : "double") << ", "
+              << sizeof(Price) << " bytes, ledger price column " << sizeof(LedgerPrice) << " bytes" << std::endl;
+
+    Portfolio portfolio(10000.0);
+    double seconds = bestOf(3, [&] {
+        portfolio.reset(10000.0);
+        for (size_t i = 0; i < rows; i++) {
+            portfolio.executeSignal(i % 2 == 0 ? Signal::Buy : Signal::Sell, prices[i], i);
+        }
+        benchSink = portfolio.getCash();
+    });
+    recordResult("executeSignal, every bar", rows, seconds);
+    std::cout << std::left << std::setw(34) << "executeSignal, every bar" << std::right << std::fixed
+              << std::setprecision(2) << std::setw(10) << seconds * 1e9 / rows << " ns/bar" << std::defaultfloat
+              << std::endl;
+
+    // the same trades replayed in exact integer micro-dollars: how far the
+    // portfolio's own cash ended up from it
+    const TradeLedger& trades = portfolio.getTradeHistory();
+    int64_t exact = 10000LL * 1000000;
+    for (size_t i = 0; i < trades.size(); i++) {
+        int64_t price = std::llround(toDollars(trades.prices()[i]) * 1e6);
+        int64_t amount = trades.quantities()[i] * price;
+        exact += trades.types()[i] == Signal::Buy ? -amount : amount;
+    }
+    double drift = portfolio.getCash() - exact / 1e6;
+    std::cout << trades.size() << " trades, final cash $" << std::fixed << std::setprecision(6)
+              << portfolio.getCash() << ", off the exact sum by $" << std::scientific << std::setprecision(3)
+              << drift << std::defaultfloat << std::endl;
+}
@@ -0,0 +1,57 @@
+#include "bench.h"
+#include "backtest_engine.h"
+#include "parameter_sweep.h"
+#include "profiler.h"
+#include "rsi_strategy.h"
+#include "sma_crossover_strategy.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+void runProfileBench(size_t rows) {
+    // the same workloads in both builds: compare a BACKTESTER_PROFILE=ON
+    // report against an OFF one (--json, then --compare) for the overhead
+    MarketData data(makeRandomWalkBars(rows), MarketData::Layout::Columns);
+    size_t sweepBars = std::max<size_t>(rows / 20, 1000);
+    MarketData sweepData(makeRandomWalkBars(sweepBars), MarketData::Layout::Columns);
+    std::vector<SMAParams> grid = ParameterSweep::smaGrid(2, 21, 10, 80, 2);
+
+    std::cout << "profiling compiled " << (BACKTESTER_ENABLE_PROFILE ? "in" : "out")
+              << ", 1 in " << Profiler::sampleInterval() << " hot calls timed" << std::endl;
+    std::cout << std::left << std::setw(34) << "workload" << std::right << std::setw(12) << "ns/bar" << std::endl;
+    auto report = [](const char* name, size_t bars, double seconds) {
+        recordResult(name, bars, seconds);
+        std::cout << std::left << std::setw(34) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(12) << seconds * 1e9 / bars << std::defaultfloat << std::endl;
+    };
+
+    Profiler::reset();
+    for (BacktestEngine::Mode mode : {BacktestEngine::Mode::PerBar, BacktestEngine::Mode::Batch}) {
+        double seconds = bestOf(5, [&] {
+            data.indicatorCache().clear();
+            BacktestEngine engine(data);
+            for (int period : {5, 20}) {
+                engine.addStrategy("SMA", std::unique_ptr<Strategy>(new SMACrossoverStrategy(period, period * 4)),
+                                   Portfolio(10000.0));
+                engine.addStrategy("RSI", std::unique_ptr<Strategy>(new RSIStrategy(period)), Portfolio(10000.0));
+            }
+            engine.run(mode);
+            benchSink = engine.getReturn(0);
+        });
+        report(mode == BacktestEngine::Mode::PerBar ? "engine, 4 strategies, per bar" : "engine, 4 strategies, batch",
+               rows * 4, seconds);
+    }
+
+    ParameterSweep sweep(sweepData, 10000.0);
+    double sweepSeconds = bestOf(5, [&] { benchSink = sweep.runSMATopK(grid, 1)[0].returnPercent; });
+    report("sweep, per combination-bar", grid.size() * sweepBars, sweepSeconds);
+
+    if (BACKTESTER_ENABLE_PROFILE) {
+        std::cout << "\nstages over every run above (Run includes the rest):" << std::endl;
+        Profiler::printSummary();
+        if (Profiler::writeJson("/tmp/backtester_profile.json")
+            && Profiler::writeChromeTrace("/tmp/backtester_trace.json")) {
+            std::cout << "wrote /tmp/backtester_profile.json and /tmp/backtester_trace.json" << std::endl;
+        }
+    }
+}
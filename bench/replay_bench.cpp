@@ -0,0 +1,150 @@
+#include "bench.h"
+#include "backtest_engine.h"
+#include "replay_driver.h"
+#include "rsi_strategy.h"
+#include "sma_crossover_strategy.h"
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+// only analyze() and lookback(), so onBar() is the BarWindow default
+class WindowedSMA : public Strategy {
+public:
+    WindowedSMA(int shortPeriod, int longPeriod) : sma_(shortPeriod, longPeriod) {}
+    Signal analyze(const MarketData& data, size_t index) override { return sma_.analyze(data, index); }
+    size_t lookback() const override { return sma_.lookback(); }
+
+private:
+    SMACrossoverStrategy sma_;
+};
+
+void addStrategies(ReplayDriver& driver) {
+    driver.addStrategy("SMA(10,40)", std::unique_ptr<Strategy>(new SMACrossoverStrategy(10, 40)), Portfolio(10000.0));
+    driver.addStrategy("RSI(14)", std::unique_ptr<Strategy>(new RSIStrategy(14)), Portfolio(10000.0));
+}
+
+void printLatency(const char* name, const ReplayDriver& driver) {
+    const LatencyHistogram& latency = driver.latency();
+    std::cout << std::left << std::setw(30) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << latency.percentile(50.0) / 1000.0 << std::setw(10)
+              << latency.percentile(99.0) / 1000.0 << std::setw(10) << latency.percentile(99.9) / 1000.0
+              << std::setw(10) << latency.max() / 1000.0 << std::setw(12)
+              << driver.barsReplayed() / driver.lastRunSeconds() / 1e6 << std::defaultfloat << std::endl;
+}
+
+}
+
+void runReplayBench(size_t rows) {
+    SyntheticSpec spec;
+    spec.rows = rows;
+    std::vector<Bar> bars = makeGBMBars(spec);
+    MarketData data(bars, MarketData::Layout::Columns);
+
+    // onBar() against analyze() bar by bar: same signals, and what the
+    // incremental interface costs per bar
+    std::cout << "strategy            analyze ns/bar   onBar ns/bar   signals equal" << std::endl;
+    auto compare = [&](const char* name, Strategy& byIndex, Strategy& byBar) {
+        std::vector<Signal> expected(rows);
+        std::vector<Signal> got(rows);
+        double analyzeSeconds = bestOf(3, [&] {
+            for (size_t i = 0; i < rows; i++) {
+                expected[i] = byIndex.analyze(data, i);
+            }
+        });
+        double onBarSeconds = bestOf(3, [&] {
+            byBar.resetBars();
+            for (size_t i = 0; i < rows; i++) {
+                got[i] = byBar.onBar(bars[i]);
+            }
+        });
+        recordResult(std::string(name) + " onBar", rows, onBarSeconds);
+        std::cout << std::left << std::setw(20) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(15) << analyzeSeconds * 1e9 / rows << std::setw(15) << onBarSeconds * 1e9 / rows
+                  << std::setw(16) << (expected == got ? "yes" : "NO") << std::defaultfloat << std::endl;
+    };
+    SMACrossoverStrategy smaByIndex(10, 40), smaByBar(10, 40);
+    compare("SMA(10,40)", smaByIndex, smaByBar);
+    RSIStrategy rsiByIndex(14), rsiByBar(14);
+    compare("RSI(14)", rsiByIndex, rsiByBar);
+    WindowedSMA windowedByIndex(10, 40), windowedByBar(10, 40);
+    compare("SMA(10,40) windowed", windowedByIndex, windowedByBar);
+
+    // tick-to-signal through the driver, SMA(10,40) + RSI(14), microseconds
+    std::string file = "/tmp/backtester_replay.csv";
+    if (!writeCsv(file, bars)) {
+        std::cout << "could not write " << file << std::endl;
+        return;
+    }
+    std::cout << "\nreplay, SMA(10,40) + RSI(14)      p50 us    p99 us  p99.9 us    max us  Mbars/s" << std::endl;
+
+    ReplayDriver fromFile;
+    addStrategies(fromFile);
+    fromFile.setTradeCapacity(rows);
+    BarSource source;
+    source.open(file);
+    fromFile.run(source);  // warm-up: indicator rings, ledgers
+    source.open(file);
+    size_t allocations = allocationCount();
+    fromFile.run(source);
+    allocations = allocationCount() - allocations;
+    recordResult("replay file", rows, fromFile.lastRunSeconds());
+    printLatency("CSV file (BarSource)", fromFile);
+
+    // the same rows written into a pipe by another thread as they are read
+    ReplayDriver fromPipe;
+    addStrategies(fromPipe);
+    fromPipe.setTradeCapacity(rows);
+    int fds[2];
+    if (::pipe(fds) == 0) {
+        std::thread writer([&] {
+            writeCsv("/dev/fd/" + std::to_string(fds[1]), bars);
+            ::close(fds[1]);
+        });
+        BarStream stream;
+        stream.openFd(fds[0]);
+        fromPipe.run(stream);
+        writer.join();
+        ::close(fds[0]);
+        recordResult("replay pipe", rows, fromPipe.lastRunSeconds());
+        printLatency("pipe (BarStream)", fromPipe);
+    }
+
+    // paced: the one minute bars replayed at one every 50 us
+    ReplayDriver paced;
+    addStrategies(paced);
+    size_t pacedRows = std::min<size_t>(rows, 5000);
+    std::vector<Bar> pacedBars(bars.begin(), bars.begin() + pacedRows);
+    std::string pacedFile = "/tmp/backtester_replay_paced.csv";
+    writeCsv(pacedFile, pacedBars);
+    paced.setSpeed(60e9 / 50e3);
+    source.open(pacedFile);
+    paced.run(source);
+    printLatency("paced, 1 bar / 50 us", paced);
+    std::cout << "paced run " << std::fixed << std::setprecision(1) << paced.lastRunSeconds() * 1000.0
+              << std::defaultfloat << " ms for " << pacedRows << " bars, " << paced.lateBars()
+              << " behind schedule (sleep_until() wake-up)" << std::endl;
+
+    // the driver against BacktestEngine::runStreaming() on the same file
+    BacktestEngine engine;
+    engine.addStrategy("SMA(10,40)", std::unique_ptr<Strategy>(new SMACrossoverStrategy(10, 40)), Portfolio(10000.0));
+    engine.addStrategy("RSI(14)", std::unique_ptr<Strategy>(new RSIStrategy(14)), Portfolio(10000.0));
+    source.open(file);
+    engine.runStreaming(source);
+    ReplayDriver fresh;
+    addStrategies(fresh);
+    source.open(file);
+    fresh.run(source);
+    bool same = fresh.getStats(0).signalChanges == engine.getStats(0).signalChanges
+                && fresh.getStats(1).signalChanges == engine.getStats(1).signalChanges
+                && fresh.getReturn(0) == engine.getReturn(0) && fresh.getReturn(1) == engine.getReturn(1);
+    std::cout << "allocations during the warm file replay: " << allocations
+              << "\nsame trades and returns as runStreaming(): " << (same ? "yes" : "NO") << std::endl;
+    std::remove(file.c_str());
+    std::remove(pacedFile.c_str());
+}
@@ -0,0 +1,134 @@
+#include "bench.h"
+#include "backtest_engine.h"
+#include "rsi_strategy.h"
+#include "sma_crossover_strategy.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+// the copy resample() replaces: every bucket built as a Bar up front
+std::vector<Bar> aggregateCopy(const std::vector<Bar>& bars, int64_t interval) {
+    std::vector<Bar> out;
+    int64_t current = 0;
+    for (const Bar& bar : bars) {
+        int64_t offset = bar.timestamp - MarketData::kResampleOrigin;
+        int64_t bucket = offset / interval - (offset % interval < 0 ? 1 : 0);
+        if (out.empty() || bucket != current) {
+            Bar first = bar;
+            first.timestamp = MarketData::kResampleOrigin + bucket * interval;
+            out.push_back(first);
+            current = bucket;
+            continue;
+        }
+        Bar& last = out.back();
+        last.high = std::max(last.high, bar.high);
+        last.low = std::min(last.low, bar.low);
+        last.close = bar.close;
+        last.volume += bar.volume;
+    }
+    return out;
+}
+
+bool sameBars(const MarketData& view, const std::vector<Bar>& expected) {
+    if (view.size() != expected.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < expected.size(); i++) {
+        Bar bar = view.getBar(i);
+        const Bar& other = expected[i];
+        if (bar.timestamp != other.timestamp || bar.open != other.open || bar.high != other.high
+            || bar.low != other.low || bar.close != other.close || bar.volume != other.volume) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void row(const char* name, size_t rows, double seconds) {
+    recordResult(name, rows, seconds);
+    std::cout << std::left << std::setw(40) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(12) << seconds * 1e9 / rows << std::setw(12) << seconds * 1000.0 << std::defaultfloat
+              << std::endl;
+}
+
+}
+
+void runResampleBench(size_t rows) {
+    // one minute GBM bars, around the clock
+    SyntheticSpec spec;
+    spec.rows = rows;
+    std::vector<Bar> bars = makeGBMBars(spec);
+    MarketData minutes(bars, MarketData::Layout::Columns);
+    std::cout << rows << " minute bars" << std::endl;
+    std::cout << std::left << std::setw(40) << "step" << std::right << std::setw(12) << "ns/minute"
+              << std::setw(12) << "ms" << std::endl;
+
+    // every timeframe against a copy aggregated by hand
+    struct Timeframe {
+        const char* name;
+        int64_t interval;
+    };
+    const Timeframe timeframes[] = {
+        {"hour", MarketData::kHour}, {"day", MarketData::kDay}, {"week", MarketData::kWeek}};
+    bool allSame = true;
+    for (const Timeframe& timeframe : timeframes) {
+        allSame = allSame && sameBars(minutes.resample(timeframe.interval), aggregateCopy(bars, timeframe.interval));
+    }
+    // hours resampled again into days are the same days
+    allSame = allSame && sameBars(minutes.resample(MarketData::kHour).resample(MarketData::kDay),
+                                  aggregateCopy(bars, MarketData::kDay));
+
+    // what a fresh hourly view costs: the bucket index, then the close column
+    // on first read, then nothing for every later view of the same bars
+    double indexSeconds = 0.0;
+    double closeSeconds = 0.0;
+    double hitSeconds = 0.0;
+    for (int repeat = 0; repeat < 3; repeat++) {
+        MarketData fresh(bars, MarketData::Layout::Columns);
+        auto start = std::chrono::steady_clock::now();
+        MarketData hours = fresh.resample(MarketData::kHour);
+        auto indexed = std::chrono::steady_clock::now();
+        benchSink = hours.close()[hours.size() - 1];
+        auto aggregated = std::chrono::steady_clock::now();
+        MarketData again = fresh.slice(0, fresh.size()).resample(MarketData::kHour);
+        benchSink = again.close()[again.size() - 1];
+        auto shared = std::chrono::steady_clock::now();
+        auto seconds = [](auto from, auto to) { return std::chrono::duration<double>(to - from).count(); };
+        indexSeconds = repeat == 0 ? seconds(start, indexed) : std::min(indexSeconds, seconds(start, indexed));
+        closeSeconds = repeat == 0 ? seconds(indexed, aggregated) : std::min(closeSeconds, seconds(indexed, aggregated));
+        hitSeconds = repeat == 0 ? seconds(aggregated, shared) : std::min(hitSeconds, seconds(aggregated, shared));
+    }
+    row("resample(kHour), bucket index", rows, indexSeconds);
+    row("first close() of the hourly view", rows, closeSeconds);
+    row("resample(kHour) again, shared", rows, hitSeconds);
+    row("aggregated copy + MarketData (hours)", rows, bestOf(3, [&] {
+        MarketData copy(aggregateCopy(bars, MarketData::kHour), MarketData::Layout::Columns);
+        benchSink = copy.close()[copy.size() - 1];
+    }));
+
+    // SMA + RSI on every timeframe off the one minute store
+    double multiSeconds = bestOf(3, [&] {
+        MarketData store(bars, MarketData::Layout::Columns);
+        std::vector<MarketData> views = {store, store.resample(MarketData::kHour), store.resample(MarketData::kDay)};
+        for (const MarketData& view : views) {
+            BacktestEngine engine(view);
+            engine.addStrategy("SMA(10,40)", std::unique_ptr<Strategy>(new SMACrossoverStrategy(10, 40)),
+                               Portfolio(10000.0));
+            engine.addStrategy("RSI(14)", std::unique_ptr<Strategy>(new RSIStrategy(14)), Portfolio(10000.0));
+            engine.run(BacktestEngine::Mode::Batch);
+            benchSink = engine.getReturn(0);
+        }
+    });
+    row("SMA+RSI on minute, hour and day", rows, multiSeconds);
+
+    MarketData hours = minutes.resample(MarketData::kHour);
+    MarketData days = minutes.resample(MarketData::kDay);
+    // what the close-only runs above made the views hold
+    size_t heldBytes = (hours.size() + days.size()) * (sizeof(int64_t) + sizeof(size_t) + sizeof(double));
+    std::cout << hours.size() << " hours, " << days.size() << " days; close-only views hold " << heldBytes / 1024
+              << " KB next to the " << rows * sizeof(Bar) / 1024 << " KB minute store" << std::endl;
+    std::cout << "matches the aggregated copies (hour, day, week, hour->day): " << (allSame ? "yes" : "NO")
+              << std::endl;
+}
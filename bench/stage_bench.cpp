@@ -0,0 +1,155 @@
+#include "bench.h"
+#include "backtest_engine.h"
+#include "portfolio.h"
+#include "rsi_strategy.h"
+#include "sma_crossover_strategy.h"
+#include "universe_backtest.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace {
+
+// prints the row and adds it to the --json report
+void stage(const char* name, size_t rows, double seconds) {
+    recordResult(name, rows, seconds);
+    std::cout << std::left << std::setw(34) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(12) << seconds * 1e9 / rows << std::setw(12) << rows / seconds / 1e6
+              << std::defaultfloat << std::endl;
+}
+
+void addStrategies(BacktestEngine& engine) {
+    engine.addStrategy("SMA(10,40)", std::unique_ptr<Strategy>(new SMACrossoverStrategy(10, 40)), Portfolio(10000.0));
+    engine.addStrategy("RSI(14)", std::unique_ptr<Strategy>(new RSIStrategy(14)), Portfolio(10000.0));
+}
+
+}
+
+void runStageBench(size_t rows) {
+    // every stage from the CSV to a finished backtest, on GBM bars
+    SyntheticSpec spec;
+    spec.rows = rows;
+    spec.symbols = benchSymbols;
+    std::cout << rows << " GBM bars (seed " << spec.seed << "), " << spec.symbols << " symbols for the universe stage"
+              << std::endl;
+    std::cout << std::left << std::setw(34) << "stage" << std::right << std::setw(12) << "ns/bar"
+              << std::setw(12) << "Mrows/s" << std::endl;
+
+    std::vector<Bar> bars;
+    double generateSeconds = bestOf(3, [&] { bars = makeGBMBars(spec); });
+    stage("makeGBMBars", rows, generateSeconds);
+
+    std::string file = "/tmp/backtester_stages.csv";
+    if (!writeCsv(file, bars)) {
+        std::cout << "could not write " << file << std::endl;
+        return;
+    }
+
+    // loaders, straight from the CSV every time (no binary cache)
+    MarketData loaded;
+    stage("MarketData::loadFromFile", rows, bestOf(3, [&] { loaded.loadFromFile(file); }));
+    stage("MarketData::loadFromFileMapped", rows, bestOf(3, [&] { loaded.loadFromFileMapped(file); }));
+    stage("MarketData::loadFromFileParallel", rows, bestOf(3, [&] { loaded.loadFromFileParallel(file); }));
+
+    // the row parser alone, from memory. parseLine() is private; parseCsvRow()
+    // is what every loader calls per row
+    std::ifstream in(file);
+    std::stringstream text;
+    text << in.rdbuf();
+    std::string csv = text.str();
+    size_t parsedRows = 0;
+    double parseSeconds = bestOf(3, [&] {
+        Bar bar;
+        parsedRows = 0;
+        const char* begin = csv.c_str();
+        const char* end = begin + csv.size();
+        const char* line = std::find(begin, end, '\n') + 1;  // past the header
+        while (line < end) {
+            const char* lineEnd = std::find(line, end, '\n');
+            parsedRows += MarketData::parseCsvRow(line, lineEnd, bar);
+            benchSink = bar.close;
+            line = lineEnd + 1;
+        }
+    });
+    stage("MarketData::parseCsvRow", parsedRows, parseSeconds);
+
+    // the window recomputations the strategies started from
+    MarketData data(bars, MarketData::Layout::Columns);
+    stage("calculateMA(50)", rows, bestOf(3, [&] {
+        double sum = 0.0;
+        for (size_t i = 0; i < rows; i++) {
+            sum += SMACrossoverStrategy::calculateMA(data, i, 50);
+        }
+        benchSink = sum;
+    }));
+    stage("calculateRSI(14)", rows, bestOf(3, [&] {
+        double sum = 0.0;
+        for (size_t i = 0; i < rows; i++) {
+            sum += RSIStrategy::calculateRSI(data, i, 14);
+        }
+        benchSink = sum;
+    }));
+
+    // a buy or a sell on every bar, the busiest a Portfolio gets
+    ColumnView<double> close = data.close();
+    Portfolio portfolio(10000.0);
+    stage("Portfolio::executeSignal", rows, bestOf(3, [&] {
+        portfolio.reset(10000.0);
+        for (size_t i = 0; i < rows; i++) {
+            portfolio.executeSignal(i % 2 == 0 ? Signal::Buy : Signal::Sell, close[i], i);
+        }
+        benchSink = portfolio.getCash();
+    }));
+
+    // end to end: SMA(10,40) and RSI(14) over the bars, per bar and batch
+    for (BacktestEngine::Mode mode : {BacktestEngine::Mode::PerBar, BacktestEngine::Mode::Batch}) {
+        double seconds = bestOf(3, [&] {
+            data.indicatorCache().clear();
+            BacktestEngine engine(data);
+            addStrategies(engine);
+            engine.run(mode);
+            benchSink = engine.getReturn(0);
+        });
+        stage(mode == BacktestEngine::Mode::PerBar ? "backtest SMA+RSI, per bar" : "backtest SMA+RSI, batch", rows,
+              seconds);
+    }
+    stage("CSV to backtest SMA+RSI", rows, bestOf(3, [&] {
+        MarketData fresh;
+        fresh.loadFromFileMapped(file);
+        fresh.setLayout(MarketData::Layout::Columns);
+        BacktestEngine engine(fresh);
+        addStrategies(engine);
+        engine.run(BacktestEngine::Mode::Batch);
+        benchSink = engine.getReturn(0);
+    }));
+    std::remove(file.c_str());
+
+    // the same rows split over benchSymbols CSV files, backtested in parallel
+    std::string dir = "/tmp/backtester_stages";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    SyntheticSpec universeSpec = spec;
+    universeSpec.rows = std::max<size_t>(rows / spec.symbols, 1000);
+    std::vector<std::vector<Bar>> series = makeGBMUniverse(universeSpec);
+    for (size_t s = 0; s < series.size(); s++) {
+        char name[64];
+        std::snprintf(name, sizeof(name), "%s/daily_G%03zu.csv", dir.c_str(), s);
+        writeCsv(name, series[s]);
+    }
+    Universe universe;
+    universe.loadDirectory(dir);
+    UniverseBacktest backtest(universe);
+    double universeSeconds = bestOf(3, [&] {
+        for (const SymbolInfo& symbol : universe.symbols()) {
+            std::remove((symbol.file + ".bcache").c_str());
+        }
+        backtest.run([](BacktestEngine& engine, const SymbolInfo&) { addStrategies(engine); });
+    });
+    stage("universe CSV to backtest SMA+RSI", universeSpec.rows * series.size(), universeSeconds);
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,98 @@
+#include "bench.h"
+#include "rsi_strategy.h"
+#include "sma_crossover_strategy.h"
+#include "static_strategy.h"
+#include <iomanip>
+#include <iostream>
+#include <memory>
+
+namespace {
+
+// the virtual per-bar path, called through the base like the engine does
+std::vector<Signal> perBar(Strategy& strategy, const MarketData& data) {
+    std::vector<Signal> signals(data.size());
+    for (size_t i = 0; i < data.size(); i++) {
+        signals[i] = strategy.analyze(data, i);
+    }
+    return signals;
+}
+
+size_t countMismatches(const std::vector<Signal>& a, const std::vector<Signal>& b) {
+    size_t mismatches = a.size() != b.size();
+    for (size_t i = 0; i < a.size() && i < b.size(); i++) {
+        mismatches += a[i] != b[i];
+    }
+    return mismatches;
+}
+
+void printRow(const char* path, size_t rows, double seconds, double baseline, size_t mismatches) {
+    std::cout << std::left << std::setw(18) << "" << std::setw(14) << path << std::right << std::fixed
+              << std::setprecision(1) << std::setw(10) << rows / seconds / 1e6 << std::setw(9)
+              << baseline / seconds << "x" << std::setw(10) << mismatches << std::defaultfloat << std::endl;
+}
+
+template <typename Static>
+void benchPair(const char* name, Strategy& virtualStrategy, const MarketData& data) {
+    size_t rows = data.size();
+    std::vector<Signal> reference;
+    double virtualSeconds = bestOf(3, [&] { reference = perBar(virtualStrategy, data); });
+    std::cout << std::left << std::setw(18) << name << std::setw(14) << "virtual" << std::right << std::fixed
+              << std::setprecision(1) << std::setw(10) << rows / virtualSeconds / 1e6 << std::defaultfloat
+              << std::endl;
+
+    // the fused step over the close column
+    std::vector<Signal> signals(rows);
+    Static strategy;
+    double staticSeconds = bestOf(3, [&] { strategy.analyzeRange(data, 0, rows, signals.data()); });
+    printRow("static", rows, staticSeconds, virtualSeconds, countMismatches(signals, reference));
+
+    // behind the virtual interface again
+    StaticStrategyAdapter<Static> adapter;
+    std::vector<Signal> adapted;
+    double adapterSeconds = bestOf(3, [&] { adapted = perBar(adapter, data); });
+    printRow("adapter", rows, adapterSeconds, virtualSeconds, countMismatches(adapted, reference));
+
+    // signal and trade in one loop against the engine's per-bar shape
+    double virtualReturn = 0.0;
+    double loopSeconds = bestOf(3, [&] {
+        Portfolio portfolio(10000.0);
+        ColumnView<double> close = data.close();
+        for (size_t i = 0; i < rows; i++) {
+            Signal signal = virtualStrategy.analyze(data, i);
+            if (signal != Signal::Hold) {
+                portfolio.executeSignal(signal, close[i], i);
+            }
+        }
+        virtualReturn = portfolio.getReturn(close[rows - 1]);
+    });
+    double staticReturn = 0.0;
+    double fusedSeconds = bestOf(3, [&] {
+        Portfolio portfolio(10000.0);
+        staticReturn = backtestStatic(strategy, data, portfolio);
+    });
+    std::cout << std::left << std::setw(18) << "" << std::setw(14) << "backtest" << std::right << std::fixed
+              << std::setprecision(1) << std::setw(10) << rows / fusedSeconds / 1e6 << std::setw(9)
+              << loopSeconds / fusedSeconds << "x" << std::setw(10) << (staticReturn == virtualReturn ? 0 : 1)
+              << std::defaultfloat << std::endl;
+}
+
+}
+
+void runStaticBench(size_t rows) {
+    MarketData data(makeRandomWalkBars(rows), MarketData::Layout::Columns);
+
+    std::cout << std::left << std::setw(18) << "strategy" << std::setw(14) << "path" << std::right
+              << std::setw(10) << "Mbars/s" << std::setw(10) << "speedup" << std::setw(10) << "sig.diff" << std::endl;
+
+    SMACrossoverStrategy sma(10, 40);
+    benchPair<StaticSMACrossover<10, 40>>("SMA(10,40)", sma, data);
+    SMACrossoverStrategy longSma(50, 200);
+    benchPair<StaticSMACrossover<50, 200>>("SMA(50,200)", longSma, data);
+    RSIStrategy rsi(14);
+    benchPair<StaticRSIStrategy<14>>("RSI(14)", rsi, data);
+    RSIStrategy wideRsi(14, 25.0, 75.0);
+    benchPair<StaticRSIStrategy<14, Levels<25, 75>>>("RSI(14,25/75)", wideRsi, data);
+
+    std::cout << "(backtest row: signal + Portfolio in one loop, speedup over the virtual per-bar loop,"
+              << " sig.diff 1 if the returns differ)" << std::endl;
+}
@@ -0,0 +1,124 @@
+#include "bench.h"
+#include "backtest_engine.h"
+#include "bar_cache.h"
+#include "bar_source.h"
+#include "rsi_strategy.h"
+#include "sma_crossover_strategy.h"
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace {
+
+// resident set high-water mark since the last resetPeakMemory(), in bytes. 0 where
+// /proc isn't available
+size_t peakMemory() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return std::stoull(line.substr(6)) * 1024;
+        }
+    }
+    return 0;
+}
+
+void resetPeakMemory() {
+    std::ofstream clear("/proc/self/clear_refs");
+    clear << "5";
+}
+
+void addStrategies(BacktestEngine& engine) {
+    engine.addStrategy("SMA", std::unique_ptr<Strategy>(new SMACrossoverStrategy(10, 40)), Portfolio(10000.0));
+    engine.addStrategy("RSI", std::unique_ptr<Strategy>(new RSIStrategy(14)), Portfolio(10000.0));
+}
+
+bool sameResults(const BacktestEngine& a, const BacktestEngine& b) {
+    bool same = a.barsProcessed() == b.barsProcessed();
+    for (size_t slot = 0; slot < a.size(); slot++) {
+        same = same && a.getReturn(slot) == b.getReturn(slot) &&
+               a.getStats(slot).signalChanges == b.getStats(slot).signalChanges;
+    }
+    return same;
+}
+
+void printRow(const char* path, size_t rows, double seconds, size_t peakBytes, bool same) {
+    std::cout << std::left << std::setw(24) << path << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << rows / seconds / 1e6 << std::setw(12) << peakBytes / (1024.0 * 1024.0)
+              << std::setw(8) << (same ? "yes" : "NO") << std::defaultfloat << std::endl;
+}
+
+}
+
+void runStreamBench(size_t rows) {
+    std::string oldestFirst = "/tmp/backtester_stream_fwd.csv";
+    std::string newestFirst = "/tmp/backtester_stream_rev.csv";
+    std::string binary = "/tmp/backtester_stream.bcache";
+    {
+        std::vector<Bar> bars = makeRandomWalkBars(rows);
+        MarketData data(bars, MarketData::Layout::Columns);
+        if (!writeCsv(oldestFirst, bars, false) || !writeCsv(newestFirst, bars, true) ||
+            !BarCache::write(binary, data, SourceStamp())) {
+            std::cout << "could not write the bench files to /tmp" << std::endl;
+            return;
+        }
+    }
+
+    std::cout << rows << " bars, SMA(10,40) + RSI(14), peak = resident high-water mark during the run" << std::endl;
+    std::cout << std::left << std::setw(24) << "path" << std::right << std::setw(10) << "Mbars/s"
+              << std::setw(12) << "peak MiB" << std::setw(8) << "same" << std::endl;
+
+    // streaming first, before the in-memory run grows the heap
+    struct Run {
+        const char* name;
+        std::string file;
+        size_t capacity;
+    };
+    const Run runs[] = {
+        {"stream csv", oldestFirst, 0},
+        {"stream csv newest-first", newestFirst, 0},
+        {"stream binary", binary, 0},
+        {"stream binary, 4x window", binary, 4 * 41},  // moves every ~120 bars
+    };
+    std::vector<std::unique_ptr<BacktestEngine>> streamed;
+    std::vector<double> streamSeconds;
+    std::vector<size_t> streamPeaks;
+    for (const Run& run : runs) {
+        streamed.emplace_back(new BacktestEngine());
+        addStrategies(*streamed.back());
+        resetPeakMemory();
+        size_t before = peakMemory();
+        BarSource source;
+        source.open(run.file);
+        streamed.back()->runStreaming(source, run.capacity);
+        streamSeconds.push_back(streamed.back()->lastRunSeconds());
+        streamPeaks.push_back(peakMemory() - before);
+    }
+
+    // the in-memory path: load the whole file, then run
+    resetPeakMemory();
+    size_t before = peakMemory();
+    auto start = std::chrono::steady_clock::now();
+    MarketData data;
+    data.setLayout(MarketData::Layout::Columns);
+    data.loadFromFileMapped(oldestFirst);
+    BacktestEngine engine(data);
+    addStrategies(engine);
+    engine.run();
+    double inMemorySeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    size_t inMemoryPeak = peakMemory() - before;
+
+    printRow("in-memory csv (load+run)", rows, inMemorySeconds, inMemoryPeak, true);
+    printRow("in-memory run only", rows, engine.lastRunSeconds(), inMemoryPeak, true);
+    for (size_t i = 0; i < streamed.size(); i++) {
+        printRow(runs[i].name, rows, streamSeconds[i], streamPeaks[i], sameResults(*streamed[i], engine));
+    }
+    std::cout << "window " << streamed[0]->lastWindowBytes() / 1024 << " KiB by default, "
+              << streamed.back()->lastWindowBytes() << " bytes for the 4x window" << std::endl;
+
+    std::remove(oldestFirst.c_str());
+    std::remove(newestFirst.c_str());
+    std::remove(binary.c_str());
+}
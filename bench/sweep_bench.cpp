@@ -0,0 +1,97 @@
+#include "bench.h"
+#include "parameter_sweep.h"
+#include "sma_crossover_strategy.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+void runSweepBench(size_t rows) {
+    // a grid point walks every bar, so a tenth of the rows keeps this group quick
+    size_t bars = std::max<size_t>(rows / 10, 1000);
+    MarketData data(makeRandomWalkBars(bars), MarketData::Layout::Columns);
+    std::vector<SMAParams> grid = ParameterSweep::smaGrid(2, 21, 22, 121, 2);
+
+    std::cout << grid.size() << " SMA combinations over " << bars << " bars, hardware threads: "
+              << std::thread::hardware_concurrency() << std::endl;
+    std::cout << std::setw(8) << "threads" << std::setw(14) << "combos/s" << std::setw(10) << "scaling"
+              << std::setw(14) << "best return" << std::endl;
+
+    size_t maxThreads = std::max<size_t>(std::thread::hardware_concurrency(), 2);
+    double single = 0.0;
+    std::vector<SweepResult> reference;
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        ThreadPool pool(threads);
+        ParameterSweep sweep(data, 10000.0, pool);
+
+        std::vector<SweepResult> results;
+        // a cold cache each time, like a fresh sweep over new data
+        double seconds = bestOf(2, [&] {
+            data.indicatorCache().clear();
+            results = sweep.runSMA(grid);
+        });
+        double rate = grid.size() / seconds;
+        if (threads == 1) {
+            single = rate;
+            reference = results;
+        }
+
+        // every thread count has to reproduce the single thread results
+        size_t differences = 0;
+        for (size_t i = 0; i < results.size(); i++) {
+            differences += results[i].returnPercent != reference[i].returnPercent ||
+                           results[i].trades != reference[i].trades;
+        }
+
+        std::cout << std::setw(8) << threads << std::fixed << std::setprecision(0) << std::setw(14) << rate
+                  << std::setprecision(2) << std::setw(9) << rate / single << "x"
+                  << std::setw(13) << ParameterSweep::best(results, 1)[0].returnPercent << "%"
+                  << std::defaultfloat;
+        if (differences > 0) {
+            std::cout << "  (" << differences << " results differ!)";
+        }
+        std::cout << std::endl;
+    }
+
+    // the same grid with every task computing its own averages
+    ThreadPool pool(1);
+    ParameterSweep sweep(data, 10000.0, pool);
+    std::vector<SweepResult> uncached;
+    double uncachedSeconds = bestOf(2, [&] {
+        uncached = sweep.run(grid.size(), [&grid](size_t i) {
+            auto strategy = std::unique_ptr<SMACrossoverStrategy>(
+                new SMACrossoverStrategy(grid[i].shortPeriod, grid[i].longPeriod));
+            strategy->setIndicatorCache(false);
+            return std::unique_ptr<Strategy>(std::move(strategy));
+        });
+    });
+    size_t differences = 0;
+    for (size_t i = 0; i < uncached.size(); i++) {
+        differences += uncached[i].returnPercent != reference[i].returnPercent ||
+                       uncached[i].trades != reference[i].trades;
+    }
+
+    data.indicatorCache().clear();
+    IndicatorCacheStats before = data.indicatorCache().stats();
+    double cachedSeconds = bestOf(1, [&] { sweep.runSMA(grid); });
+    IndicatorCacheStats after = data.indicatorCache().stats();
+
+    std::cout << "\n1 thread, indicator cache off: " << std::fixed << std::setprecision(0)
+              << grid.size() / uncachedSeconds << " combos/s, on: " << grid.size() / cachedSeconds
+              << " combos/s (" << std::setprecision(2) << uncachedSeconds / cachedSeconds << "x), "
+              << after.misses - before.misses << " series computed, " << after.hits - before.hits << " hits, "
+              << after.bytes / (1024 * 1024) << " MiB cached" << std::defaultfloat << std::endl;
+    if (differences > 0) {
+        std::cout << "  (" << differences << " results differ without the cache!)" << std::endl;
+    }
+
+    // what the per-bar PerformanceTracker costs, both runs with a warm cache
+    double trackedSeconds = bestOf(2, [&] { sweep.runSMA(grid); });
+    sweep.setTrackPerformance(false);
+    double untrackedSeconds = bestOf(2, [&] { sweep.runSMA(grid); });
+    std::cout << "1 thread, performance tracking on: " << std::fixed << std::setprecision(0)
+              << grid.size() / trackedSeconds << " combos/s, off: " << grid.size() / untrackedSeconds
+              << " combos/s (" << std::setprecision(2)
+              << (trackedSeconds - untrackedSeconds) * 1e9 / (static_cast<double>(grid.size()) * bars)
+              << " ns per bar)" << std::defaultfloat << std::endl;
+}
@@ -0,0 +1,86 @@
+#include "bench.h"
+#include "parameter_sweep.h"
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+void printRow(const char* name, double seconds, size_t combinations, size_t heldBytes) {
+    std::cout << std::left << std::setw(30) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << seconds * 1000.0 << std::setw(12) << std::setprecision(0)
+              << combinations / seconds << std::setw(14) << heldBytes / 1024 << std::defaultfloat << std::endl;
+}
+
+bool sameCombinations(const std::vector<SweepResult>& a, const std::vector<SweepResult>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].combination != b[i].combination) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+void runTopKBench(size_t rows) {
+    // lots of short backtests: the regime where keeping every result costs
+    // more memory than the data itself
+    size_t bars = std::max<size_t>(rows / 500, 1000);
+    MarketData data(makeRandomWalkBars(bars), MarketData::Layout::Columns);
+    std::vector<SMAParams> grid = ParameterSweep::smaGrid(2, 101, 3, 300);
+    const size_t k = 10;
+
+    std::cout << grid.size() << " SMA combinations over " << bars << " bars, top " << k << " by Sharpe" << std::endl;
+    std::cout << std::left << std::setw(30) << "selection" << std::right << std::setw(10) << "ms"
+              << std::setw(12) << "combos/s" << std::setw(14) << "results KiB" << std::endl;
+
+    ParameterSweep sweep(data, 10000.0);
+    sweep.runSMATopK(grid, k);  // warms the indicator cache for every row below
+
+    std::vector<SweepResult> all;
+    std::vector<SweepResult> fromAll;
+    double allSeconds = bestOf(1, [&] {
+        all = sweep.runSMA(grid);
+        fromAll = ParameterSweep::best(all, k, SweepMetric::Sharpe);
+    });
+    printRow("run() + best()", allSeconds, grid.size(), all.capacity() * sizeof(SweepResult));
+
+    std::vector<SweepResult> top;
+    double topSeconds = bestOf(1, [&] { top = sweep.runSMATopK(grid, k, SweepMetric::Sharpe); });
+    size_t heapBytes = (ThreadPool::shared().size() + 1) * k * sizeof(SweepResult);
+    printRow("runTopK()", topSeconds, grid.size(), heapBytes);
+
+    std::string file = "/tmp/backtester_topk.results";
+    ResultWriter writer;
+    std::vector<SweepResult> stored;
+    double storeSeconds = 0.0;
+    if (writer.open(file)) {
+        storeSeconds = bestOf(1, [&] { stored = sweep.runSMATopK(grid, k, SweepMetric::Sharpe, &writer); });
+        writer.close();
+        printRow("runTopK() + result file", storeSeconds, grid.size(), heapBytes);
+    }
+
+    std::cout << "same top " << k << ": " << (sameCombinations(top, fromAll) && sameCombinations(stored, fromAll)
+                                               ? "yes" : "NO") << std::endl;
+
+    // filtering the file afterwards, straight from the mapping
+    ResultStore store;
+    if (store.open(file)) {
+        std::vector<StoredResult> kept;
+        double filterSeconds = bestOf(3, [&] {
+            kept = store.filter([](const StoredResult& r) { return r.sharpe > 0.0 && r.maxDrawdown < 25.0; });
+        });
+        std::cout << store.size() << " records, " << store.size() * sizeof(StoredResult) / 1024
+                  << " KiB on disk; filter (Sharpe > 0, drawdown < 25%) kept " << kept.size() << " in "
+                  << std::fixed << std::setprecision(2) << filterSeconds * 1000.0 << " ms ("
+                  << std::setprecision(0) << store.size() / filterSeconds / 1e6 << " M records/s)"
+                  << std::defaultfloat << std::endl;
+    }
+    store.close();
+    std::remove(file.c_str());
+}
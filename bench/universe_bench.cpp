@@ -0,0 +1,72 @@
+#include "bench.h"
+#include "rsi_strategy.h"
+#include "sma_crossover_strategy.h"
+#include "universe_backtest.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace {
+
+void addStrategies(BacktestEngine& engine, const SymbolInfo&) {
+    engine.addStrategy("SMA(10,40)", std::unique_ptr<Strategy>(new SMACrossoverStrategy(10, 40)), Portfolio(10000.0));
+    engine.addStrategy("RSI(14)", std::unique_ptr<Strategy>(new RSIStrategy(14)), Portfolio(10000.0));
+}
+
+}
+
+void runUniverseBench(size_t rows) {
+    // 48 symbols, a few long histories and many short ones, about `rows` bars in total
+    std::string dir = "/tmp/backtester_universe";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    const size_t symbols = 48;
+    size_t unit = std::max<size_t>(rows / 120, 200);
+    for (size_t i = 0; i < symbols; i++) {
+        size_t bars = i < 4 ? unit * 12 : unit * (1 + i % 3);
+        char name[64];
+        std::snprintf(name, sizeof(name), "%s/daily_S%03zu.csv", dir.c_str(), (i * 7) % symbols);
+        if (!writeCsv(name, makeRandomWalkBars(bars, 1000 + i))) {
+            std::cout << "could not write the bench files to " << dir << std::endl;
+            return;
+        }
+    }
+
+    Universe universe;
+    universe.loadDirectory(dir);
+    std::cout << universe.size() << " symbols, " << universe.totalBytes() / (1024 * 1024) << " MiB of CSV, "
+              << "hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+    std::cout << std::left << std::setw(28) << "schedule" << std::right << std::setw(10) << "ms"
+              << std::setw(12) << "symbols/s" << std::setw(10) << "resident" << std::endl;
+
+    auto report = [&](const char* name, UniverseBacktest& backtest) {
+        // the binary caches the first run wrote would make later runs faster, start clean each time
+        for (const SymbolInfo& symbol : universe.symbols()) {
+            std::remove((symbol.file + ".bcache").c_str());
+        }
+        std::vector<SymbolResult> results = backtest.run(addStrategies);
+        std::cout << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << backtest.lastSeconds() * 1000.0 << std::setw(12)
+                  << universe.size() / backtest.lastSeconds() << std::setw(10) << backtest.peakResident()
+                  << std::defaultfloat << std::endl;
+        return results;
+    };
+
+    size_t threads = std::max<size_t>(std::thread::hardware_concurrency(), 2);
+    ThreadPool pool(threads);
+    UniverseBacktest backtest(universe, pool);
+    backtest.setLargestFirst(false);
+    report("id order", backtest);
+    backtest.setLargestFirst(true);
+    std::vector<SymbolResult> results = report("largest first", backtest);
+    backtest.setMaxResident(2);
+    report("largest first, 2 resident", backtest);
+
+    std::cout << std::endl;
+    UniverseBacktest::printSummary(UniverseBacktest::summarize(results), universe);
+    std::filesystem::remove_all(dir);
+}
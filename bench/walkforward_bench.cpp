@@ -0,0 +1,52 @@
+#include "bench.h"
+#include "walk_forward.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+void runWalkForwardBench(size_t rows) {
+    size_t bars = std::max<size_t>(rows / 10, 5000);
+    MarketData data(makeRandomWalkBars(bars), MarketData::Layout::Columns);
+    std::vector<SMAParams> grid = ParameterSweep::smaGrid(2, 21, 22, 81, 2);
+    size_t train = bars / 10;
+    size_t test = bars / 40;
+
+    WalkForward walkForward(data, 10000.0);
+    walkForward.setWindows(train, test);
+    size_t folds = walkForward.folds(bars).size();
+    std::cout << grid.size() << " SMA combinations, " << folds << " folds of " << train << " train + " << test
+              << " test bars, hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+
+    // a sweep per fold on a slice of the train window: every fold recomputes
+    // its averages for its own bars and warms them up inside the window
+    std::vector<size_t> naiveBest;
+    double naiveSeconds = bestOf(1, [&] {
+        data.indicatorCache().clear();
+        naiveBest.clear();
+        for (const WalkForwardFold& fold : walkForward.folds(bars)) {
+            ParameterSweep sweep(data.slice(fold.trainBegin, fold.trainEnd - fold.trainBegin), 10000.0);
+            sweep.setTrackPerformance(false);
+            naiveBest.push_back(sweep.runSMATopK(grid, 1)[0].combination);
+        }
+    });
+
+    WalkForwardResult result;
+    double walkSeconds = bestOf(1, [&] {
+        data.indicatorCache().clear();
+        result = walkForward.runSMA(grid);
+    });
+
+    size_t agree = 0;
+    for (size_t f = 0; f < folds; f++) {
+        agree += naiveBest[f] == result.folds[f].best;
+    }
+    std::cout << std::fixed << std::setprecision(1) << "sweep per fold (train only): " << naiveSeconds * 1000.0
+              << " ms, walk-forward (train + test): " << walkSeconds * 1000.0 << " ms ("
+              << std::setprecision(2) << naiveSeconds / walkSeconds << "x)" << std::endl;
+    std::cout << "same winner in " << agree << " of " << folds << " folds (the per-fold sweep warms up inside"
+              << " the window)" << std::endl;
+    std::cout << "out of sample: " << result.outOfSample.totalReturn << "% over " << result.equity.size()
+              << " bars, Sharpe " << result.outOfSample.sharpe << ", max drawdown "
+              << result.outOfSample.maxDrawdown << "%" << std::defaultfloat << std::endl;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "bar_source.h"
+#include "market_data.h"
+#include "performance_tracker.h"
+#include "portfolio.h"
+#include "strategy.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+class ProfileLoop;
+
+// what the engine counted for one strategy during run()
+struct StrategyStats {
+    size_t buySignals = 0;
+    size_t sellSignals = 0;
+    size_t holdSignals = 0;
+    size_t signalChanges = 0;  // Buy/Sell differing from the previous bar's signal
+};
+
+/**
+ * @brief BacktestEngine runs any number of strategies over one pass of the data
+ *
+ * Each registered strategy trades its own Portfolio. run() walks the bars
+ * once, oldest first, and hands every bar to all strategies while it is hot
+ * in cache, instead of one full traversal per strategy.
+ *
+ * Mode::Batch asks every strategy for its whole signal column up front
+ * (Strategy::analyzeAll(), SIMD for the built-in strategies) and then makes
+ * the single pass to trade them. Signals are the same in both modes.
+ *
+ * runStreaming() takes its bars from a BarSource instead and keeps only a
+ * BarWindow as long as the longest Strategy::lookback() (times a constant),
+ * so memory doesn't grow with the file. Strategies see the bars through the
+ * window, per bar, like Mode::PerBar.
+ *
+ * Every slot also feeds a PerformanceTracker with its portfolio value at
+ * each close, so Sharpe, drawdown and the rest come out of the same pass.
+ */
+class BacktestEngine {
+public:
+    enum class Mode {
+        PerBar,  // analyze() bar by bar
+        Batch,   // analyzeAll() per strategy, then one trading pass
+    };
+
+    // data must outlive the engine
+    explicit BacktestEngine(const MarketData& data);
+    // no in-memory data, for runStreaming() only
+    BacktestEngine();
+
+    // returns the slot index used by the getters below
+    size_t addStrategy(const std::string& name, std::unique_ptr<Strategy> strategy, Portfolio portfolio);
+
+    // resets the statistics, portfolios keep trading from where they are
+    void run(Mode mode = Mode::PerBar);
+    // every bar left in source, oldest first. Throws std::logic_error if a
+    // strategy doesn't declare its lookback(). windowCapacity 0 lets
+    // BarWindow pick; day indexes count bars from the start of the stream
+    void runStreaming(BarSource& source, size_t windowCapacity = 0);
+
+    // prints "<name> TRADE <n> - Day <i>: BUY at $<price>" whenever a strategy
+    // switches to a new Buy/Sell signal
+    void setTradeLog(bool enabled);
+    // keep every slot's per-bar equity curve, off by default
+    void setEquityCurve(bool enabled);
+
+    // prints the signal counts and the portfolio summary at the last close
+    void printSummary(size_t slot) const;
+
+    //getters
+    size_t size() const;
+    const std::string& getName(size_t slot) const;
+    Strategy& getStrategy(size_t slot);
+    const Portfolio& getPortfolio(size_t slot) const;
+    const StrategyStats& getStats(size_t slot) const;
+    const PerformanceTracker& getPerformance(size_t slot) const;
+    double getReturn(size_t slot) const;  // at the last close
+    size_t barsProcessed() const;         // by the last run
+    double lastRunSeconds() const;
+    size_t lastWindowBytes() const;       // bar memory of the last streaming run
+
+private:
+    struct Slot {
+        std::string name;
+        std::unique_ptr<Strategy> strategy;
+        Portfolio portfolio;
+        StrategyStats stats;
+        PerformanceTracker performance;
+        Signal lastSignal;
+        std::vector<Signal> signals;  // Mode::Batch only
+    };
+
+    const MarketData* data_;  // nullptr for a streaming-only engine
+    std::vector<Slot> slots_;
+    bool tradeLog_;
+    bool equityCurve_;
+    size_t bars_;
+    double lastClose_;
+    double lastRunSeconds_;
+    size_t lastWindowBytes_;
+
+    // one bar of a per-bar run with every analyze() and record() timed, for
+    // the bars ProfileLoop samples
+    void stepProfiled(ProfileLoop& profile, const MarketData& data, size_t dataIndex, double price, size_t index);
+    void record(Slot& slot, Signal signal, double price, size_t index);
+    void resetSlot(Slot& slot);
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "market_data.h"
+#include "mapped_file.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief SourceStamp identifies the exact version of a source CSV
+ *
+ * A cache is only trusted when the CSV it was built from still has the
+ * same size and modification time.
+ */
+struct SourceStamp {
+    uint64_t size = 0;
+    int64_t mtimeNs = 0;
+
+    static bool read(const std::string& file, SourceStamp& stamp);
+    bool operator==(const SourceStamp& other) const;
+};
+
+/**
+ * @brief BarCache is the binary columnar sidecar written next to a CSV
+ *
+ * Layout (native endian, every block 64 byte aligned):
+ * - header: magic, version, column count and type codes, row count, source stamp
+ * - one column per Bar field in declaration order, rowCount values each:
+ *   timestamp (int64), then open, high, low, close, volume (float64)
+ *
+ * Opening a cache maps it read-only, so loading is a validation of the
+ * header and nothing else; processes reading the same symbol share the
+ * pages through the page cache.
+ */
+class BarCache {
+public:
+    static const uint32_t kVersion = 2;  // 2: int64 epoch nanosecond timestamps
+    static const size_t kColumnCount = 6;
+
+    // "data/daily_AAPL.csv" -> "data/daily_AAPL.csv.bcache"
+    static std::string sidecarPath(const std::string& sourceFile);
+
+    // writes to a temporary file first and renames it into place, so a
+    // reader never sees a half written cache
+    static bool write(const std::string& cacheFile, const MarketData& data, const SourceStamp& source);
+
+    // checks the header (not the source stamp) and reports where each column
+    // starts, for readers that stream the columns with plain file I/O
+    // instead of mapping the file (see BarSource)
+    static bool readLayout(const std::string& cacheFile, size_t& rows, size_t offsets[kColumnCount]);
+
+    BarCache();
+
+    // fails if the file is missing, truncated, from another version or
+    // built from a different source than expected
+    bool open(const std::string& cacheFile, const SourceStamp& expected);
+    void close();
+
+    //getters
+    bool isOpen() const;
+    size_t size() const;
+    size_t fileSize() const;
+    const int64_t* timestamps() const;
+    // column index follows the Bar field order, 1 = open ... 5 = volume
+    const double* column(size_t index) const;
+
+private:
+    MappedFile file_;
+    size_t rows_;
+    const char* columns_[kColumnCount];
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "bar_cache.h"
+#include "market_data.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief BarSource reads bars from a file a chunk at a time, oldest first
+ *
+ * The streaming counterpart of the MarketData loaders: memory is one read
+ * chunk plus the bars parsed from it, whatever the file size.
+ *
+ * - CSV: same row format as MarketData. Files written newest first (like
+ *   the Alpha Vantage exports in data/) are read backwards from the end, so
+ *   bars still come out oldest first. Rows are not sorted beyond that; a row
+ *   older than the one before it is delivered anyway and counted in
+ *   outOfOrderRows().
+ * - Binary: a BarCache sidecar (".bcache"), the columns are read with plain
+ *   file I/O instead of being mapped.
+ */
+class BarSource {
+public:
+    enum class Format {
+        Csv,
+        Binary,
+    };
+
+    BarSource();
+    ~BarSource();
+
+    BarSource(const BarSource&) = delete;
+    BarSource& operator=(const BarSource&) = delete;
+
+    // ".bcache" files are opened as Binary, anything else as Csv
+    bool open(const std::string& file);
+    bool openCsv(const std::string& file);
+    bool openBinary(const std::string& cacheFile);
+    void close();
+
+    // up to `count` next bars into out, 0 once the file is done
+    size_t read(Bar* out, size_t count);
+    bool next(Bar& bar);
+
+    //getters
+    bool isOpen() const;
+    Format getFormat() const;
+    size_t barsRead() const;
+    size_t bytesRead() const;
+    size_t malformedRows() const;
+    size_t outOfOrderRows() const;
+
+    // bytes read from the file per refill
+    static constexpr size_t kChunkBytes = 1 << 20;
+
+private:
+    int fd_;
+    Format format_;
+    size_t fileSize_;
+
+    // CSV: the unread byte range is [dataBegin_, dataEnd_) of the file.
+    // Forward reads move dataBegin_ up, backward reads move dataEnd_ down
+    bool reversed_;
+    size_t dataBegin_;
+    size_t dataEnd_;
+    std::vector<char> chunk_;
+    std::vector<char> partial_;  // a row cut by the last read, finished by the next one
+
+    // binary
+    size_t rows_;
+    size_t nextRow_;
+    size_t offsets_[BarCache::kColumnCount];
+
+    // parsed bars waiting to be handed out, oldest first from pendingNext_
+    std::vector<Bar> pending_;
+    size_t pendingNext_;
+
+    size_t barsRead_;
+    size_t bytesRead_;
+    size_t malformedRows_;
+    size_t outOfOrderRows_;
+    int64_t lastTimestamp_;
+
+    bool readAt(size_t offset, size_t bytes, void* out);
+    bool refill();
+    bool refillCsvForward();
+    bool refillCsvBackward();
+    bool refillBinary();
+    void parseRows(const char* begin, const char* end);
+    bool firstRowTime(const char* begin, const char* end, int64_t& time) const;
+};
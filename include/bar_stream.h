@@ -0,0 +1,59 @@
+#pragma once
+
+#include "market_data.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief BarStream reads CSV bars from a pipe, FIFO, Unix socket or stdin
+ * as they arrive
+ *
+ * Where BarSource owns a whole file (it seeks, and reads newest-first
+ * files backwards), a stream is taken in arrival order: every line that
+ * parses with MarketData::parseCsvRow() is a bar, anything else (a header,
+ * a blank line) is counted in malformedRows() and skipped. Lines are cut
+ * out of one fixed buffer, so next() doesn't allocate.
+ */
+class BarStream {
+public:
+    BarStream();
+    ~BarStream();
+
+    BarStream(const BarStream&) = delete;
+    BarStream& operator=(const BarStream&) = delete;
+
+    // a Unix domain socket is connected to, anything else (a FIFO, a regular
+    // file) is opened for reading
+    bool open(const std::string& path);
+    // an already open descriptor, e.g. 0 for stdin or the read end of a
+    // pipe(). Left open by close()
+    bool openFd(int fd);
+    void close();
+
+    // blocks until the next bar arrives, false once the writer is done
+    bool next(Bar& bar);
+
+    //getters
+    bool isOpen() const;
+    size_t barsRead() const;
+    size_t bytesRead() const;
+    size_t malformedRows() const;
+
+    // longest line kept, longer ones are dropped as malformed
+    static const size_t kBufferBytes = 1 << 16;
+
+private:
+    int fd_;
+    bool ownsFd_;
+    std::vector<char> buffer_;
+    size_t begin_;  // unparsed bytes are buffer_[begin_, end_)
+    size_t end_;
+    bool finished_;  // the writer closed its end
+
+    size_t barsRead_;
+    size_t bytesRead_;
+    size_t malformedRows_;
+
+    bool refill();
+};
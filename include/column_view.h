@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+
+/**
+ * @brief ColumnView is a read-only view of one field across all bars
+ *
+ * In MarketData::Layout::Columns the values sit next to each other
+ * (stride == sizeof(T)) and data() can be handed to tight loops directly.
+ * In Layout::Rows the view walks the same field inside each Bar, so code
+ * written against a view works with either layout.
+ */
+template <typename T>
+class ColumnView {
+public:
+    ColumnView() : base_(nullptr), size_(0), stride_(sizeof(T)) {}
+
+    ColumnView(const T* first, size_t size, size_t strideBytes = sizeof(T)) :
+        base_(reinterpret_cast<const char*>(first)), size_(size), stride_(strideBytes) {}
+
+    const T& operator[](size_t index) const {
+        return *reinterpret_cast<const T*>(base_ + index * stride_);
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    bool isContiguous() const { return stride_ == sizeof(T); }
+
+    // only a plain array when isContiguous()
+    const T* data() const { return reinterpret_cast<const T*>(base_); }
+
+    // copies size() values into out, a single memcpy when contiguous
+    void copyTo(T* out) const {
+        if (isContiguous()) {
+            if (size_ > 0) {
+                std::memcpy(out, base_, size_ * sizeof(T));
+            }
+            return;
+        }
+        for (size_t i = 0; i < size_; i++) {
+            out[i] = (*this)[i];
+        }
+    }
+
+    ColumnView subview(size_t offset, size_t count) const {
+        return ColumnView(reinterpret_cast<const T*>(base_ + offset * stride_), count, stride_);
+    }
+
+private:
+    const char* base_;
+    size_t size_;
+    size_t stride_;  // in bytes
+};
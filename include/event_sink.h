@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// set by the BACKTESTER_EVENTS CMake option. With 0 every emitEvent() call is
+// compiled out, not even the "is there a sink" branch is left
+#ifndef BACKTESTER_ENABLE_EVENTS
+#define BACKTESTER_ENABLE_EVENTS 1
+#endif
+
+enum class TradeEventType : uint8_t {
+    Buy,
+    Sell,
+    RejectedBuy,    // not enough cash, amount = cash that was available
+    RejectedSell,   // nothing to sell
+    InvalidBuy,     // Position refused the quantity
+    InvalidSell,    // Position refused the quantity, amount = shares owned
+};
+
+// fixed size and trivially copyable, so it can sit in a ring buffer
+struct TradeEvent {
+    TradeEventType type;
+    int32_t quantity;
+    size_t dayIndex;
+    double price;
+    double amount;  // cost for Buy, proceeds for Sell, see TradeEventType
+    uint32_t symbol = 0;  // symbol id for MultiAssetPortfolio, 0 from Portfolio
+
+    // the line Portfolio used to print for this event, without newline
+    std::string toString() const;
+};
+
+/**
+ * @brief EventSink receives what Portfolio and Position used to print
+ *
+ * No sink (nullptr) is the null sink and the default: nothing is formatted
+ * or written. ConsoleSink reproduces the old std::cout output and is opt-in.
+ * AsyncFileSink hands events to a background thread through lock-free
+ * per-thread rings, so trading threads never touch the file.
+ */
+class EventSink {
+public:
+    virtual ~EventSink() = default;
+
+    virtual void onEvent(const TradeEvent& event) = 0;
+    // blocks until every event received so far is written
+    virtual void flush() {}
+};
+
+inline void emitEvent(EventSink* sink, const TradeEvent& event) {
+#if BACKTESTER_ENABLE_EVENTS
+    if (sink != nullptr) {
+        sink->onEvent(event);
+    }
+#else
+    (void)sink;
+    (void)event;
+#endif
+}
+
+// one line per event, flushed straight away like the old std::endl output
+class ConsoleSink : public EventSink {
+public:
+    explicit ConsoleSink(std::ostream& out);
+
+    void onEvent(const TradeEvent& event) override;
+    void flush() override;
+
+    // writes to std::cout
+    static ConsoleSink& shared();
+
+private:
+    std::ostream& out_;
+    std::mutex mutex_;  // keeps lines from different threads apart
+};
+
+class AsyncFileSink : public EventSink {
+public:
+    // capacity of each thread's ring, rounded up to a power of two
+    explicit AsyncFileSink(const std::string& file, size_t ringCapacity = 1 << 14);
+    ~AsyncFileSink();  // writes what is left and closes the file
+
+    AsyncFileSink(const AsyncFileSink&) = delete;
+    AsyncFileSink& operator=(const AsyncFileSink&) = delete;
+
+    // wait-free for the caller; an event that finds its thread's ring full is
+    // dropped and counted rather than blocking the backtest
+    void onEvent(const TradeEvent& event) override;
+    void flush() override;
+
+    //getters
+    bool isOpen() const;
+    size_t written() const;
+    size_t dropped() const;
+
+private:
+    // single producer (the thread it belongs to), single consumer (the drain)
+    struct Ring {
+        std::vector<TradeEvent> slots;
+        size_t mask;
+        // producer side
+        alignas(64) std::atomic<size_t> head;  // next slot the producer writes
+        size_t cachedTail;                     // last tail the producer saw
+        std::atomic<size_t> dropped;
+        // consumer side
+        alignas(64) std::atomic<size_t> tail;  // next slot the consumer reads
+
+        explicit Ring(size_t capacity);
+    };
+
+    uint64_t id_;  // tells this sink's rings apart in the per-thread lookup
+    size_t ringCapacity_;
+    std::FILE* file_;
+
+    mutable std::mutex ringsMutex_;  // only taken the first time a thread emits
+    std::vector<std::unique_ptr<Ring>> rings_;
+
+    std::mutex drainMutex_;  // one consumer at a time, drainer thread or flush()
+    std::atomic<size_t> written_;
+    std::atomic<bool> stopping_;
+    std::thread drainer_;
+
+    Ring& localRing();
+    size_t drain();
+    void drainLoop();
+};
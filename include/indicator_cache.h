@@ -0,0 +1,104 @@
+#pragma once
+
+#include "column_view.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+enum class IndicatorKind : uint8_t {
+    SMA,
+    EMA,
+    RSI,        // RollingRSI (Cutler)
+    WilderRSI,
+    StdDev,
+    Min,
+    Max,
+};
+
+// what a cached series was computed from
+struct IndicatorKey {
+    IndicatorKind kind;
+    size_t period;
+    size_t field;   // source column, 0..4 = open, high, low, close, volume
+    size_t begin;   // storage rows [begin, begin + count) the series covers
+    size_t count;
+
+    bool operator==(const IndicatorKey& other) const;
+};
+
+struct IndicatorKeyHash {
+    size_t operator()(const IndicatorKey& key) const;
+};
+
+struct IndicatorCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t entries = 0;
+    size_t bytes = 0;
+};
+
+/**
+ * @brief IndicatorCache keeps whole indicator series so they are computed once
+ *
+ * One cache hangs off every loaded MarketData (see MarketData::indicator()),
+ * so strategies and sweep tasks over the same bars share e.g. SMA-20 of close
+ * instead of each recomputing it. Series are handed out as shared read-only
+ * vectors: evicting one only drops the cache's reference, a caller still
+ * holding it keeps a valid series.
+ *
+ * Thread safe. Two threads missing on the same key compute it once, the
+ * second one waits for the first. Least recently used series are evicted
+ * once the byte budget is exceeded; a series bigger than the whole budget
+ * is returned but not kept.
+ */
+class IndicatorCache {
+public:
+    using Series = std::shared_ptr<const std::vector<double>>;
+
+    static constexpr size_t kDefaultByteBudget = 256u << 20;
+
+    explicit IndicatorCache(size_t byteBudget = kDefaultByteBudget);
+
+    IndicatorCache(const IndicatorCache&) = delete;
+    IndicatorCache& operator=(const IndicatorCache&) = delete;
+
+    // the cached series for key, calling compute() on a miss
+    Series get(const IndicatorKey& key, const std::function<std::vector<double>()>& compute);
+
+    void setByteBudget(size_t bytes);  // evicts straight away if now over budget
+    size_t byteBudget() const;
+    IndicatorCacheStats stats() const;
+    void clear();
+
+    // out[i] is what the rolling indicator's update() returns after source[i],
+    // so the values are exactly the ones the per-bar strategies see
+    static std::vector<double> compute(IndicatorKind kind, size_t period, const ColumnView<double>& source);
+
+private:
+    struct Entry {
+        std::shared_future<Series> series;
+        size_t bytes;      // 0 while still being computed
+        bool ready;
+        const void* owner;  // the computing call while !ready
+        std::list<IndicatorKey>::iterator recent;
+    };
+
+    mutable std::mutex mutex_;
+    std::unordered_map<IndicatorKey, Entry, IndicatorKeyHash> entries_;
+    std::list<IndicatorKey> recent_;  // most recently used first
+    size_t byteBudget_;
+    size_t bytes_;
+    size_t hits_;
+    size_t misses_;
+    size_t evictions_;
+
+    // caller holds mutex_
+    void evictOverBudget();
+};
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Incremental indicators, O(1) work per bar
+ *
+ * Every indicator keeps its own ring buffer state and is fed one value at
+ * a time with update(), oldest bar first. value() is only meaningful once
+ * ready() is true; before that update() returns 0.0.
+ *
+ * Running sums are updated as sum += (new - old), so after n bars the
+ * result can differ from a fresh window sum by a few ulps times sqrt(n).
+ * Against the window recomputation in the strategies the difference stays
+ * below 1e-9 relative (see the "indicators" group in backtester_bench).
+ */
+
+// RSI arithmetic, shared with the compile-time indicators in static_strategy.h
+// and the RSI kernel in signal_kernels.cpp so all of them give bit-identical values. Same split as the RSI loop in
+// RSIStrategy: a change of 0 counts as a loss of 0
+inline double gainOf(double change) {
+    return change > 0 ? change : 0.0;
+}
+
+inline double lossOf(double change) {
+    return change > 0 ? 0.0 : -change;
+}
+
+inline double rsiFromAverages(double averageGain, double averageLoss) {
+    if (averageLoss == 0) return 100.0;
+    double rs = averageGain / averageLoss;
+    return 100.0 - (100.0 / (1.0 + rs));
+}
+
+// fixed capacity ring of the most recent values. The ring is allocated by the
+// first push, so indicators that are built but never fed (a strategy that
+// only runs analyzeRange from the cache) cost no heap memory
+class RollingWindow {
+public:
+    explicit RollingWindow(size_t capacity);
+
+    // adds x, returns the value that dropped out (0.0 while not yet full)
+    double push(double x);
+    void clear();
+
+    //getters
+    bool full() const;
+    size_t size() const;
+    size_t capacity() const;
+    double newest() const;
+    double oldest() const;
+    double at(size_t position) const;  // 0 = oldest
+
+private:
+    std::vector<double> values_;
+    size_t capacity_;
+    size_t next_;   // slot the next push writes
+    size_t count_;
+};
+
+// simple moving average of the last `period` values
+class RollingSMA {
+public:
+    explicit RollingSMA(size_t period);
+
+    double update(double x);
+    void reset();
+
+    bool ready() const;
+    double value() const;
+    size_t period() const;
+
+private:
+    RollingWindow window_;
+    double sum_;
+};
+
+// exponential moving average, alpha = 2 / (period + 1), seeded with the
+// simple average of the first `period` values
+class EMA {
+public:
+    explicit EMA(size_t period);
+
+    double update(double x);
+    void reset();
+
+    bool ready() const;
+    double value() const;
+    size_t period() const;
+
+private:
+    size_t period_;
+    double alpha_;
+    size_t count_;
+    double value_;
+};
+
+// RSI over the plain average gain/loss of the last `period` price changes
+// (Cutler's RSI). This is what RSIStrategy has always computed
+class RollingRSI {
+public:
+    explicit RollingRSI(size_t period);
+
+    double update(double close);
+    void reset();
+
+    bool ready() const;   // after period + 1 closes
+    double value() const;
+    size_t period() const;
+
+private:
+    RollingWindow changes_;
+    double previousClose_;
+    size_t closes_;
+    double totalGain_;
+    double totalLoss_;
+    size_t gainDays_;     // changes in the window with a gain / a loss, when one
+    size_t lossDays_;     // drops to 0 its total is reset to exactly 0.0
+};
+
+// Wilder's RSI: the first average is a plain mean of `period` changes,
+// after that avg = (avg * (period - 1) + change) / period
+class WilderRSI {
+public:
+    explicit WilderRSI(size_t period);
+
+    double update(double close);
+    void reset();
+
+    bool ready() const;
+    double value() const;
+    size_t period() const;
+
+private:
+    size_t period_;
+    double previousClose_;
+    size_t closes_;
+    double averageGain_;
+    double averageLoss_;
+};
+
+// min / max of the last `period` values, monotonic queue (amortised O(1))
+class RollingExtreme {
+public:
+    RollingExtreme(size_t period, bool keepMax);
+
+    double update(double x);
+    void reset();
+
+    bool ready() const;
+    double value() const;
+    size_t period() const;
+
+private:
+    struct Entry {
+        size_t index;
+        double value;
+    };
+
+    size_t period_;
+    bool keepMax_;
+    size_t seen_;
+    std::vector<Entry> queue_;  // ring of candidates, values monotonic from head
+    size_t head_;
+    size_t count_;
+};
+
+class RollingMin : public RollingExtreme {
+public:
+    explicit RollingMin(size_t period) : RollingExtreme(period, false) {}
+};
+
+class RollingMax : public RollingExtreme {
+public:
+    explicit RollingMax(size_t period) : RollingExtreme(period, true) {}
+};
+
+// population standard deviation of the last `period` values. Sliding
+// Welford update, re-summed from the window every `period` bars so the
+// running mean can't drift (still O(1) amortised)
+class RollingStdDev {
+public:
+    explicit RollingStdDev(size_t period);
+
+    double update(double x);
+    void reset();
+
+    bool ready() const;
+    double value() const;
+    double mean() const;
+    size_t period() const;
+
+private:
+    RollingWindow window_;
+    double mean_;
+    double m2_;  // sum of squared distances from the mean
+    size_t slides_;
+
+    void resync();
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief LatencyHistogram counts nanosecond latencies in log-linear buckets
+ *
+ * HDR-style: values below 256 ns get a bucket each, every power of two
+ * above that is split into 128 linear buckets, so a percentile is off by
+ * less than 1/128 (0.8%) of the value at any magnitude. Values past 2^40 ns
+ * (about 18 minutes) go in the top bucket.
+ *
+ * The counts are one fixed array: record() is a few integer operations and
+ * never allocates, and histograms from several runs or threads can be
+ * add()ed together.
+ */
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    void record(uint64_t nanos);
+    void add(const LatencyHistogram& other);
+    void reset();
+
+    //getters
+    uint64_t count() const;
+    uint64_t min() const;   // 0 when empty
+    uint64_t max() const;
+    double mean() const;
+    // the value `percentile` percent of the records are at or below, the top
+    // of its bucket (never above max()). 50 is the median
+    uint64_t percentile(double percentile) const;
+
+    // "<label>: n=..., mean ..., p50 ..., p99 ..., p99.9 ..., max ..." in us
+    void printSummary(const std::string& label) const;
+
+    static const size_t kSubBucketBits = 8;
+    static const size_t kMaxExponent = 40;
+    static const size_t kBuckets =
+        (size_t(1) << kSubBucketBits) + (kMaxExponent - kSubBucketBits + 1) * (size_t(1) << (kSubBucketBits - 1));
+
+private:
+    uint64_t counts_[kBuckets];
+    uint64_t count_;
+    uint64_t min_;
+    uint64_t max_;
+    double sum_;
+
+    static size_t bucketOf(uint64_t nanos);
+    static uint64_t bucketTop(size_t bucket);
+};
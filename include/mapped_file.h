@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief MappedFile maps a whole file read-only into memory
+ *
+ * Used by the fast loaders so rows can be parsed in place
+ * instead of being copied into a std::string line by line.
+ * The mapping is released when the object goes out of scope.
+ */
+class MappedFile {
+public:
+    MappedFile();
+    explicit MappedFile(const std::string& file);
+    ~MappedFile();
+
+    // move only - the mapping has a single owner
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& file);
+    void close();
+
+    //getters
+    bool isOpen() const;
+    const char* data() const;
+    size_t size() const;
+
+private:
+    const char* data_;  // nullptr for empty files
+    size_t size_;
+    bool open_;
+};
@@ -1,10 +1,14 @@
 #pragma once
 
+#include "column_view.h"
+#include "indicator_cache.h"
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include <string>
 
 struct Bar  {
-    double timestamp; // maybe string or date? 
+    int64_t timestamp; // UTC nanoseconds since 1970-01-01
     double open;
     double high;
     double low;
@@ -12,29 +16,199 @@ struct Bar  {
     double volume; //maybe int/long? for better performance?
 };
 
+/**
+ * @brief LoadStats records how the last load of a MarketData went
+ *
+ * Filled by every loader so the two CSV paths can be compared
+ * on the same file (bytes read, rows kept, rows rejected, wall time).
+ */
+struct LoadStats {
+    size_t bytes = 0;
+    size_t rows = 0;
+    size_t malformedRows = 0;
+    bool reordered = false;          // rows were not oldest-first in the file
+    size_t duplicateTimestamps = 0;  // rows sharing the previous row's timestamp
+    double seconds = 0.0;
+
+    double megabytesPerSecond() const;
+    double rowsPerSecond() const;
+};
+
 /**
  * @brief MarketData class for loading and storing price data
- * 
+ *
  * This class handles:
  * - Loading OHLCV data from CSV files
  * - Storing time series data efficiently
  * - Providing access to historical bars
+ *
+ * Bars are always kept oldest first and timestamps are UTC epoch
+ * nanoseconds, so a time window is found with a binary search and
+ * sliceByTime() returns a view sharing the same bars (no copy).
+ *
+ * Bars are stored either as rows (std::vector<Bar>, the default) or as one
+ * contiguous array per field. Column access works in both layouts; in
+ * Layout::Columns loops that only need close prices read 8 bytes per bar
+ * instead of a whole Bar. Copies share the loaded bars, they are read-only.
  */
 
 class MarketData {
 public:
+    enum class Layout {
+        Rows,     // std::vector<Bar>
+        Columns,  // one array per field, served straight from the binary cache when possible
+    };
+
+    // source columns for indicator()
+    enum class Field {
+        Open,
+        High,
+        Low,
+        Close,
+        Volume,
+    };
+
     //constructors
     MarketData();
-    MarketData(const std::string& file);
-    
-    //getters
+    MarketData(const std::string& file, Layout layout = Layout::Rows);  // picks the fastest loader, see load()
+    explicit MarketData(std::vector<Bar> bars, Layout layout = Layout::Rows);
+
+    //loaders
+    // uses the binary cache next to the CSV when it is still fresh, otherwise
+    // parses the CSV (mapped loader for small files, chunked parallel loader
+    // once the file is large enough for the extra threads to pay off) and
+    // writes a new cache for the next run
+    bool load(const std::string& file);
     bool loadFromFile(const std::string& file);
-    const Bar & getBar(size_t index) const;
+    // memory maps the file and parses fields in place, malformed rows are
+    // counted in getLoadStats() instead of being printed
+    bool loadFromFileMapped(const std::string& file);
+    // splits the mapped file into newline aligned byte ranges, parses them on
+    // the shared ThreadPool and stitches the rows back together in file order.
+    // 0 chunks means one per pool thread
+    bool loadFromFileParallel(const std::string& file, size_t chunks = 0);
+    // reads BarCache::sidecarPath(sourceFile), fails if it is missing or stale
+    bool loadFromCache(const std::string& sourceFile);
+    bool writeCache(const std::string& sourceFile) const;
+
+    //getters - indexes are relative to this view, 0 is the oldest bar
+    Bar getBar(size_t index) const;  // assembled from the columns in Layout::Columns
     size_t size() const;
-    
+    const LoadStats& getLoadStats() const;
+
+    // layout used by the loaders, switching converts bars already loaded
+    Layout getLayout() const;
+    void setLayout(Layout layout);
+
+    // column access, contiguous in Layout::Columns and strided in Layout::Rows
+    ColumnView<int64_t> timestamp() const;
+    ColumnView<double> open() const;
+    ColumnView<double> high() const;
+    ColumnView<double> low() const;
+    ColumnView<double> close() const;
+    ColumnView<double> volume() const;
+
+    // whole indicator series over one column of this view, out[i] is what the
+    // rolling indicator returned after bar i. Computed once and shared by every
+    // copy and slice covering the same bars (see IndicatorCache), thread safe
+    IndicatorCache::Series indicator(IndicatorKind kind, size_t period, Field field = Field::Close) const;
+    // the cache behind indicator(), shared by all views of the loaded bars
+    IndicatorCache& indicatorCache() const;
+
+    // time index - O(log n), nothing is copied
+    size_t lowerBound(int64_t time) const;  // first bar at or after `time`
+    MarketData sliceByTime(int64_t from, int64_t to) const;  // bars in [from, to)
+    MarketData slice(size_t first, size_t count) const;
+
+    // bucket lengths for resample(), in nanoseconds
+    static constexpr int64_t kMinute = 60LL * 1000000000LL;
+    static constexpr int64_t kHour = 60 * kMinute;
+    static constexpr int64_t kDay = 24 * kHour;
+    static constexpr int64_t kWeek = 7 * kDay;
+    // buckets are counted from Monday 1969-12-29 00:00 UTC: hours start on the
+    // hour, days at midnight UTC and weeks on Mondays
+    static constexpr int64_t kResampleOrigin = -3 * kDay;
+
+    // the bars of this view in `interval` long buckets: first open, highest
+    // high, lowest low, last close, summed volume, stamped with the bucket
+    // start. Buckets without bars are left out, the newest may be partial.
+    // Nothing is copied up front: the bucket boundaries are indexed in one
+    // pass and each column is aggregated the first time it is read. Every
+    // copy or slice of the same bars asking for the same interval shares
+    // that work while any of its resampled views is alive. Layout::Columns,
+    // read-only; not for BarWindow views, whose bars change
+    MarketData resample(int64_t interval) const;
+
+    // one CSV data row "timestamp,open,high,low,close,volume" in [begin, end),
+    // without its newline. What every loader (and BarSource) parses rows with
+    static bool parseCsvRow(const char* begin, const char* end, Bar& bar);
+
+    // "2025-09-04" or "2025-09-04 15:30:00" <-> UTC epoch nanoseconds
+    static bool parseTimestamp(const std::string& text, int64_t& nanos);
+    static std::string formatTimestamp(int64_t nanos);
+
 private:
-    std::vector<Bar> bars_;
+    friend class BarWindow;
+    struct Storage;  // rows, owned columns or a mapped cache, see market_data.cpp
+
+    std::shared_ptr<const Storage> storage_;
+    size_t begin_;  // this view covers storage rows [begin_, begin_ + size_)
+    size_t size_;
+    Layout layout_;
     std::string filename_;
+    LoadStats loadStats_;
+
+    bool loadFromCsv(const std::string& file);
+    // sorts freshly parsed rows oldest first and installs them, transposing
+    // them when the layout asks for columns
+    void adoptRows(std::vector<Bar> bars);
+    ColumnView<double> column(size_t field) const;
 
     bool parseLine(const std::string& line, Bar & bar);
+    // parses the rows in [begin, end) into out, returns the number of malformed rows
+    static size_t parseBuffer(const char* begin, const char* end, std::vector<Bar>& out);
+};
+
+/**
+ * @brief BarWindow is a fixed size MarketData that bars are pushed into
+ *
+ * For streaming runs (see BarSource and BacktestEngine::runStreaming()):
+ * view() always covers `capacity` bars in Layout::Columns, push() writes the
+ * next one and returns its index. When the window is full the newest
+ * `lookback - 1` bars are moved to the front and pushing carries on after
+ * them, so analyze(view(), index) can always see `lookback` bars ending at
+ * index. Slots past the last pushed index hold old bars, nothing may read
+ * them.
+ *
+ * Memory is capacity bars no matter how many are pushed. view()'s
+ * IndicatorCache is cleared on every push, so indicator() never hands out
+ * a series of older bars; one it already returned is stale after the push.
+ */
+class BarWindow {
+public:
+    // capacity 0 picks max(kMinCapacity, 8 * lookback)
+    explicit BarWindow(size_t lookback, size_t capacity = 0);
+
+    // returns the bar's index in view()
+    size_t push(const Bar& bar);
+
+    //getters
+    const MarketData& view() const;
+    size_t lookback() const;
+    size_t capacity() const;
+    size_t pushed() const;       // bars pushed since construction
+    size_t compactions() const;  // times the newest bars were moved to the front
+
+    // big enough that strategies rebuilding after a move is a rounding error
+    static constexpr size_t kMinCapacity = 1 << 16;
+
+private:
+    MarketData view_;
+    MarketData::Storage* storage_;  // view_'s storage, written in place
+    int64_t* timestamps_;
+    double* values_[5];             // open, high, low, close, volume
+    size_t lookback_;
+    size_t next_;
+    size_t pushed_;
+    size_t compactions_;
 };
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "market_data.h"
+#include "portfolio.h"
+#include "signal.h"
+#include "thread_pool.h"
+#include "trade_ledger.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**
+ * @brief PathRandom is a counter-based random stream: draw n is a hash of (seed, stream, n)
+ *
+ * Nothing is carried from one draw to the next except the counter, so a
+ * Monte Carlo path seeded with its own index gets the same numbers on any
+ * thread, in any order, with any number of threads. The hash is the
+ * SplitMix64 finaliser.
+ */
+class PathRandom {
+public:
+    PathRandom(uint64_t seed, uint64_t stream) :
+        key_(mix(seed ^ mix(stream + 0x9E3779B97F4A7C15ULL))), counter_(0), spare_(0.0), hasSpare_(false) {
+    }
+
+    uint64_t next() {
+        return mix(key_ + 0x9E3779B97F4A7C15ULL * ++counter_);
+    }
+    // [0, 1) with 53 random bits
+    double uniform() {
+        return static_cast<double>(next() >> 11) * 0x1.0p-53;
+    }
+    // [0, n) for n < 2^32, by multiply-shift instead of a division
+    size_t below(size_t n) {
+        return static_cast<size_t>((next() >> 32) * static_cast<uint64_t>(n) >> 32);
+    }
+    // standard normal, Box-Muller: two draws give two normals, the second is
+    // kept for the next call
+    double normal();
+
+    static uint64_t mix(uint64_t x) {
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+private:
+    uint64_t key_;
+    uint64_t counter_;
+    double spare_;
+    bool hasSpare_;
+};
+
+// low and high bound the middle `confidence` share of the paths
+struct ConfidenceInterval {
+    double low = 0.0;
+    double median = 0.0;
+    double high = 0.0;
+};
+
+struct MonteCarloResult {
+    size_t paths = 0;
+    // false for shuffleTrades(): reordering the trades can't move the final
+    // return, so there is no return interval or rank, and returns is empty
+    bool hasReturns = true;
+    // per path, in path order whatever the thread count
+    std::vector<double> returns;    // percent
+    std::vector<double> drawdowns;  // max drawdown, percent
+
+    // the same measures on the real data (or the real trade order), when
+    // there is one to compare with
+    bool hasActual = false;
+    double actualReturn = 0.0;
+    double actualDrawdown = 0.0;
+
+    double confidence = 0.0;
+    ConfidenceInterval returnInterval;
+    ConfidenceInterval drawdownInterval;
+    // share of paths returning less than the real run: near 1 means few
+    // resampled markets did as well
+    double returnRank = 0.0;
+    // share of paths with a smaller max drawdown than the real run
+    double drawdownRank = 0.0;
+
+    double seconds = 0.0;
+    double pathsPerSecond() const;
+};
+
+// a per-bar drift and volatility of log returns, what gbm() simulates
+struct GBMParams {
+    double start = 0.0;
+    double drift = 0.0;       // mean log return per bar + volatility^2 / 2
+    double volatility = 0.0;  // log return standard deviation per bar
+};
+
+/**
+ * @brief MonteCarlo asks how much of a backtest result is luck
+ *
+ * Three kinds of paths:
+ * - bootstrap(): the close-to-close returns resampled in circular blocks of
+ *   blockBars, which keeps short range structure such as volatility
+ *   clusters, then the strategy traded on the rebuilt series
+ * - gbm(): geometric Brownian motion with the data's drift and volatility
+ * - shuffleTrades(): the realised P&L of every sell in a trade history in a
+ *   random order. The final return can't change, the drawdown can. Its
+ *   actual return is the realised one, an open position isn't counted
+ *
+ * Paths are handed out in batches of setBatchSize() to the ThreadPool.
+ * A batch reuses its thread's close and signal buffers and Portfolio, so
+ * after the first batch on a thread no path allocates. Path i draws from
+ * PathRandom(seed, i) and writes slot i, so a result is the same for a seed
+ * whatever the pool. Strategies are given as a PathStrategy over the raw
+ * close buffer (sma() and rsi() wrap the SignalKernels), not as a Strategy,
+ * which would need a MarketData (and IndicatorCache) per path.
+ */
+class MonteCarlo {
+public:
+    // signals for close[0, count) into out, close[0] being the first bar seen
+    using PathStrategy = std::function<void(const double* close, size_t count, Signal* out)>;
+
+    explicit MonteCarlo(double startingCash = 10000.0, ThreadPool& pool = ThreadPool::shared());
+
+    void setSeed(uint64_t seed);
+    // middle share of the paths the intervals cover, 0.95 by default
+    void setConfidence(double confidence);
+    // paths per task, 64 by default
+    void setBatchSize(size_t paths);
+
+    MonteCarloResult bootstrap(const MarketData& data, const PathStrategy& strategy, size_t paths,
+                               size_t blockBars = 20) const;
+    // paths of `bars` bars from params (see fitGBM())
+    MonteCarloResult gbm(const GBMParams& params, size_t bars, const PathStrategy& strategy, size_t paths) const;
+    MonteCarloResult shuffleTrades(const TradeLedger& trades, double startingCash, size_t paths) const;
+
+    static PathStrategy sma(int shortPeriod, int longPeriod);
+    static PathStrategy rsi(int period, double oversold = 30.0, double overbought = 70.0);
+    // drift and volatility of the data's log close-to-close returns
+    static GBMParams fitGBM(const MarketData& data);
+    // the (1 - confidence) / 2 and (1 + confidence) / 2 quantiles and the median
+    static ConfidenceInterval interval(std::vector<double> values, double confidence);
+
+    // the intervals and the real run as two lines
+    static void printSummary(const char* name, const MonteCarloResult& result);
+
+private:
+    double startingCash_;
+    ThreadPool& pool_;
+    uint64_t seed_;
+    double confidence_;
+    size_t batchSize_;
+
+    // path buffers, one per pool thread plus the caller's, grown by a
+    // thread's first batch and reused by every later path
+    struct Scratch {
+        std::vector<double> close;
+        std::vector<Signal> signals;
+        std::vector<size_t> order;  // shuffleTrades()
+        Portfolio portfolio;
+    };
+    mutable std::vector<Scratch> scratch_;
+
+    // fills every path's close series with `generate`, trades `strategy` on
+    // it and fills in the result
+    MonteCarloResult runPaths(size_t paths, size_t bars, const PathStrategy& strategy,
+                              const std::function<void(PathRandom&, double*)>& generate) const;
+    void finish(MonteCarloResult& result) const;
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "event_sink.h"
+#include "signal.h"
+#include "trade_ledger.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+// one entry of an order batch
+struct Order {
+    uint32_t symbol;    // dense symbol id, see Universe
+    int32_t quantity;   // > 0 buys, < 0 sells, 0 is ignored
+};
+
+/**
+ * @brief MultiAssetPortfolio holds cash and one position per symbol id
+ *
+ * Positions are three flat columns indexed by symbol id: shares, average
+ * price paid and the last price marked. Revaluing the book is one pass over
+ * two contiguous arrays (no per-symbol objects or lookups), which keeps
+ * getTotalValue() in the low microseconds for a few thousand names.
+ *
+ * A bar goes: markPrices() with that bar's closes, then executeOrders() or
+ * executeSignals() for everything that trades on it. Fills are at the last
+ * marked price. With one symbol and executeSignals() it trades exactly like
+ * Portfolio.
+ */
+class MultiAssetPortfolio {
+public:
+    // symbols fixes the ids that can be traded: 0..symbols-1
+    MultiAssetPortfolio(double startingCash, size_t symbols, EventSink* sink = nullptr,
+                        std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    // back to startingCash, flat in every symbol, no trades, prices kept
+    void reset(double startingCash);
+    void setEventSink(EventSink* sink);
+
+    //prices - one per symbol, in id order
+    void markPrices(const double* prices);
+    void markPrice(uint32_t symbol, double price);
+
+    //trading methods
+    // fills every order it can at the last marked price, in order. A buy the
+    // cash can't cover or a sell of more than is held is refused (and
+    // reported), the rest of the batch still runs. Returns the orders filled
+    size_t executeOrders(const Order* orders, size_t count, size_t dayIndex);
+    size_t executeOrders(const std::vector<Order>& orders, size_t dayIndex);
+    // one signal per symbol, Portfolio's rule across the book: every Sell
+    // closes its position first, then the Buys share half the cash equally
+    size_t executeSignals(const Signal* signals, size_t dayIndex);
+
+    //status of portfolio - all at the last marked prices
+    double getCash() const;
+    double getPositionsValue() const;
+    double getTotalValue() const;
+    double getReturn() const;
+    size_t openPositions() const;
+
+    //getters
+    size_t size() const;  // symbols
+    int32_t getShares(uint32_t symbol) const;  // throws std::out_of_range
+    double getAveragePrice(uint32_t symbol) const;
+    double getLastPrice(uint32_t symbol) const;
+    // raw columns, size() entries each
+    const int32_t* shares() const;
+    const Price* averagePrices() const;  // as stored, see price.h
+    const double* lastPrices() const;
+
+    //trade history - tradeSymbols()[i] is the symbol of getTradeHistory()[i]
+    const TradeLedger& getTradeHistory() const;
+    const uint32_t* tradeSymbols() const;
+    void printSummary() const;
+
+private:
+    // whole micro-dollars with BACKTESTER_FIXED_PRICES (see price.h); marked
+    // prices stay double and are rounded when they fill
+    Price cash_;
+    Price startingValue_;
+    EventSink* sink_;
+
+    std::vector<int32_t> shares_;
+    std::vector<Price> averagePrices_;
+    std::vector<double> lastPrices_;
+
+    TradeLedger tradeHistory_;
+    std::pmr::vector<uint32_t> tradeSymbols_;
+
+    // scratch for executeSignals, kept between bars
+    std::vector<uint32_t> buys_;
+
+    Price positionsValue() const;
+    bool buy(uint32_t symbol, int32_t quantity, size_t dayIndex);
+    bool sell(uint32_t symbol, int32_t quantity, size_t dayIndex);
+    void checkSymbol(uint32_t symbol) const;
+};
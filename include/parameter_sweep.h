@@ -0,0 +1,131 @@
+#pragma once
+
+#include "event_sink.h"
+#include "market_data.h"
+#include "performance_tracker.h"
+#include "portfolio.h"
+#include "result_store.h"
+#include "strategy.h"
+#include "thread_pool.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+struct SMAParams {
+    int shortPeriod;
+    int longPeriod;
+};
+
+struct RSIParams {
+    int period;
+    double oversold;
+    double overbought;
+};
+
+// outcome of one grid point, `combination` indexes the grid it came from
+struct SweepResult {
+    size_t combination = 0;
+    double returnPercent = 0.0;
+    size_t trades = 0;
+    double finalValue = 0.0;
+    PerformanceStats performance;
+};
+
+// what ParameterSweep::best() ranks by, higher is better for all of them
+enum class SweepMetric {
+    Return,
+    Sharpe,
+    Sortino,
+    Drawdown,  // smallest max drawdown first
+};
+
+/**
+ * @brief ParameterSweep backtests a grid of strategy parameters in parallel
+ *
+ * Every combination is one task on the (work-stealing) ThreadPool with its
+ * own strategy and Portfolio. All tasks read the same MarketData, nothing
+ * is copied per task: signals come from Strategy::analyzeRange() into a
+ * per-thread buffer, then a Portfolio trades them at the close like the
+ * loop in main.cpp does. Trades are only reported when a sink is set; the
+ * sink sees events from every pool thread at once (AsyncFileSink suits).
+ * A PerformanceTracker follows every bar, so each result carries its
+ * risk metrics without any per-bar series being kept.
+ */
+class ParameterSweep {
+public:
+    using StrategyFactory = std::function<std::unique_ptr<Strategy>(size_t combination)>;
+
+    // data must outlive the sweep
+    ParameterSweep(const MarketData& data, double startingCash = 10000.0,
+                   ThreadPool& pool = ThreadPool::shared());
+
+    std::vector<SweepResult> runSMA(const std::vector<SMAParams>& grid);
+    std::vector<SweepResult> runRSI(const std::vector<RSIParams>& grid);
+    // any strategy: make(i) builds the strategy for combination i
+    std::vector<SweepResult> run(size_t combinations, const StrategyFactory& make);
+
+    // the k best combinations by metric, best first, without keeping the
+    // rest: each thread fills its own bounded heap and they are merged at
+    // the end, so memory is O(k x threads) whatever the grid size. With a
+    // store every result is also appended to it as a StoredResult
+    std::vector<SweepResult> runTopK(size_t combinations, const StrategyFactory& make, size_t k,
+                                     SweepMetric metric = SweepMetric::Return, ResultWriter* store = nullptr);
+    std::vector<SweepResult> runSMATopK(const std::vector<SMAParams>& grid, size_t k,
+                                        SweepMetric metric = SweepMetric::Return, ResultWriter* store = nullptr);
+    std::vector<SweepResult> runRSITopK(const std::vector<RSIParams>& grid, size_t k,
+                                        SweepMetric metric = SweepMetric::Return, ResultWriter* store = nullptr);
+
+    // every (short, long) with short < long, both ranges inclusive
+    static std::vector<SMAParams> smaGrid(int shortMin, int shortMax, int longMin, int longMax, int step = 1);
+    // every period x oversold x overbought with oversold < overbought
+    static std::vector<RSIParams> rsiGrid(const std::vector<int>& periods, const std::vector<double>& oversold,
+                                          const std::vector<double>& overbought);
+    // the `count` best results by metric, best first
+    static std::vector<SweepResult> best(const std::vector<SweepResult>& results, size_t count,
+                                         SweepMetric metric = SweepMetric::Return);
+    static double score(const SweepResult& result, SweepMetric metric);
+    // a ranks above b: higher score, the lower combination index on a tie
+    static bool better(const SweepResult& a, const SweepResult& b, SweepMetric metric);
+    static StoredResult toStored(const SweepResult& result);
+
+    // sink for the trades of every combination, nullptr (the default) reports nothing
+    void setEventSink(EventSink* sink);
+    // on by default; off skips the per-bar tracker (a few ns a bar) and
+    // leaves SweepResult::performance empty
+    void setTrackPerformance(bool enabled);
+
+    //getters - timing of the last run
+    double lastSeconds() const;
+    double combinationsPerSecond() const;
+
+private:
+    const MarketData& data_;
+    double startingCash_;
+    ThreadPool& pool_;
+    size_t lastCombinations_;
+    double lastSeconds_;
+    EventSink* sink_;
+    bool trackPerformance_;
+
+    // one per pool thread plus the caller's (see ThreadPool::workerIndex()),
+    // reused by every combination that thread evaluates: reset() keeps the
+    // trade ledger's block, so once it has grown to the busiest
+    // combination's trade count nothing is allocated
+    struct Scratch {
+        std::vector<Signal> signals;
+        Portfolio portfolio;
+    };
+    mutable std::vector<Scratch> scratch_;
+
+    SweepResult evaluate(Strategy& strategy) const;
+    // run() and runTopK() over evaluateOne(i), which builds combination i's
+    // strategy and evaluates it. runSMA() and friends keep the strategy on
+    // the stack, so a warm sweep allocates nothing per combination
+    template <typename Evaluate>
+    std::vector<SweepResult> runEach(size_t combinations, const Evaluate& evaluateOne);
+    template <typename Evaluate>
+    std::vector<SweepResult> runTopKEach(size_t combinations, const Evaluate& evaluateOne, size_t k,
+                                         SweepMetric metric, ResultWriter* store);
+};
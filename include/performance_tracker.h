@@ -0,0 +1,180 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// what a PerformanceTracker has seen so far. Returns are per bar, simple,
+// with no risk-free rate; Sharpe and Sortino are annualised
+struct PerformanceStats {
+    size_t bars = 0;
+    double startValue = 0.0;
+    double finalValue = 0.0;
+    double totalReturn = 0.0;       // percent
+    double meanReturn = 0.0;        // per bar
+    double volatility = 0.0;        // per bar standard deviation
+    double sharpe = 0.0;
+    double sortino = 0.0;
+    double maxDrawdown = 0.0;       // percent below the running peak
+    size_t maxDrawdownBars = 0;     // longest stretch below a previous peak
+    double exposure = 0.0;          // fraction of bars that ended holding shares
+
+    // round trips: from the bar a position opens to the bar it is flat again
+    size_t roundTrips = 0;
+    size_t wins = 0;
+    size_t losses = 0;
+    double winRate = 0.0;           // wins / roundTrips
+    double averageWin = 0.0;
+    double averageLoss = 0.0;       // positive
+    double profitFactor = 0.0;      // gross wins / gross losses, 0 with no losses
+};
+
+/**
+ * @brief PerformanceTracker turns one equity value per bar into risk metrics
+ *
+ * Everything is a running accumulator: Welford mean and variance of the
+ * bar returns (plus the downside sum for Sortino), the running peak for
+ * drawdown, and the equity at the last entry for win/loss. Memory is O(1)
+ * whatever the number of bars, so a sweep can keep one per thread and rank
+ * every combination without storing any series. The equity curve itself is
+ * only kept after setRecordCurve(true).
+ */
+class PerformanceTracker {
+public:
+    // periodsPerYear annualises Sharpe/Sortino, 252 for daily bars
+    explicit PerformanceTracker(double periodsPerYear = 252.0);
+
+    // once per bar, after that bar's trades: the portfolio value at the
+    // close and whether it holds any shares. Inline below, it runs for
+    // every bar of every combination in a sweep
+    void update(double equity, bool invested);
+    // forgets every bar, keeps the settings (and the curve's memory)
+    void reset();
+
+    void setRecordCurve(bool enabled);
+    const std::vector<double>& equityCurve() const;  // empty unless recorded
+
+    //getters
+    PerformanceStats stats() const;
+    size_t bars() const;
+    double periodsPerYear() const;
+
+    // the stats as a few summary lines
+    void printSummary() const;
+
+private:
+    double periodsPerYear_;
+    bool recordCurve_;
+    std::vector<double> curve_;
+
+    size_t bars_;
+    double startValue_;
+    double lastValue_;
+
+    // Welford over bar returns, bar 0 has none. Bars flat in cash have a
+    // return of exactly 0; a run of them is only counted in flatReturns_
+    // and merged in one step when the run ends (see mergeFlat())
+    size_t returns_;
+    double mean_;
+    double m2_;
+    double downsideSquares_;
+    size_t flatReturns_;
+
+    double peak_;
+    double maxDrawdown_;
+    size_t underwaterBars_;
+    size_t maxUnderwaterBars_;
+
+    size_t investedBars_;
+    bool invested_;
+    double entryValue_;
+    size_t wins_;
+    size_t losses_;
+    double grossWin_;
+    double grossLoss_;
+
+    // Welford's parallel merge of `zeros` returns of 0 into (count, mean, m2)
+    static void mergeFlat(size_t& count, double& mean, double& m2, size_t zeros);
+};
+
+inline void PerformanceTracker::update(double equity, bool invested) {
+    // nothing held and the cash unchanged: only the counters move
+    if (!invested && !invested_ && equity == lastValue_ && bars_ > 0) {
+        flatReturns_++;
+        underwaterBars_ = (underwaterBars_ + 1) * static_cast<size_t>(equity < peak_);
+        maxUnderwaterBars_ = std::max(maxUnderwaterBars_, underwaterBars_);
+        bars_++;
+        if (recordCurve_) {
+            curve_.push_back(equity);
+        }
+        return;
+    }
+    if (flatReturns_ > 0) {
+        mergeFlat(returns_, mean_, m2_, flatReturns_);
+        flatReturns_ = 0;
+    }
+
+    // the rest is written without data dependent branches: while a position
+    // is open the sign of the return and new highs are coin flips
+    if (bars_ == 0) {
+        startValue_ = equity;
+        peak_ = equity;
+    }
+    else {
+        // both divisions are off the mean's dependency chain
+        double r = lastValue_ != 0.0 ? equity / lastValue_ - 1.0 : 0.0;
+        returns_++;
+        double weight = 1.0 / static_cast<double>(returns_);
+        double delta = r - mean_;
+        mean_ += delta * weight;
+        m2_ += delta * (r - mean_);
+        // min(r, 0) as arithmetic, GCC turns the comparison into a branch
+        double down = 0.5 * (r - std::fabs(r));
+        downsideSquares_ += down * down;
+    }
+
+    underwaterBars_ = (underwaterBars_ + 1) * static_cast<size_t>(equity < peak_);
+    maxUnderwaterBars_ = std::max(maxUnderwaterBars_, underwaterBars_);
+    peak_ = std::max(peak_, equity);
+    // divide only when the drawdown is a new maximum, which is rare
+    double fall = peak_ - equity;
+    if (fall > maxDrawdown_ * peak_) {
+        maxDrawdown_ = fall / peak_;
+    }
+
+    // a round trip is closed when the position goes flat again
+    if (invested != invested_) {
+        if (invested) {
+            entryValue_ = equity;
+        }
+        else {
+            double pnl = equity - entryValue_;
+            if (pnl > 0.0) {
+                wins_++;
+                grossWin_ += pnl;
+            }
+            else {
+                losses_++;
+                grossLoss_ -= pnl;
+            }
+        }
+        invested_ = invested;
+    }
+    investedBars_ += invested;
+
+    lastValue_ = equity;
+    bars_++;
+    if (recordCurve_) {
+        curve_.push_back(equity);
+    }
+}
+
+inline void PerformanceTracker::mergeFlat(size_t& count, double& mean, double& m2, size_t zeros) {
+    double n = static_cast<double>(count);
+    double k = static_cast<double>(zeros);
+    double total = n + k;
+    m2 += mean * mean * n * k / total;
+    mean -= mean * k / total;
+    count += zeros;
+}
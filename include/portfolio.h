@@ -1,29 +1,46 @@
 #pragma once
 
 #include "signal.h"
-#include "trade.h"
+#include "trade_ledger.h"
 #include "position.h"
-#include <vector>
+#include "event_sink.h"
 #include <cstddef>
 
 class Portfolio {
     public:
-        Portfolio(double startingCash);
+        // every trade (and refused trade) goes to sink, nullptr reports nothing.
+        // &ConsoleSink::shared() gives the old std::cout lines. The trade ledger
+        // gets its memory from resource
+        Portfolio(double startingCash, EventSink* sink = nullptr,
+                  std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+        // back to startingCash with no shares and no trades. Keeps the sink and
+        // the ledger's memory, so a reused Portfolio doesn't allocate
+        void reset(double startingCash);
+        // room for this many trades up front, so the ledger doesn't grow while
+        // trading (see ReplayDriver::setTradeCapacity())
+        void reserveTrades(size_t trades);
+        void setEventSink(EventSink* sink);
         //trading methods
         void executeSignal(Signal signal, double price, size_t dayIndex);
 
         //status of portfolio
         double getCash() const;
+        Price getFixedCash() const;  // as stored, see price.h
+        int getShares() const;
         double getTotalValue(double currentPrice) const;
         double getReturn(double currentPrice) const;
         
         //trade history
-        const std::vector<Trade>& getTradeHistory() const;
+        const TradeLedger& getTradeHistory() const;
         void printSummary(double currentPrice) const;  // Add portfolio summary
   
     private:
-        double cash_;
+        Price totalValue(double currentPrice) const;
+
+        // whole micro-dollars with BACKTESTER_FIXED_PRICES (see price.h)
+        Price cash_;
         Position position_;
-        std::vector<Trade> tradeHistory_;
-        double startingValue_;
+        TradeLedger tradeHistory_;
+        Price startingValue_;
+        EventSink* sink_;
 };
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "price.h"
+
 /**
  * @brief Position class tracks ownership of shares in a single stock
  * 
@@ -13,13 +15,15 @@ public:
     // Constructor - starts with no shares
     Position();
     
-    // Trading operations
-    void buyShares(int quantity, double price);
-    void sellShares(int quantity, double price);
+    // Trading operations - false (and nothing changes) for a quantity that
+    // can't be traded, the caller decides whether to report it
+    bool buyShares(int quantity, Price price);
+    bool sellShares(int quantity, Price price);
     
     // Getters
     int getShares() const;
     double getAveragePrice() const;
+    Price getFixedAveragePrice() const;  // as stored, see price.h
     bool isEmpty() const;  // true if we own 0 shares
     
     // Market value calculations (require current market price)
@@ -28,8 +32,8 @@ public:
     
 private:
     int shares_;           // Number of shares currently owned
-    double averagePrice_;  // Average price paid per share
+    Price averagePrice_;   // Average price paid per share
     
     // Helper method to recalculate average price when buying more
-    void updateAveragePrice(int newShares, double newPrice);
+    void updateAveragePrice(int newShares, Price newPrice);
 };
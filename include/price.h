@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+// set by the BACKTESTER_FIXED_PRICES CMake option. With 1 cash, fills,
+// average prices and the trade ledger are whole micro-dollars, so P&L is
+// integer arithmetic: exact, and the same on every machine and thread count.
+// Bars and indicators stay double, a price is rounded to Price where it
+// reaches a Portfolio
+#ifndef BACKTESTER_FIXED_PRICES
+#define BACKTESTER_FIXED_PRICES 0
+#endif
+
+#if BACKTESTER_FIXED_PRICES
+// micro-dollars, about +-9.2e12 dollars of range
+using Price = int64_t;
+const int64_t kPriceScale = 1000000;
+
+// to the nearest micro-dollar, halves away from zero like std::llround
+// (without its call, this is on every mark to market)
+inline Price toPrice(double dollars) {
+    double scaled = dollars * kPriceScale;
+    return static_cast<Price>(scaled + (scaled < 0 ? -0.5 : 0.5));
+}
+
+inline double toDollars(Price price) {
+    return static_cast<double>(price) / kPriceScale;
+}
+#else
+using Price = double;
+
+inline Price toPrice(double dollars) {
+    return dollars;
+}
+
+inline double toDollars(Price price) {
+    return price;
+}
+#endif
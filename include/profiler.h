@@ -0,0 +1,240 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// set by the BACKTESTER_PROFILE CMake option. With 0 the BACKTESTER_PROFILE_*
+// macros expand to nothing, no clock read or counter is left in the loops
+#ifndef BACKTESTER_ENABLE_PROFILE
+#define BACKTESTER_ENABLE_PROFILE 0
+#endif
+
+// what the time is spent on. Scopes nest and every stage counts its own
+// scope whole, so Execute includes the Record inside it and Run everything
+enum class ProfileStage : uint8_t {
+    Load,      // a MarketData loader, CSV or cache
+    Analyze,   // Strategy::analyze() / analyzeRange()
+    Execute,   // trading the signals: Portfolio::executeSignal() and the per-bar bookkeeping
+    Record,    // TradeLedger::record()
+    Run,       // one BacktestEngine run or one sweep combination
+};
+
+const size_t kProfileStages = 5;
+
+// one timed scope for the Chrome trace, in Profiler::now() ticks
+struct ProfileEvent {
+    uint64_t begin;
+    uint64_t end;
+    ProfileStage stage;
+};
+
+/**
+ * @brief Profiler keeps per-thread time counters for the backtest stages
+ *
+ * Every thread gets its own counters the first time it enters a scope, so
+ * scopes never share a cache line or take a lock. The clock is rdtsc on x86
+ * (a few ns) and steady_clock elsewhere; ticks are turned into nanoseconds
+ * at export by comparing both clocks since the first scope.
+ *
+ * Work that takes microseconds or more (a load, a run, analyzeRange() or
+ * the trading loop of one sweep combination) is timed whole with a
+ * ProfileScope, which also logs it for the Chrome trace. Per-bar and
+ * per-trade work is only sampled: two clock reads around every analyze()
+ * would cost as much as the call. ProfileLoop times one bar in
+ * sampleInterval() of a bar loop, ProfileSample one call in
+ * sampleInterval() of a function, and the stage's time is scaled up from
+ * the timed ones to every call.
+ *
+ * Counters are plain integers written by their own thread: read them
+ * (totals(), the writers) when no run is in progress.
+ */
+class Profiler {
+public:
+    struct ThreadCounters {
+        // ProfileScope: every call timed
+        uint64_t ticks[kProfileStages] = {};
+        uint64_t calls[kProfileStages] = {};
+        // ProfileLoop / ProfileSample: `sampledTimed` of `sampledCalls` timed
+        uint64_t sampledTicks[kProfileStages] = {};
+        uint64_t sampledTimed[kProfileStages] = {};
+        uint64_t sampledCalls[kProfileStages] = {};
+        uint64_t countdown[kProfileStages] = {};  // calls until ProfileSample times one
+        std::vector<ProfileEvent> events;
+        size_t droppedEvents = 0;
+        size_t thread = 0;                        // registration order
+    };
+
+    // one stage summed over every thread
+    struct StageTotal {
+        uint64_t calls = 0;
+        uint64_t timed = 0;
+        double seconds = 0.0;  // sampled time scaled up to every call
+    };
+
+    static uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    // the calling thread's counters, registered on first use
+    static ThreadCounters& local() {
+        static thread_local ThreadCounters* counters = nullptr;
+        if (counters == nullptr) {
+            counters = registerThread();
+        }
+        return *counters;
+    }
+
+    // one bar or call in `calls` is timed, rounded up to a power of two; 64
+    // by default, 1 times all of them
+    static void setSampleInterval(uint64_t calls);
+    static uint64_t sampleInterval();
+    // trace events kept per thread, later ones are only counted
+    static const size_t kMaxEvents = 1 << 20;
+
+    static std::vector<StageTotal> totals();
+    static double nanosecondsPerTick();
+    // zeroes every thread's counters and events
+    static void reset();
+
+    // {"threads": [...], "totals": {...}} with calls, timed calls and ms per stage
+    static bool writeJson(const std::string& file);
+    // Chrome trace-event format (chrome://tracing, Perfetto): one complete
+    // event per ProfileScope and each thread's stage totals as counters
+    static bool writeChromeTrace(const std::string& file);
+    // both writers again when the process exits. Does nothing (and returns
+    // false) when profiling is compiled out
+    static bool writeAtExit(const std::string& jsonFile, const std::string& traceFile);
+    static void printSummary();
+
+    static const char* stageName(ProfileStage stage);
+
+private:
+    static ThreadCounters* registerThread();
+};
+
+// times the enclosing block, every call (see Profiler)
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfileStage stage) :
+        counters_(Profiler::local()), stage_(static_cast<size_t>(stage)), begin_(Profiler::now()) {
+    }
+    ~ProfileScope() {
+        uint64_t end = Profiler::now();
+        counters_.ticks[stage_] += end - begin_;
+        counters_.calls[stage_]++;
+        if (counters_.events.size() < Profiler::kMaxEvents) {
+            counters_.events.push_back({begin_, end, static_cast<ProfileStage>(stage_)});
+        }
+        else {
+            counters_.droppedEvents++;
+        }
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    Profiler::ThreadCounters& counters_;
+    size_t stage_;
+    uint64_t begin_;
+};
+
+// counts the enclosing block, times one call in Profiler::sampleInterval()
+class ProfileSample {
+public:
+    explicit ProfileSample(ProfileStage stage) :
+        counters_(Profiler::local()), stage_(static_cast<size_t>(stage)), begin_(0) {
+        counters_.sampledCalls[stage_]++;
+        if (counters_.countdown[stage_] == 0) {
+            counters_.countdown[stage_] = Profiler::sampleInterval() - 1;
+            begin_ = Profiler::now();
+        }
+        else {
+            counters_.countdown[stage_]--;
+        }
+    }
+    ~ProfileSample() {
+        if (begin_ != 0) {
+            counters_.sampledTicks[stage_] += Profiler::now() - begin_;
+            counters_.sampledTimed[stage_]++;
+        }
+    }
+
+    ProfileSample(const ProfileSample&) = delete;
+    ProfileSample& operator=(const ProfileSample&) = delete;
+
+private:
+    Profiler::ThreadCounters& counters_;
+    size_t stage_;
+    uint64_t begin_;  // 0 when this call isn't timed
+};
+
+// sampling for a bar loop: sampled(i) picks the bars to time, the loop
+// times them and passes the ticks to add(). Every `callsPerBar` calls of the
+// stages given to add() are counted once the loop is done. Compiled out it
+// is empty and sampled() is always false, so the timed branch goes away
+class ProfileLoop {
+public:
+#if BACKTESTER_ENABLE_PROFILE
+    explicit ProfileLoop(size_t callsPerBar) :
+        counters_(Profiler::local()), mask_(Profiler::sampleInterval() - 1), callsPerBar_(callsPerBar), bars_(0),
+        added_{} {
+    }
+    ~ProfileLoop() {
+        for (size_t s = 0; s < kProfileStages; s++) {
+            if (added_[s]) {
+                counters_.sampledCalls[s] += bars_ * callsPerBar_;
+            }
+        }
+    }
+
+    bool sampled(size_t bar) {
+        bars_++;
+        return (bar & mask_) == 0;
+    }
+    void add(ProfileStage stage, uint64_t ticks) {
+        size_t s = static_cast<size_t>(stage);
+        counters_.sampledTicks[s] += ticks;
+        counters_.sampledTimed[s]++;
+        added_[s] = true;
+    }
+
+private:
+    Profiler::ThreadCounters& counters_;
+    uint64_t mask_;
+    size_t callsPerBar_;
+    size_t bars_;
+    bool added_[kProfileStages];
+#else
+    explicit ProfileLoop(size_t) {
+    }
+    bool sampled(size_t) {
+        return false;
+    }
+    void add(ProfileStage, uint64_t) {
+    }
+#endif
+
+    ProfileLoop(const ProfileLoop&) = delete;
+    ProfileLoop& operator=(const ProfileLoop&) = delete;
+};
+
+#define BACKTESTER_PROFILE_CONCAT2(a, b) a##b
+#define BACKTESTER_PROFILE_CONCAT(a, b) BACKTESTER_PROFILE_CONCAT2(a, b)
+#if BACKTESTER_ENABLE_PROFILE
+#define BACKTESTER_PROFILE_SCOPE(stage) ProfileScope BACKTESTER_PROFILE_CONCAT(profileScope_, __LINE__)(stage)
+#define BACKTESTER_PROFILE_SAMPLE(stage) ProfileSample BACKTESTER_PROFILE_CONCAT(profileSample_, __LINE__)(stage)
+#else
+#define BACKTESTER_PROFILE_SCOPE(stage) ((void)0)
+#define BACKTESTER_PROFILE_SAMPLE(stage) ((void)0)
+#endif
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "backtest_engine.h"
+#include "bar_source.h"
+#include "bar_stream.h"
+#include "latency_histogram.h"
+#include "portfolio.h"
+#include "strategy.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief ReplayDriver feeds bars one at a time to strategies, the way a
+ * paper-trading process gets them
+ *
+ * Bars come from a BarSource (a CSV or cache file) or a BarStream (a pipe,
+ * FIFO, Unix socket or stdin). Each one goes to every registered strategy
+ * through Strategy::onBar(), and a Buy/Sell straight to that strategy's
+ * Portfolio, before the next bar is read.
+ *
+ * With setSpeed() the bars are held back to the gaps between their
+ * timestamps (1 = recorded pace, 60 = a minute of bars per second);
+ * 0, the default, takes them as fast as they come.
+ *
+ * latency() holds every bar's tick-to-signal time: from the bar being in
+ * hand (parsed, and released by the pacing) until every strategy has
+ * decided and traded it. Nothing on that path allocates once the
+ * strategies are warm and the ledgers have room (setTradeCapacity()).
+ */
+class ReplayDriver {
+public:
+    ReplayDriver();
+
+    // returns the slot index used by the getters below
+    size_t addStrategy(const std::string& name, std::unique_ptr<Strategy> strategy, Portfolio portfolio);
+
+    // replay speed against the bar timestamps, 0 for as fast as possible
+    void setSpeed(double speed);
+    // ledger room reserved in every portfolio before a run, 0 (the default)
+    // lets ledgers grow as they trade
+    void setTradeCapacity(size_t trades);
+
+    // every bar left in the source, oldest first. Strategies start over
+    // (resetBars()), portfolios keep trading from where they are and the
+    // statistics and latencies are reset. Returns the bars replayed
+    size_t run(BarSource& source);
+    size_t run(BarStream& stream);
+
+    // bars, run time and the latency percentiles of the last run
+    void printSummary() const;
+
+    //getters
+    size_t size() const;
+    const std::string& getName(size_t slot) const;
+    Strategy& getStrategy(size_t slot);
+    const Portfolio& getPortfolio(size_t slot) const;
+    const StrategyStats& getStats(size_t slot) const;
+    double getReturn(size_t slot) const;  // at the last close
+    const LatencyHistogram& latency() const;
+    size_t barsReplayed() const;          // by the last run
+    size_t lateBars() const;              // paced runs: bars that arrived after their time
+    double lastRunSeconds() const;
+
+private:
+    struct Slot {
+        std::string name;
+        std::unique_ptr<Strategy> strategy;
+        Portfolio portfolio;
+        StrategyStats stats;
+        Signal lastSignal;
+    };
+
+    std::vector<Slot> slots_;
+    double speed_;
+    size_t tradeCapacity_;
+    LatencyHistogram latency_;
+    size_t bars_;
+    size_t lateBars_;
+    double lastClose_;
+    double lastRunSeconds_;
+
+    // next(Bar&) is all run() needs from either source
+    template <typename Source>
+    size_t replay(Source& source);
+};
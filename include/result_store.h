@@ -0,0 +1,90 @@
+#pragma once
+
+#include "mapped_file.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// one sweep result on disk, fixed width so record i is at a computable offset
+struct StoredResult {
+    uint64_t combination;
+    uint64_t trades;
+    double returnPercent;
+    double finalValue;
+    double sharpe;
+    double sortino;
+    double maxDrawdown;  // percent
+    double exposure;     // fraction of bars
+};
+static_assert(sizeof(StoredResult) == 64, "StoredResult is one 64 byte record");
+
+/**
+ * @brief ResultWriter appends StoredResults to a results file
+ *
+ * Layout (native endian): a 64 byte header (magic, version, record size)
+ * followed by the records back to back. There is no count in the header,
+ * the file size is the count, so appending never rewrites anything and
+ * several runs can add to the same file. append() is thread safe; callers
+ * on hot paths should hand it blocks of records, not one at a time.
+ */
+class ResultWriter {
+public:
+    ResultWriter();
+    ~ResultWriter();
+
+    ResultWriter(const ResultWriter&) = delete;
+    ResultWriter& operator=(const ResultWriter&) = delete;
+
+    // append false starts the file over. Fails on an existing file that
+    // isn't a results file of this version. Appending first cuts off a
+    // partial record left at the end
+    bool open(const std::string& file, bool append = false);
+    void close();
+
+    bool append(const StoredResult* records, size_t count);
+    void flush();
+
+    //getters
+    bool isOpen() const;
+    size_t written() const;  // records appended since open()
+
+private:
+    std::FILE* out_;
+    size_t written_;
+    std::mutex mutex_;
+};
+
+/**
+ * @brief ResultStore maps a results file read-only for filtering afterwards
+ *
+ * Records are used in place from the mapping: scanning a few million of
+ * them is a linear pass over memory with nothing parsed or copied. A
+ * partial record at the end (a writer that died mid-append) is ignored.
+ */
+class ResultStore {
+public:
+    ResultStore();
+    explicit ResultStore(const std::string& file);
+
+    bool open(const std::string& file);
+    void close();
+
+    // every record keep() accepts, in file order
+    std::vector<StoredResult> filter(const std::function<bool(const StoredResult&)>& keep) const;
+
+    //getters
+    bool isOpen() const;
+    size_t size() const;
+    const StoredResult& operator[](size_t index) const;  // throws std::out_of_range
+    const StoredResult* begin() const;
+    const StoredResult* end() const;
+
+private:
+    MappedFile file_;
+    const StoredResult* records_;
+    size_t size_;
+};
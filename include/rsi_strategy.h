@@ -1,18 +1,45 @@
 #pragma once
 #include "strategy.h"
+#include "indicators.h"
 
 class RSIStrategy : public Strategy {
 
     public:
-    RSIStrategy(int rsi_period);
+    // RSI below `oversold` buys, above `overbought` sells
+    RSIStrategy(int rsi_period, double oversold = 30.0, double overbought = 70.0);
 
+    // O(1) when called for consecutive bars of the same data, any other
+    // index rebuilds the RSI from the last rsi_period + 1 bars
     Signal analyze(const MarketData& data, size_t index) override;
 
+    // SIMD kernel (see SignalKernels), same signals as analyze() bar by bar.
+    // The RSI series comes from data.indicator() unless the cache is turned off
+    void analyzeRange(const MarketData& data, size_t first, size_t last, Signal* out) override;
+    void setIndicatorCache(bool enabled);
+
+    // O(1), straight into the running RSI. Mixing it with analyze() starts
+    // whichever is called over from scratch
+    Signal onBar(const Bar& bar) override;
+    void resetBars() override;
+
+    // rsi_period changes need rsi_period + 1 closes
+    size_t lookback() const override;
+
+    // recomputes the window, O(period) per call. Kept as the reference
+    // the incremental RSI is checked against
+    static double calculateRSI(const MarketData& data, size_t index, int period);
+
     private:
         
     int rsi_period_;    
+    double oversold_;
+    double overbought_;
 
-    double calculateRSI(const MarketData& data, size_t index, int period);
-
+    RollingRSI rsi_;
+    const void* series_;  // close column the RSI was built from
+    size_t nextIndex_;    // next bar the RSI hasn't seen yet
+    bool useCache_;
 
+    void advanceTo(const ColumnView<double>& close, size_t index);
+    Signal signal() const;  // from the current RSI
 };
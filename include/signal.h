@@ -1,6 +1,9 @@
 #pragma once
 
-enum class Signal {
+#include <cstdint>
+
+// one byte so a whole series of signals packs into a compact column
+enum class Signal : int8_t {
     Buy,
     Hold,
     Sell,
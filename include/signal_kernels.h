@@ -0,0 +1,48 @@
+#pragma once
+
+#include "signal.h"
+#include <cstddef>
+
+/**
+ * @brief Whole-series signal kernels behind Strategy::analyzeRange()
+ *
+ * Each kernel treats close[0] as the first bar the strategy ever saw and
+ * writes the signals for bars [first, count) to out[0 .. count - first).
+ * The element-wise work (differences, the gain/loss split, averages and
+ * threshold comparisons) runs in SIMD registers; the running sums are
+ * accumulated in plain scalar order, the same additions the incremental
+ * indicators do, so the signals match the per-bar path exactly.
+ *
+ * The instruction set is picked at runtime from what the CPU supports
+ * (AVX-512, AVX2, SSE2, or a scalar fallback elsewhere).
+ */
+class SignalKernels {
+public:
+    enum class Level {
+        Scalar,
+        SSE2,
+        AVX2,
+        AVX512,
+    };
+
+    // best level this CPU (and build) can run
+    static Level supportedLevel();
+    // level the kernels currently use, supportedLevel() unless overridden
+    static Level activeLevel();
+    // forces a lower level (for benchmarks), clamped to supportedLevel()
+    static void setLevel(Level level);
+    static const char* levelName(Level level);
+
+    // same rules as SMACrossoverStrategy::analyze()
+    static void smaCrossover(const double* close, size_t count, size_t shortPeriod, size_t longPeriod,
+                             size_t first, Signal* out);
+    // same rules as RSIStrategy::analyze(): RSI below `oversold` buys, above `overbought` sells
+    static void rsiThreshold(const double* close, size_t count, size_t period,
+                             double oversold, double overbought, size_t first, Signal* out);
+
+    // the comparison step alone, for series that already exist (e.g. from the
+    // IndicatorCache). Averages of 0.0 mean "not ready" and give Hold
+    static void crossover(const double* shortMA, const double* longMA, size_t count, Signal* out);
+    // value below `low` buys, above `high` sells
+    static void thresholds(const double* values, size_t count, double low, double high, Signal* out);
+};
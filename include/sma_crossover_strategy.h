@@ -1,17 +1,45 @@
 #pragma once
 
 #include "strategy.h"
+#include "indicators.h"
 
 class SMACrossoverStrategy: public Strategy {
     public:
         SMACrossoverStrategy(int short_period, int long_period);
 
         //main method - Decides buy/sell/hold. Index == period of time chosen
+        // O(1) when called for consecutive bars of the same data, any other
+        // index rebuilds the averages from the last long_period bars
         Signal analyze(const MarketData& data, size_t index) override;
+
+        // SIMD kernel (see SignalKernels), same signals as analyze() bar by bar.
+        // Both averages come from data.indicator() unless the cache is turned off
+        void analyzeRange(const MarketData& data, size_t first, size_t last, Signal* out) override;
+        void setIndicatorCache(bool enabled);
+
+        // O(1), straight into the running averages. Mixing it with analyze()
+        // starts whichever is called over from scratch
+        Signal onBar(const Bar& bar) override;
+        void resetBars() override;
+
+        // the longer of the two periods
+        size_t lookback() const override;
+
+        // recomputes the window, O(period) per call. Kept as the reference
+        // the incremental averages are checked against
+        static double calculateMA(const MarketData& data, size_t index, int period);
+
     private:
         int short_period_;
         int long_period_;
 
+        RollingSMA shortMA_;
+        RollingSMA longMA_;
+        const void* series_;  // close column the averages were built from
+        size_t nextIndex_;    // next bar the averages haven't seen yet
+        bool useCache_;
+
         //helper
-        double calculateMA(const MarketData& data, size_t index, int period);
-};
\ No newline at end of file
+        void advanceTo(const ColumnView<double>& close, size_t index);
+        Signal signal() const;  // from the current averages
+};
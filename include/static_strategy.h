@@ -0,0 +1,329 @@
+#pragma once
+
+#include "indicators.h"
+#include "market_data.h"
+#include "portfolio.h"
+#include "signal.h"
+#include "strategy.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+/**
+ * @brief Compile-time strategies: indicators and a rule fused into one inline step
+ *
+ * A static strategy is ComposedStrategy<Rule, Indicators...>. Every close
+ * goes through each indicator's update(), then Rule::decide(indicators...)
+ * turns them into a Signal. Periods and thresholds are template parameters,
+ * nothing is virtual and nothing is heap allocated, so the compiler sees the
+ * whole per-bar step and inlines it into the caller's loop (see
+ * backtestStatic()).
+ *
+ * The indicators repeat the arithmetic of their rolling counterparts in
+ * indicators.h operation for operation, so a static strategy returns the
+ * same signals as the virtual one it mirrors:
+ *
+ *     StaticSMACrossover<3, 5>          == SMACrossoverStrategy(3, 5)
+ *     StaticRSIStrategy<14>             == RSIStrategy(14)
+ *     StaticRSIStrategy<14, Levels<25, 75>> == RSIStrategy(14, 25, 75)
+ *
+ * StaticStrategyAdapter<S> wraps one as a Strategy, so the engine, the
+ * sweep and everything else written against the virtual interface keeps
+ * working with it.
+ */
+
+// ---------------- indicators ----------------
+
+// RollingWindow with the capacity in the type, lives inline
+template <size_t Capacity>
+class StaticWindow {
+    static_assert(Capacity > 0, "window needs at least one slot");
+
+public:
+    // adds x, returns the value that dropped out (0.0 while not yet full)
+    double push(double x) {
+        double dropped = full() ? values_[next_] : 0.0;
+        values_[next_] = x;
+        next_ = next_ + 1 == Capacity ? 0 : next_ + 1;
+        if (count_ < Capacity) {
+            count_++;
+        }
+        return dropped;
+    }
+
+    void clear() {
+        next_ = 0;
+        count_ = 0;
+    }
+
+    bool full() const {
+        return count_ == Capacity;
+    }
+
+private:
+    std::array<double, Capacity> values_{};
+    size_t next_ = 0;
+    size_t count_ = 0;
+};
+
+// RollingSMA
+template <size_t Period>
+class StaticSMA {
+public:
+    // bars update() needs before ready()
+    static constexpr size_t warmup = Period;
+
+    void update(double x) {
+        double dropped = window_.push(x);
+        sum_ += x - dropped;
+    }
+
+    void reset() {
+        window_.clear();
+        sum_ = 0.0;
+    }
+
+    bool ready() const {
+        return window_.full();
+    }
+
+    double value() const {
+        return sum_ / Period;
+    }
+
+private:
+    StaticWindow<Period> window_;
+    double sum_ = 0.0;
+};
+
+// RollingRSI (Cutler's RSI over the last Period changes)
+template <size_t Period>
+class StaticRSI {
+public:
+    static constexpr size_t warmup = Period + 1;
+
+    void update(double close) {
+        closes_++;
+        if (closes_ == 1) {
+            previousClose_ = close;
+            return;
+        }
+
+        double change = close - previousClose_;
+        previousClose_ = close;
+
+        double dropped = changes_.push(change);
+        totalGain_ += gainOf(change) - gainOf(dropped);
+        totalLoss_ += lossOf(change) - lossOf(dropped);
+        gainDays_ += (gainOf(change) > 0) - (gainOf(dropped) > 0);
+        lossDays_ += (lossOf(change) > 0) - (lossOf(dropped) > 0);
+
+        if (gainDays_ == 0) totalGain_ = 0.0;
+        if (lossDays_ == 0) totalLoss_ = 0.0;
+    }
+
+    void reset() {
+        changes_.clear();
+        previousClose_ = 0.0;
+        closes_ = 0;
+        totalGain_ = 0.0;
+        totalLoss_ = 0.0;
+        gainDays_ = 0;
+        lossDays_ = 0;
+    }
+
+    bool ready() const {
+        return closes_ > Period;
+    }
+
+    double value() const {
+        double period = static_cast<double>(Period);
+        return rsiFromAverages(totalGain_ / period, totalLoss_ / period);
+    }
+
+private:
+    StaticWindow<Period> changes_;
+    double previousClose_ = 0.0;
+    size_t closes_ = 0;
+    double totalGain_ = 0.0;
+    double totalLoss_ = 0.0;
+    size_t gainDays_ = 0;
+    size_t lossDays_ = 0;
+};
+
+// ---------------- rules ----------------
+
+// buy while the fast average is above the slow one, sell while below.
+// Hold until both are ready (or either is exactly 0), like SMACrossoverStrategy
+struct CrossoverRule {
+    template <typename Fast, typename Slow>
+    static Signal decide(const Fast& fast, const Slow& slow) {
+        double fastValue = fast.ready() ? fast.value() : 0.0;
+        double slowValue = slow.ready() ? slow.value() : 0.0;
+        if (fastValue == 0.0 || slowValue == 0.0) return Signal::Hold;
+        if (fastValue > slowValue) return Signal::Buy;
+        if (fastValue < slowValue) return Signal::Sell;
+        return Signal::Hold;
+    }
+};
+
+// C++17 has no double template parameters: whole-number levels go in here,
+// any other struct with constexpr `low` and `high` works too
+template <int Low, int High>
+struct Levels {
+    static constexpr double low = Low;
+    static constexpr double high = High;
+};
+
+// buy below Thresholds::low, sell above Thresholds::high. The value counts
+// as 50 until the indicator is ready, like RSIStrategy
+template <typename Thresholds>
+struct ThresholdRule {
+    template <typename Indicator>
+    static Signal decide(const Indicator& indicator) {
+        double value = indicator.ready() ? indicator.value() : 50.0;
+        if (value < Thresholds::low) return Signal::Buy;
+        if (value > Thresholds::high) return Signal::Sell;
+        return Signal::Hold;
+    }
+};
+
+// ---------------- composition ----------------
+
+// CRTP base: the loops every static strategy gets from its step()
+template <typename Derived>
+class StaticStrategy {
+public:
+    // signals for every close in [close, close + count), fed oldest first
+    // into the current state
+    void run(const double* close, size_t count, Signal* out) {
+        Derived& self = static_cast<Derived&>(*this);
+        for (size_t i = 0; i < count; i++) {
+            out[i] = self.step(close[i]);
+        }
+    }
+
+    // same contract as Strategy::analyzeRange: out[i - first] is what
+    // analyze(data, i) returns, rebuilt from the bars the warmup needs
+    void analyzeRange(const MarketData& data, size_t first, size_t last, Signal* out) {
+        if (first > last || last > data.size()) {
+            throw std::out_of_range("range out of range");
+        }
+        Derived& self = static_cast<Derived&>(*this);
+        size_t start = first + 1 >= Derived::warmup ? first + 1 - Derived::warmup : 0;
+        ColumnView<double> close = data.close();
+        self.reset();
+        for (size_t i = start; i < first; i++) {
+            self.step(close[i]);
+        }
+        for (size_t i = first; i < last; i++) {
+            out[i - first] = self.step(close[i]);
+        }
+    }
+};
+
+template <typename Rule, typename... Indicators>
+class ComposedStrategy : public StaticStrategy<ComposedStrategy<Rule, Indicators...>> {
+public:
+    // bars before every indicator is ready
+    static constexpr size_t warmup = std::max({size_t(1), Indicators::warmup...});
+
+    // feeds one close to every indicator, returns the signal for that bar
+    Signal step(double close) {
+        std::apply([close](Indicators&... indicator) { (indicator.update(close), ...); }, indicators_);
+        return std::apply([](const Indicators&... indicator) { return Rule::decide(indicator...); }, indicators_);
+    }
+
+    void reset() {
+        std::apply([](Indicators&... indicator) { (indicator.reset(), ...); }, indicators_);
+    }
+
+private:
+    std::tuple<Indicators...> indicators_;
+};
+
+template <size_t Short, size_t Long>
+using StaticSMACrossover = ComposedStrategy<CrossoverRule, StaticSMA<Short>, StaticSMA<Long>>;
+
+template <size_t Period, typename Thresholds = Levels<30, 70>>
+using StaticRSIStrategy = ComposedStrategy<ThresholdRule<Thresholds>, StaticRSI<Period>>;
+
+// ---------------- glue ----------------
+
+// a static strategy behind the virtual interface. analyze() is O(1) for
+// consecutive bars of the same data and onBar() always, like the hand
+// written strategies
+template <typename Static>
+class StaticStrategyAdapter : public Strategy {
+public:
+    Signal analyze(const MarketData& data, size_t index) override {
+        if (index >= data.size()) {
+            throw std::out_of_range("index out of range");
+        }
+        ColumnView<double> close = data.close();
+        bool sameSeries = close.data() == series_;
+        if (sameSeries && index + 1 == nextIndex_) {
+            return last_;
+        }
+        if (!sameSeries || index != nextIndex_) {
+            strategy_.reset();
+            series_ = close.data();
+            nextIndex_ = index + 1 >= Static::warmup ? index + 1 - Static::warmup : 0;
+        }
+        for (; nextIndex_ <= index; nextIndex_++) {
+            last_ = strategy_.step(close[nextIndex_]);
+        }
+        return last_;
+    }
+
+    void analyzeRange(const MarketData& data, size_t first, size_t last, Signal* out) override {
+        Static fresh;
+        fresh.analyzeRange(data, first, last, out);
+    }
+
+    size_t lookback() const override {
+        return Static::warmup;
+    }
+
+    Signal onBar(const Bar& bar) override {
+        if (series_ != nullptr) {
+            resetBars();  // the state was built by analyze()
+        }
+        last_ = strategy_.step(bar.close);
+        return last_;
+    }
+
+    void resetBars() override {
+        strategy_.reset();
+        series_ = nullptr;
+        nextIndex_ = 0;
+        last_ = Signal::Hold;
+    }
+
+private:
+    Static strategy_;
+    const void* series_ = nullptr;
+    size_t nextIndex_ = 0;
+    Signal last_ = Signal::Hold;
+};
+
+// one pass over every bar, signal and trade fused in the same loop. Hold
+// bars don't reach the portfolio, same as BacktestEngine. Returns the
+// portfolio's final return
+template <typename Static>
+double backtestStatic(Static& strategy, const MarketData& data, Portfolio& portfolio) {
+    ColumnView<double> close = data.close();
+    size_t bars = data.size();
+    strategy.reset();
+    for (size_t i = 0; i < bars; i++) {
+        double price = close[i];
+        Signal signal = strategy.step(price);
+        if (signal != Signal::Hold) {
+            portfolio.executeSignal(signal, price, i);
+        }
+    }
+    return bars > 0 ? portfolio.getReturn(close[bars - 1]) : 0.0;
+}
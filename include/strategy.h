@@ -2,12 +2,40 @@
 
 #include "signal.h"
 #include "market_data.h"
+#include <memory>
+#include <vector>
 
 class Strategy {
     public:
         //main method - Decides buy/sell/hold. Index == period of time chosen
         virtual Signal analyze(const MarketData& data, size_t index) = 0;
 
+        // signals for bars [first, last) in one call: out[i - first] is what a
+        // fresh strategy returns from analyze(data, i) for i = first, first + 1, ...
+        // The default loops over analyze(), strategies with a vectorised kernel
+        // override it
+        virtual void analyzeRange(const MarketData& data, size_t first, size_t last, Signal* out);
+
+        // whole series at once, one byte per bar
+        std::vector<Signal> analyzeAll(const MarketData& data);
+
+        // bars analyze(data, i) reads, ending at bar i. Streaming runs keep
+        // only this many bars in memory (see BacktestEngine::runStreaming()).
+        // 0, the default, means undeclared: such a strategy can't be streamed
+        virtual size_t lookback() const;
+
+        // incremental form of analyze() for bars that arrive one at a time (see
+        // ReplayDriver): the signal for `bar` after every bar passed since the
+        // last resetBars(), the same as analyze() on those bars. The default
+        // keeps a BarWindow of lookback() bars and calls analyze() on it, so
+        // it throws std::logic_error for a strategy without a lookback().
+        // Strategies with running indicators override both
+        virtual Signal onBar(const Bar& bar);
+        // forgets the bars onBar() has seen
+        virtual void resetBars();
+
         virtual ~Strategy() = default;
 
-};
\ No newline at end of file
+    private:
+        std::unique_ptr<BarWindow> bars_;  // default onBar() only, made by the first call
+};
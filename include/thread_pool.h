@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief ThreadPool runs submitted tasks on a fixed set of worker threads
+ *
+ * Tasks are plain std::function<void()>. wait() blocks until every task
+ * submitted so far has finished and rethrows the first exception a task threw.
+ * parallelFor() splits an index range over the workers and only waits for
+ * its own work, so it is safe to call from inside another task.
+ *
+ * Work stealing: every worker owns a deque. Tasks submitted from a worker go
+ * to the back of its own deque and it runs newest first; a worker with an
+ * empty deque steals the oldest task from another one. Tasks submitted from
+ * outside the pool are dealt round robin, so there is no single shared queue
+ * for all threads to fight over.
+ */
+class ThreadPool {
+public:
+    // 0 threads means one per hardware thread
+    explicit ThreadPool(size_t threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> task);
+    void wait();
+
+    // runs body(i) for every i in [0, count), the calling thread helps out
+    void parallelFor(size_t count, const std::function<void(size_t)>& body);
+
+    size_t size() const;
+    // the calling thread's worker number in [0, size()), or size() for a
+    // thread outside this pool. Lets parallelFor bodies keep per-thread state
+    // in a vector of size() + 1 (the last entry is the caller's)
+    size_t workerIndex() const;
+
+    // process wide pool shared by the loaders so they don't spawn threads per file
+    static ThreadPool& shared();
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;  // one per worker
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> nextQueue_;  // round robin for submits from outside the pool
+    std::atomic<size_t> queued_;     // tasks sitting in any deque
+
+    std::mutex sleepMutex_;          // idle workers wait here
+    std::condition_variable taskReady_;
+    bool stopping_;
+
+    std::mutex doneMutex_;
+    std::condition_variable allDone_;
+    size_t pending_;      // submitted but not finished
+    std::exception_ptr firstError_;
+
+    void workerLoop(size_t index);
+    // own deque newest first, then the oldest task of any other worker
+    bool takeTask(size_t index, std::function<void()>& task);
+};
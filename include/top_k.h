@@ -0,0 +1,76 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief TopK keeps the k best values pushed into it, in O(k) memory
+ *
+ * A binary heap with the worst kept value on top: a push that doesn't beat
+ * it is one comparison, one that does replaces it in O(log k). Better(a, b)
+ * is true when a ranks above b and must be a strict weak order; give it a
+ * tie-breaker if the result has to be the same whatever the push order
+ * (e.g. several threads filling their own TopK and merging them).
+ */
+template <typename T, typename Better>
+class TopK {
+public:
+    explicit TopK(size_t k = 0, Better better = Better()) : k_(k), better_(std::move(better)) {
+        heap_.reserve(k);
+    }
+
+    void push(const T& value) {
+        if (k_ == 0) {
+            return;
+        }
+        if (heap_.size() < k_) {
+            heap_.push_back(value);
+            std::push_heap(heap_.begin(), heap_.end(), better_);
+        }
+        else if (better_(value, heap_.front())) {
+            std::pop_heap(heap_.begin(), heap_.end(), better_);
+            heap_.back() = value;
+            std::push_heap(heap_.begin(), heap_.end(), better_);
+        }
+    }
+
+    // everything `other` kept, as if it had been pushed here
+    void merge(const TopK& other) {
+        for (const T& value : other.heap_) {
+            push(value);
+        }
+    }
+
+    void clear() {
+        heap_.clear();
+    }
+
+    // the kept values, best first
+    std::vector<T> sorted() const {
+        std::vector<T> values = heap_;
+        std::sort(values.begin(), values.end(), better_);
+        return values;
+    }
+
+    //getters
+    size_t size() const {
+        return heap_.size();
+    }
+    size_t capacity() const {
+        return k_;
+    }
+    bool full() const {
+        return heap_.size() == k_;
+    }
+    // the value a push has to beat, only meaningful when full()
+    const T& worst() const {
+        return heap_.front();
+    }
+
+private:
+    size_t k_;
+    Better better_;
+    std::vector<T> heap_;  // heap ordered by better_, so front() is the worst
+};
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "price.h"
 #include "signal.h"
 #include <cstddef>  // for size_t
 
@@ -11,18 +12,19 @@
 class Trade {
 public:
     // Constructor - creates a new trade record
-    Trade(Signal type, int quantity, double price, size_t dayIndex);
+    Trade(Signal type, int quantity, Price price, size_t dayIndex);
 
     //getters
     Signal getType() const;
     int getQuantity() const;
     double getPrice() const;
+    Price getFixedPrice() const;  // the price as stored, see price.h
     size_t getDayIndex() const;
     double getTotalValue() const; //price * quantity
     
     private:
     Signal type_;
     int quantity_;
-    double price_;
+    Price price_;
     size_t dayIndex_;
 };
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "signal.h"
+#include "trade.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+// set by the BACKTESTER_FLOAT_TRADE_PRICES CMake option. float halves the
+// price column; fills are rounded to ~7 significant digits in the ledger only,
+// cash and positions still use the exact double price. With
+// BACKTESTER_FIXED_PRICES the column holds the exact Price instead
+#ifndef BACKTESTER_FLOAT_TRADE_PRICES
+#define BACKTESTER_FLOAT_TRADE_PRICES 0
+#endif
+
+#if BACKTESTER_FIXED_PRICES
+using LedgerPrice = Price;
+#elif BACKTESTER_FLOAT_TRADE_PRICES
+using LedgerPrice = float;
+#else
+using LedgerPrice = double;
+#endif
+
+/**
+ * @brief TradeLedger is the trade history of a Portfolio, one column per field
+ *
+ * A Trade is 24 bytes with padding; here a trade takes 1 + 4 + 4 + 8 (or 4)
+ * bytes in four packed columns (type, quantity, bar index, price). All four
+ * live in one block from a std::pmr::memory_resource, so growing the ledger
+ * is one allocation and a monotonic/pool resource can serve it without
+ * touching the heap. clear() keeps the block: a ledger that is cleared and
+ * refilled with no more trades than before never allocates again.
+ *
+ * Bar indexes are stored as 32 bits, record() throws std::out_of_range past
+ * 2^32 - 1 bars.
+ */
+class TradeLedger {
+public:
+    explicit TradeLedger(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    ~TradeLedger();
+
+    // copies get their block from the same resource
+    TradeLedger(const TradeLedger& other);
+    TradeLedger& operator=(const TradeLedger& other);
+    TradeLedger(TradeLedger&& other) noexcept;
+    TradeLedger& operator=(TradeLedger&& other);
+
+    void record(Signal type, int quantity, Price price, size_t dayIndex);
+    void reserve(size_t trades);
+    void clear();  // forgets the trades, keeps the block
+
+    //getters
+    size_t size() const;
+    bool empty() const;
+    size_t capacity() const;
+    Trade operator[](size_t index) const;  // rebuilt from the columns
+    size_t allocations() const;            // blocks taken from the resource so far
+
+    // raw columns, size() entries each
+    const Signal* types() const;
+    const int32_t* quantities() const;
+    const uint32_t* dayIndexes() const;
+    const LedgerPrice* prices() const;
+
+    static constexpr size_t bytesPerTrade() {
+        return sizeof(LedgerPrice) + sizeof(int32_t) + sizeof(uint32_t) + sizeof(Signal);
+    }
+
+private:
+    std::pmr::memory_resource* resource_;
+    void* block_;
+    size_t size_;
+    size_t capacity_;
+    size_t allocations_;
+
+    // the columns inside block_, widest first so each one stays aligned
+    LedgerPrice* prices_;
+    int32_t* quantities_;
+    uint32_t* dayIndexes_;
+    Signal* types_;
+
+    void grow(size_t capacity);
+    static size_t blockBytes(size_t capacity);
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// one symbol of a Universe, `id` is its index in the universe
+struct SymbolInfo {
+    uint32_t id = 0;
+    std::string symbol;   // "AAPL"
+    std::string file;     // path to its CSV
+    uint64_t bytes = 0;   // CSV size, the cost estimate used for scheduling
+};
+
+/**
+ * @brief Universe is the list of symbols a cross-symbol backtest runs over
+ *
+ * Built from a directory of daily_<SYMBOL>.csv files or from a manifest
+ * listing one symbol (or CSV path) per line. Symbols are sorted by name and
+ * numbered 0..size()-1, so ids are dense and the same for the same files.
+ * Nothing is loaded here, see UniverseBacktest.
+ */
+class Universe {
+public:
+    Universe();
+
+    //loaders - both replace what was there, false if nothing usable was found
+    // every daily_<SYMBOL>.csv directly inside dir
+    bool loadDirectory(const std::string& dir);
+    // one entry per line, '#' starts a comment. "MSFT" means
+    // <manifest dir>/daily_MSFT.csv, anything with a '/' or ending in .csv is
+    // taken as a path (symbol from its daily_<SYMBOL>.csv name, or the file name)
+    bool loadManifest(const std::string& manifest);
+    // explicit files, symbols from their names
+    bool loadFiles(const std::vector<std::string>& files);
+
+    //getters
+    size_t size() const;
+    bool empty() const;
+    const SymbolInfo& operator[](uint32_t id) const;  // throws std::out_of_range
+    const std::vector<SymbolInfo>& symbols() const;
+    uint64_t totalBytes() const;
+    // id of symbol, or UINT32_MAX when it isn't in the universe
+    uint32_t find(const std::string& symbol) const;
+
+    // ids by file size, biggest first: scheduling them in this order keeps the
+    // slowest symbols from starting last and leaving one thread to finish alone
+    std::vector<uint32_t> largestFirst() const;
+
+    // "data/daily_AAPL.csv" -> "AAPL", "prices/msft.csv" -> "msft"
+    static std::string symbolFromPath(const std::string& file);
+
+private:
+    std::vector<SymbolInfo> symbols_;
+
+    // sorts by symbol, drops duplicates and missing files, numbers the rest
+    bool adopt(std::vector<SymbolInfo> symbols);
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "backtest_engine.h"
+#include "thread_pool.h"
+#include "universe.h"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// one strategy's outcome on one symbol
+struct StrategyOutcome {
+    std::string name;
+    double returnPercent = 0.0;
+    size_t trades = 0;
+};
+
+struct SymbolResult {
+    uint32_t id = 0;
+    bool loaded = false;   // false: the file couldn't be read, nothing else is set
+    size_t bars = 0;
+    double seconds = 0.0;  // load + backtest
+    std::vector<StrategyOutcome> strategies;  // in the order Setup added them
+};
+
+// one strategy across every symbol that loaded
+struct StrategySummary {
+    std::string name;
+    size_t symbols = 0;
+    double meanReturn = 0.0;
+    double medianReturn = 0.0;
+    size_t winners = 0;   // symbols with a positive return
+    uint32_t best = 0;    // symbol ids
+    uint32_t worst = 0;
+    double bestReturn = 0.0;
+    double worstReturn = 0.0;
+    size_t trades = 0;
+};
+
+struct UniverseSummary {
+    size_t symbols = 0;
+    size_t failed = 0;
+    size_t bars = 0;
+    std::vector<StrategySummary> strategies;
+};
+
+/**
+ * @brief UniverseBacktest runs the same strategy set over every symbol of a Universe
+ *
+ * Each symbol is one task on the (work-stealing) ThreadPool: load its CSV,
+ * build a BacktestEngine, let Setup add the strategies, run, keep the
+ * returns and drop the bars. Tasks start largest file first so the long
+ * ones overlap instead of trailing at the end.
+ *
+ * Only the symbols being worked on are in memory. setMaxResident() caps
+ * that further: a task waits for a free slot before it loads, so peak
+ * memory is about maxResident of the biggest files whatever the universe
+ * size.
+ */
+class UniverseBacktest {
+public:
+    // adds the strategies (and their portfolios) for one symbol
+    using Setup = std::function<void(BacktestEngine& engine, const SymbolInfo& symbol)>;
+
+    // universe must outlive the backtest
+    UniverseBacktest(const Universe& universe, ThreadPool& pool = ThreadPool::shared());
+
+    // results indexed by symbol id
+    std::vector<SymbolResult> run(const Setup& setup);
+
+    // 0 (the default) leaves it to the pool: one symbol per running task
+    void setMaxResident(size_t symbols);
+    void setMode(BacktestEngine::Mode mode);
+    // false runs the symbols in id order, for comparison
+    void setLargestFirst(bool enabled);
+
+    static UniverseSummary summarize(const std::vector<SymbolResult>& results);
+    // the summary as a table, symbol names from universe
+    static void printSummary(const UniverseSummary& summary, const Universe& universe);
+
+    //getters - about the last run
+    double lastSeconds() const;
+    size_t peakResident() const;  // most symbols loaded at the same time
+
+private:
+    const Universe& universe_;
+    ThreadPool& pool_;
+    size_t maxResident_;
+    BacktestEngine::Mode mode_;
+    bool largestFirst_;
+    double lastSeconds_;
+
+    // resident symbol count, guarded by residentMutex_
+    std::mutex residentMutex_;
+    std::condition_variable residentFree_;
+    size_t resident_;
+    size_t peakResident_;
+
+    SymbolResult runSymbol(const SymbolInfo& symbol, const Setup& setup);
+    void acquireSlot();
+    void releaseSlot();
+};
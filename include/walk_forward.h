@@ -0,0 +1,91 @@
+#pragma once
+
+#include "market_data.h"
+#include "parameter_sweep.h"
+#include "performance_tracker.h"
+#include "portfolio.h"
+#include "thread_pool.h"
+#include <cstddef>
+#include <vector>
+
+// one train/test split, bar indexes into the walk-forward's data
+struct WalkForwardFold {
+    size_t trainBegin = 0;
+    size_t trainEnd = 0;       // == testBegin
+    size_t testBegin = 0;
+    size_t testEnd = 0;
+
+    // filled in by run()
+    size_t best = 0;           // combination chosen on the train window
+    double trainScore = 0.0;   // its SweepMetric score there
+    double trainReturn = 0.0;
+    double testReturn = 0.0;   // percent, out of sample
+    size_t testTrades = 0;
+    PerformanceStats test;
+};
+
+struct WalkForwardResult {
+    std::vector<WalkForwardFold> folds;
+    // out-of-sample equity, one value per bar from the first test bar on,
+    // each fold carrying on from the value the previous one ended at
+    std::vector<double> equity;
+    PerformanceStats outOfSample;  // over `equity`
+    double seconds = 0.0;
+};
+
+/**
+ * @brief WalkForward optimises on a rolling train window and checks on the next one
+ *
+ * Folds: train on [t, t + train), test on [t + train, t + train + test),
+ * then t += step (test by default), until no test bars are left.
+ *
+ * Every combination is one task on the ThreadPool. It computes its signal
+ * column over the whole data once and trades each fold's train window from
+ * that column. The folds share the same warmup bars and the same
+ * IndicatorCache entries, so nothing is rebuilt per fold. Signals only
+ * depend on the bars a strategy's lookback covers, so a slice of the column
+ * equals what analyzeRange() on that window would give. Each thread keeps
+ * its best combination per fold, and those are merged once. The winners
+ * then run on their test windows, one task per fold.
+ *
+ * Each test window starts flat with the starting cash. The stitched equity
+ * chains the folds' growth, as if every fold had started with the equity
+ * the previous one ended at. Whole-share rounding makes that approximate.
+ * With step < test a fold's stats cover its whole test window, but only
+ * its first step bars are stitched (the last fold keeps all of them), so
+ * every bar is in the curve once.
+ */
+class WalkForward {
+public:
+    // data must outlive the walk-forward
+    WalkForward(const MarketData& data, double startingCash = 10000.0, ThreadPool& pool = ThreadPool::shared());
+
+    // step 0 means step = testBars, back to back test windows. A shorter
+    // step overlaps them; longer throws std::invalid_argument
+    void setWindows(size_t trainBars, size_t testBars, size_t stepBars = 0);
+    // what the train window is ranked by, SweepMetric::Return by default
+    void setMetric(SweepMetric metric);
+
+    WalkForwardResult run(size_t combinations, const ParameterSweep::StrategyFactory& make);
+    WalkForwardResult runSMA(const std::vector<SMAParams>& grid);
+    WalkForwardResult runRSI(const std::vector<RSIParams>& grid);
+
+    // the folds setWindows() gives over `bars` bars, results not filled in
+    std::vector<WalkForwardFold> folds(size_t bars) const;
+
+private:
+    const MarketData& data_;
+    double startingCash_;
+    ThreadPool& pool_;
+    size_t trainBars_;
+    size_t testBars_;
+    size_t stepBars_;
+    SweepMetric metric_;
+
+    // training buffers, one per pool thread plus the caller's
+    struct Scratch {
+        std::vector<Signal> signals;
+        Portfolio portfolio;
+    };
+    std::vector<Scratch> scratch_;
+};
@@ -0,0 +1,116 @@
+#include "latency_histogram.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+const uint64_t kSubBuckets = uint64_t(1) << LatencyHistogram::kSubBucketBits;  // 256, exact below this
+const uint64_t kHalfBuckets = kSubBuckets / 2;                                   // 128 per power of two above
+const uint64_t kLargest = (uint64_t(1) << (LatencyHistogram::kMaxExponent + 1)) - 1;
+
+int highestBit(uint64_t value) {
+    return 63 - __builtin_clzll(value);
+}
+
+}
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+size_t LatencyHistogram::bucketOf(uint64_t nanos) {
+    if (nanos < kSubBuckets) {
+        return static_cast<size_t>(nanos);
+    }
+    nanos = std::min(nanos, kLargest);
+    // the top kSubBucketBits bits of the value, the highest one always set
+    int exponent = highestBit(nanos);
+    int shift = exponent - static_cast<int>(kSubBucketBits - 1);
+    uint64_t top = nanos >> shift;
+    return static_cast<size_t>(kSubBuckets + (exponent - kSubBucketBits) * kHalfBuckets + (top - kHalfBuckets));
+}
+
+uint64_t LatencyHistogram::bucketTop(size_t bucket) {
+    if (bucket < kSubBuckets) {
+        return bucket;
+    }
+    uint64_t offset = bucket - kSubBuckets;
+    int exponent = static_cast<int>(kSubBucketBits + offset / kHalfBuckets);
+    int shift = exponent - static_cast<int>(kSubBucketBits - 1);
+    uint64_t top = kHalfBuckets + offset % kHalfBuckets;
+    return ((top + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t nanos) {
+    counts_[bucketOf(nanos)]++;
+    count_++;
+    min_ = std::min(min_, nanos);
+    max_ = std::max(max_, nanos);
+    sum_ += static_cast<double>(nanos);
+}
+
+void LatencyHistogram::add(const LatencyHistogram& other) {
+    for (size_t b = 0; b < kBuckets; b++) {
+        counts_[b] += other.counts_[b];
+    }
+    count_ += other.count_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+    sum_ += other.sum_;
+}
+
+void LatencyHistogram::reset() {
+    std::fill(counts_, counts_ + kBuckets, 0);
+    count_ = 0;
+    min_ = UINT64_MAX;
+    max_ = 0;
+    sum_ = 0.0;
+}
+
+uint64_t LatencyHistogram::count() const {
+    return count_;
+}
+
+uint64_t LatencyHistogram::min() const {
+    return count_ > 0 ? min_ : 0;
+}
+
+uint64_t LatencyHistogram::max() const {
+    return max_;
+}
+
+double LatencyHistogram::mean() const {
+    return count_ > 0 ? sum_ / count_ : 0.0;
+}
+
+uint64_t LatencyHistogram::percentile(double percentile) const {
+    if (count_ == 0) {
+        return 0;
+    }
+    // rank of the record asked for, 1-based
+    double wanted = std::ceil(std::min(std::max(percentile, 0.0), 100.0) / 100.0 * count_);
+    uint64_t rank = std::max<uint64_t>(static_cast<uint64_t>(wanted), 1);
+    uint64_t seen = 0;
+    for (size_t b = 0; b < kBuckets; b++) {
+        seen += counts_[b];
+        if (seen >= rank) {
+            return std::min(bucketTop(b), max_);
+        }
+    }
+    return max_;
+}
+
+void LatencyHistogram::printSummary(const std::string& label) const {
+    auto micros = [](double nanos) { return nanos / 1000.0; };
+    std::ios::fmtflags flags = std::cout.flags();
+    std::streamsize precision = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << label << ": n=" << count_ << ", mean " << micros(mean()) << " us, p50 "
+              << micros(percentile(50.0)) << " us, p99 " << micros(percentile(99.0)) << " us, p99.9 "
+              << micros(percentile(99.9)) << " us, max " << micros(static_cast<double>(max_)) << " us"
+              << std::endl;
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+}
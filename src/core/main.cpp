@@ -4,9 +4,21 @@
 #include "rsi_strategy.h"
 #include "signal.h"
 #include "portfolio.h"
+#include "parameter_sweep.h"
+#include "backtest_engine.h"
+#include "universe_backtest.h"
+#include "walk_forward.h"
+#include "monte_carlo.h"
+#include "replay_driver.h"
+#include "profiler.h"
+#include <memory>
 
 int main() {
     std::cout << "Backtester Engine v1.0.0" << std::endl;
+    // only with -DBACKTESTER_PROFILE=ON, otherwise nothing is timed or written
+    if (Profiler::writeAtExit("backtester_profile.json", "backtester_trace.json")) {
+        std::cout << "Stage profile goes to backtester_profile.json and backtester_trace.json at exit" << std::endl;
+    }
     std::cout << "Testing MarketData class..." << std::endl;
     
     // Test MarketData with real Apple data
@@ -15,111 +27,59 @@ int main() {
     if (data.size() > 0) {
         const Bar& firstBar = data.getBar(0);
         std::cout << "First bar: Open=" << firstBar.open << ", Close=" << firstBar.close << std::endl;
+
+        // bars are sorted oldest first at load, the file itself is newest first
+        const Bar lastBar = data.getBar(data.size() - 1);
+        std::cout << "Date range: " << MarketData::formatTimestamp(firstBar.timestamp) << " to "
+                  << MarketData::formatTimestamp(lastBar.timestamp) << std::endl;
+
+        // date windows come from a binary search, the slice shares the loaded bars
+        int64_t from = 0;
+        int64_t to = 0;
+        MarketData::parseTimestamp("2025-06-01", from);
+        MarketData::parseTimestamp("2025-07-01", to);
+        MarketData june = data.sliceByTime(from, to);
+        std::cout << "Bars in June 2025: " << june.size() << std::endl;
     }
+
+    // Compare the getline/stod loader with the memory mapped one on the same file
+    MarketData streamData;
+    streamData.loadFromFile("../data/daily_AAPL.csv");
+    MarketData mappedData;
+    mappedData.loadFromFileMapped("../data/daily_AAPL.csv");
+
+    const LoadStats& streamStats = streamData.getLoadStats();
+    const LoadStats& mappedStats = mappedData.getLoadStats();
+    std::cout << "getline loader: " << streamStats.megabytesPerSecond() << " MB/s, "
+              << streamStats.rowsPerSecond() << " rows/s" << std::endl;
+    std::cout << "mmap loader:    " << mappedStats.megabytesPerSecond() << " MB/s, "
+              << mappedStats.rowsPerSecond() << " rows/s ("
+              << mappedStats.malformedRows << " malformed rows)" << std::endl;
+
+    // the constructor reads the binary cache when the CSV hasn't changed since the last run
+    std::cout << "Constructor load took " << data.getLoadStats().seconds * 1000.0 << " ms" << std::endl;
     
     // ==========================================
     // STRATEGY COMPARISON: SMA vs RSI
     // ==========================================
     
-    std::cout << "\n=== TESTING SMA CROSSOVER STRATEGY ===" << std::endl;
-    
-    // Test SMA Strategy
-    SMACrossoverStrategy smaStrategy(3, 5);
-    Portfolio smaPortfolio(10000.0);
-    
-    int smaTotalTrades = 0;
-    int smaBuySignals = 0;
-    int smaSellSignals = 0;
-    int smaHoldSignals = 0;
-    Signal smaLastSignal = Signal::Hold;
-    
-    for (size_t i = 0; i < data.size(); i++) {
-        Signal smaSignal = smaStrategy.analyze(data, i);
-        const Bar& bar = data.getBar(i);
-        
-        // Count signals
-        if (smaSignal == Signal::Buy) smaBuySignals++;
-        else if (smaSignal == Signal::Sell) smaSellSignals++;
-        else smaHoldSignals++;
-        
-        // Count trades (signal changes)
-        if (i > 0 && smaSignal != smaLastSignal && smaSignal != Signal::Hold) {
-            smaTotalTrades++;
-            std::cout << "SMA TRADE " << smaTotalTrades << " - Day " << i << ": " 
-                      << signalToString(smaSignal) << " at $" << bar.close << std::endl;
-        }
-        
-        // Execute signal in portfolio
-        smaPortfolio.executeSignal(smaSignal, bar.close, i);
-        smaLastSignal = smaSignal;
-    }
-    
-    std::cout << "\n=== TESTING RSI STRATEGY ===" << std::endl;
-    
-    // Test RSI Strategy  
-    RSIStrategy rsiStrategy(14);
-    Portfolio rsiPortfolio(10000.0);
-    
-    int rsiTotalTrades = 0;
-    int rsiBuySignals = 0;
-    int rsiSellSignals = 0;
-    int rsiHoldSignals = 0;
-    Signal rsiLastSignal = Signal::Hold;
-    
-    // Test RSI strategy on each bar
-    for (size_t i = 0; i < data.size(); i++) {
-        Signal rsiSignal = rsiStrategy.analyze(data, i);
-        const Bar& bar = data.getBar(i);
-        
-        // Count signals
-        if (rsiSignal == Signal::Buy) rsiBuySignals++;
-        else if (rsiSignal == Signal::Sell) rsiSellSignals++;
-        else rsiHoldSignals++;
-        
-        // Count trades (signal changes)
-        if (i > 0 && rsiSignal != rsiLastSignal && rsiSignal != Signal::Hold) {
-            rsiTotalTrades++;
-            std::cout << "RSI TRADE " << rsiTotalTrades << " - Day " << i << ": " 
-                      << signalToString(rsiSignal) << " at $" << bar.close << std::endl;
-        }
-        
-        // Execute signal in portfolio
-        rsiPortfolio.executeSignal(rsiSignal, bar.close, i);
-        rsiLastSignal = rsiSignal;
-    }
-    
-    // ==========================================
-    // STRATEGY COMPARISON RESULTS
-    // ==========================================
+    // both strategies advance together, one pass over the bars
+    BacktestEngine engine(data);
+    size_t sma = engine.addStrategy("SMA CROSSOVER (3-day vs 5-day)",
+                                    std::unique_ptr<Strategy>(new SMACrossoverStrategy(3, 5)), Portfolio(10000.0, &ConsoleSink::shared()));
+    size_t rsi = engine.addStrategy("RSI STRATEGY (14-day period)",
+                                    std::unique_ptr<Strategy>(new RSIStrategy(14)), Portfolio(10000.0, &ConsoleSink::shared()));
+    engine.setTradeLog(true);
+
+    std::cout << "\n=== TESTING SMA AND RSI STRATEGIES ===" << std::endl;
+    engine.run();
     
     std::cout << "\n========================================" << std::endl;
     std::cout << "         STRATEGY COMPARISON" << std::endl;
     std::cout << "========================================" << std::endl;
     
-    // SMA Results
-    std::cout << "\n=== SMA CROSSOVER (3-day vs 5-day) ===" << std::endl;
-    std::cout << "Total Days Analyzed: " << data.size() << std::endl;
-    std::cout << "Total Trades: " << smaTotalTrades << std::endl;
-    std::cout << "BUY signals: " << smaBuySignals << std::endl;
-    std::cout << "SELL signals: " << smaSellSignals << std::endl;
-    std::cout << "HOLD signals: " << smaHoldSignals << std::endl;
-    
-    if (data.size() > 0) {
-        const Bar& lastBar = data.getBar(data.size() - 1);
-        smaPortfolio.printSummary(lastBar.close);
-    }
-    
-    // RSI Results  
-    std::cout << "\n=== RSI STRATEGY (14-day period) ===" << std::endl;
-    std::cout << "Total Days Analyzed: " << data.size() << std::endl;
-    std::cout << "Total Trades: " << rsiTotalTrades << std::endl;
-    std::cout << "BUY signals: " << rsiBuySignals << std::endl;
-    std::cout << "SELL signals: " << rsiSellSignals << std::endl;
-    std::cout << "HOLD signals: " << rsiHoldSignals << std::endl;
-    
-    if (data.size() > 0) {
-        const Bar& lastBar = data.getBar(data.size() - 1);
-        rsiPortfolio.printSummary(lastBar.close);
+    for (size_t slot = 0; slot < engine.size(); slot++) {
+        engine.printSummary(slot);
     }
     
     // Performance Comparison
@@ -128,9 +88,8 @@ int main() {
     std::cout << "========================================" << std::endl;
     
     if (data.size() > 0) {
-        const Bar& lastBar = data.getBar(data.size() - 1);
-        double smaReturn = smaPortfolio.getReturn(lastBar.close);
-        double rsiReturn = rsiPortfolio.getReturn(lastBar.close);
+        double smaReturn = engine.getReturn(sma);
+        double rsiReturn = engine.getReturn(rsi);
         
         if (smaReturn > rsiReturn) {
             std::cout << "WINNER: SMA Crossover Strategy!" << std::endl;
@@ -144,6 +103,155 @@ int main() {
             std::cout << "Difference: +" << (rsiReturn - smaReturn) << "%" << std::endl;
         }
     }
-    
+
+    // ==========================================
+    // PARAMETER SWEEP
+    // ==========================================
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "         PARAMETER SWEEP" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    ParameterSweep sweep(data, 10000.0);
+
+    std::vector<SMAParams> smaGrid = ParameterSweep::smaGrid(2, 20, 3, 40);
+    // only the winners are kept, not a result per combination
+    std::vector<SweepResult> smaBest = sweep.runSMATopK(smaGrid, 3);
+    std::cout << "SMA grid: " << smaGrid.size() << " combinations in " << sweep.lastSeconds() * 1000.0
+              << " ms (" << sweep.combinationsPerSecond() << " /s)" << std::endl;
+    for (const SweepResult& result : smaBest) {
+        const SMAParams& params = smaGrid[result.combination];
+        std::cout << "  SMA(" << params.shortPeriod << ", " << params.longPeriod << "): "
+                  << result.returnPercent << "%, " << result.trades << " trades" << std::endl;
+    }
+
+    std::cout << "Best SMA by Sharpe:" << std::endl;
+    for (const SweepResult& result : sweep.runSMATopK(smaGrid, 3, SweepMetric::Sharpe)) {
+        const SMAParams& params = smaGrid[result.combination];
+        std::cout << "  SMA(" << params.shortPeriod << ", " << params.longPeriod << "): Sharpe "
+                  << result.performance.sharpe << ", max drawdown " << result.performance.maxDrawdown << "%, "
+                  << result.returnPercent << "%" << std::endl;
+    }
+
+    std::vector<RSIParams> rsiGrid = ParameterSweep::rsiGrid(
+        {5, 7, 9, 14, 21, 28}, {20.0, 25.0, 30.0, 35.0, 40.0}, {60.0, 65.0, 70.0, 75.0, 80.0});
+    std::vector<SweepResult> rsiBest = sweep.runRSITopK(rsiGrid, 3);
+    std::cout << "RSI grid: " << rsiGrid.size() << " combinations in " << sweep.lastSeconds() * 1000.0
+              << " ms (" << sweep.combinationsPerSecond() << " /s)" << std::endl;
+    for (const SweepResult& result : rsiBest) {
+        const RSIParams& params = rsiGrid[result.combination];
+        std::cout << "  RSI(" << params.period << ", " << params.oversold << "/" << params.overbought << "): "
+                  << result.returnPercent << "%, " << result.trades << " trades" << std::endl;
+    }
+
+    // ==========================================
+    // WALK-FORWARD: optimise on 40 bars, trade the next 20
+    // ==========================================
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "         WALK-FORWARD" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    WalkForward walkForward(data, 10000.0);
+    walkForward.setWindows(40, 20);
+    std::vector<SMAParams> walkGrid = ParameterSweep::smaGrid(2, 10, 3, 20);
+    WalkForwardResult walk = walkForward.runSMA(walkGrid);
+    for (const WalkForwardFold& fold : walk.folds) {
+        const SMAParams& params = walkGrid[fold.best];
+        std::cout << "Train [" << fold.trainBegin << ", " << fold.trainEnd << "): SMA(" << params.shortPeriod
+                  << ", " << params.longPeriod << ") " << fold.trainReturn << "%, test [" << fold.testBegin
+                  << ", " << fold.testEnd << "): " << fold.testReturn << "%" << std::endl;
+    }
+    if (!walk.folds.empty()) {
+        std::cout << "Out of sample: " << walk.outOfSample.totalReturn << "% over " << walk.equity.size()
+                  << " bars, Sharpe " << walk.outOfSample.sharpe << ", max drawdown "
+                  << walk.outOfSample.maxDrawdown << "%" << std::endl;
+    }
+
+    // ==========================================
+    // MONTE CARLO: is SMA(3, 5) better than luck?
+    // ==========================================
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "         MONTE CARLO" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    if (data.size() > 1) {
+        MonteCarlo monteCarlo(10000.0);
+        MonteCarloResult resampled = monteCarlo.bootstrap(data, MonteCarlo::sma(3, 5), 1000, 5);
+        MonteCarlo::printSummary("Bootstrap (5 bar blocks)", resampled);
+        MonteCarloResult simulated = monteCarlo.gbm(MonteCarlo::fitGBM(data), data.size(), MonteCarlo::sma(3, 5), 1000);
+        MonteCarlo::printSummary("GBM", simulated);
+        const TradeLedger& trades = engine.getPortfolio(sma).getTradeHistory();
+        MonteCarlo::printSummary("Trade order", monteCarlo.shuffleTrades(trades, 10000.0, 1000));
+        std::cout << "1000 bootstrap paths in " << resampled.seconds * 1000.0 << " ms ("
+                  << resampled.pathsPerSecond() << " paths/s)" << std::endl;
+    }
+
+    // ==========================================
+    // REPLAY: the CSV bar by bar through onBar()
+    // ==========================================
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "         REPLAY" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    BarSource replaySource;
+    if (replaySource.open("../data/daily_AAPL.csv")) {
+        ReplayDriver replay;
+        replay.addStrategy("SMA(3,5)", std::unique_ptr<Strategy>(new SMACrossoverStrategy(3, 5)), Portfolio(10000.0));
+        replay.addStrategy("RSI(14)", std::unique_ptr<Strategy>(new RSIStrategy(14)), Portfolio(10000.0));
+        replay.run(replaySource);
+        replay.printSummary();
+    }
+    else {
+        std::cout << "could not open ../data/daily_AAPL.csv" << std::endl;
+    }
+
+    // ==========================================
+    // TIMEFRAMES: weekly bars resampled from the daily ones
+    // ==========================================
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "         TIMEFRAMES" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    MarketData weeks = data.resample(MarketData::kWeek);
+    if (weeks.size() > 0) {
+        BacktestEngine weekly(weeks);
+        weekly.addStrategy("SMA(3,5)", std::unique_ptr<Strategy>(new SMACrossoverStrategy(3, 5)), Portfolio(10000.0));
+        weekly.run();
+        Bar first = weeks.getBar(0);
+        std::cout << data.size() << " daily bars -> " << weeks.size() << " weekly bars, the first ("
+                  << MarketData::formatTimestamp(first.timestamp) << ") O " << first.open << " H " << first.high
+                  << " L " << first.low << " C " << first.close << std::endl;
+        std::cout << "SMA(3,5) on weekly bars: " << weekly.getPortfolio(0).getTradeHistory().size()
+                  << " trades, return "
+                  << weekly.getReturn(0) << "% (daily " << engine.getReturn(sma) << "%)" << std::endl;
+    }
+
+    // ==========================================
+    // UNIVERSE: every daily_<SYMBOL>.csv in data/
+    // ==========================================
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "         UNIVERSE" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    Universe universe;
+    if (universe.loadDirectory("../data")) {
+        UniverseBacktest backtest(universe);
+        std::vector<SymbolResult> results = backtest.run([](BacktestEngine& symbolEngine, const SymbolInfo&) {
+            symbolEngine.addStrategy("SMA(3,5)", std::unique_ptr<Strategy>(new SMACrossoverStrategy(3, 5)),
+                                     Portfolio(10000.0));
+            symbolEngine.addStrategy("RSI(14)", std::unique_ptr<Strategy>(new RSIStrategy(14)), Portfolio(10000.0));
+        });
+        UniverseBacktest::printSummary(UniverseBacktest::summarize(results), universe);
+        std::cout << "in " << backtest.lastSeconds() * 1000.0 << " ms" << std::endl;
+    }
+    else {
+        std::cout << "no daily_<SYMBOL>.csv files in ../data" << std::endl;
+    }
+
     return 0;
 }
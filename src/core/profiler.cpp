@@ -0,0 +1,228 @@
+#include "profiler.h"
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+namespace {
+
+// never destroyed: threads (and the atexit writer) may still use it while
+// static destructors run
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Profiler::ThreadCounters>> threads;
+    std::atomic<uint64_t> sampleInterval{64};
+    // both clocks at the first registration, for ticks -> ns
+    uint64_t startTicks = Profiler::now();
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    std::string jsonFile;
+    std::string traceFile;
+};
+
+Registry& registry() {
+    static Registry* instance = new Registry();
+    return *instance;
+}
+
+const char* const kStageNames[kProfileStages] = {"load", "analyze", "execute", "record", "run"};
+
+// one stage of one thread: the scopes as measured, the samples scaled up to
+// every call
+Profiler::StageTotal stageTotal(const Profiler::ThreadCounters& counters, size_t s, double nsPerTick) {
+    Profiler::StageTotal total;
+    total.calls = counters.calls[s] + counters.sampledCalls[s];
+    total.timed = counters.calls[s] + counters.sampledTimed[s];
+    double ticks = static_cast<double>(counters.ticks[s]);
+    if (counters.sampledTimed[s] > 0) {
+        ticks += static_cast<double>(counters.sampledTicks[s]) * counters.sampledCalls[s] / counters.sampledTimed[s];
+    }
+    total.seconds = ticks * nsPerTick * 1e-9;
+    return total;
+}
+
+void writeAtExitHandler() {
+    Registry& r = registry();
+    Profiler::writeJson(r.jsonFile);
+    Profiler::writeChromeTrace(r.traceFile);
+}
+
+}
+
+Profiler::ThreadCounters* Profiler::registerThread() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.threads.push_back(std::unique_ptr<ThreadCounters>(new ThreadCounters()));
+    r.threads.back()->thread = r.threads.size() - 1;
+    return r.threads.back().get();
+}
+
+void Profiler::setSampleInterval(uint64_t calls) {
+    uint64_t interval = 1;
+    while (interval < calls) {
+        interval *= 2;
+    }
+    registry().sampleInterval.store(interval, std::memory_order_relaxed);
+}
+
+uint64_t Profiler::sampleInterval() {
+    return registry().sampleInterval.load(std::memory_order_relaxed);
+}
+
+double Profiler::nanosecondsPerTick() {
+#if defined(__x86_64__) || defined(__i386__)
+    Registry& r = registry();
+    uint64_t ticks = now() - r.startTicks;
+    double nanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - r.startTime).count();
+    return ticks > 0 ? nanos / ticks : 1.0;
+#else
+    return std::chrono::steady_clock::period::num * 1e9 / std::chrono::steady_clock::period::den;
+#endif
+}
+
+std::vector<Profiler::StageTotal> Profiler::totals() {
+    Registry& r = registry();
+    double nsPerTick = nanosecondsPerTick();
+    std::vector<StageTotal> result(kProfileStages);
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (const auto& thread : r.threads) {
+        for (size_t s = 0; s < kProfileStages; s++) {
+            StageTotal stage = stageTotal(*thread, s, nsPerTick);
+            result[s].calls += stage.calls;
+            result[s].timed += stage.timed;
+            result[s].seconds += stage.seconds;
+        }
+    }
+    return result;
+}
+
+void Profiler::reset() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (auto& thread : r.threads) {
+        for (size_t s = 0; s < kProfileStages; s++) {
+            thread->ticks[s] = 0;
+            thread->calls[s] = 0;
+            thread->sampledTicks[s] = 0;
+            thread->sampledTimed[s] = 0;
+            thread->sampledCalls[s] = 0;
+        }
+        thread->events.clear();
+        thread->droppedEvents = 0;
+    }
+}
+
+bool Profiler::writeJson(const std::string& file) {
+    std::ofstream out(file);
+    if (!out) {
+        return false;
+    }
+    Registry& r = registry();
+    double nsPerTick = nanosecondsPerTick();
+    std::vector<StageTotal> sums = totals();
+
+    auto stage = [&out](size_t s, const StageTotal& total) {
+        out << "\"" << kStageNames[s] << "\": {\"calls\": " << total.calls << ", \"timed\": " << total.timed
+            << ", \"ms\": " << total.seconds * 1000.0 << "}";
+    };
+    out << std::setprecision(6);
+    out << "{\n  \"enabled\": " << (BACKTESTER_ENABLE_PROFILE ? "true" : "false")
+        << ",\n  \"sample_interval\": " << sampleInterval() << ",\n  \"ns_per_tick\": " << nsPerTick
+        << ",\n  \"threads\": [";
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (size_t t = 0; t < r.threads.size(); t++) {
+            const ThreadCounters& thread = *r.threads[t];
+            out << (t == 0 ? "\n" : ",\n") << "    {\"thread\": " << thread.thread << ", ";
+            for (size_t s = 0; s < kProfileStages; s++) {
+                stage(s, stageTotal(thread, s, nsPerTick));
+                out << ", ";
+            }
+            out << "\"dropped_events\": " << thread.droppedEvents << "}";
+        }
+    }
+    out << "\n  ],\n  \"totals\": {";
+    for (size_t s = 0; s < kProfileStages; s++) {
+        out << (s == 0 ? "\n    " : ",\n    ");
+        stage(s, sums[s]);
+    }
+    out << "\n  }\n}\n";
+    return static_cast<bool>(out);
+}
+
+bool Profiler::writeChromeTrace(const std::string& file) {
+    std::ofstream out(file);
+    if (!out) {
+        return false;
+    }
+    Registry& r = registry();
+    double nsPerTick = nanosecondsPerTick();
+    // microseconds since the first registration, what "ts" and "dur" are in
+    auto micros = [&](uint64_t ticks) { return (ticks - r.startTicks) * nsPerTick / 1000.0; };
+    uint64_t endTicks = now();
+
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+    bool first = true;
+    auto separator = [&] {
+        out << (first ? "\n" : ",\n");
+        first = false;
+    };
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (const auto& thread : r.threads) {
+        separator();
+        out << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << thread->thread
+            << ", \"args\": {\"name\": \"thread " << thread->thread << "\"}}";
+        for (const ProfileEvent& event : thread->events) {
+            separator();
+            out << "{\"name\": \"" << stageName(event.stage) << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": "
+                << thread->thread << ", \"ts\": " << micros(event.begin) << ", \"dur\": "
+                << (event.end - event.begin) * nsPerTick / 1000.0 << "}";
+        }
+        // the sampled stages have no events, their totals go in as counters
+        separator();
+        out << "{\"name\": \"stage ms, thread " << thread->thread << "\", \"ph\": \"C\", \"pid\": 1, \"tid\": "
+            << thread->thread << ", \"ts\": " << micros(endTicks) << ", \"args\": {";
+        for (size_t s = 0; s < kProfileStages; s++) {
+            out << (s == 0 ? "" : ", ") << "\"" << kStageNames[s] << "\": "
+                << stageTotal(*thread, s, nsPerTick).seconds * 1000.0;
+        }
+        out << "}}";
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
+
+bool Profiler::writeAtExit(const std::string& jsonFile, const std::string& traceFile) {
+#if BACKTESTER_ENABLE_PROFILE
+    Registry& r = registry();
+    bool registered = !r.jsonFile.empty();
+    r.jsonFile = jsonFile;
+    r.traceFile = traceFile;
+    return registered || std::atexit(writeAtExitHandler) == 0;
+#else
+    (void)jsonFile;
+    (void)traceFile;
+    (void)writeAtExitHandler;
+    return false;
+#endif
+}
+
+void Profiler::printSummary() {
+    std::vector<StageTotal> sums = totals();
+    std::cout << std::left << std::setw(10) << "stage" << std::right << std::setw(14) << "calls"
+              << std::setw(12) << "timed" << std::setw(12) << "ms" << std::setw(12) << "ns/call" << std::endl;
+    for (size_t s = 0; s < kProfileStages; s++) {
+        std::cout << std::left << std::setw(10) << kStageNames[s] << std::right << std::setw(14) << sums[s].calls
+                  << std::setw(12) << sums[s].timed << std::fixed << std::setprecision(2) << std::setw(12)
+                  << sums[s].seconds * 1000.0 << std::setw(12)
+                  << (sums[s].calls > 0 ? sums[s].seconds * 1e9 / sums[s].calls : 0.0) << std::defaultfloat
+                  << std::endl;
+    }
+}
+
+const char* Profiler::stageName(ProfileStage stage) {
+    return kStageNames[static_cast<size_t>(stage)];
+}
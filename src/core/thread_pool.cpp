@@ -0,0 +1,201 @@
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace {
+
+// which pool (and which of its workers) the current thread belongs to
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local size_t currentWorker = 0;
+
+// shared between the caller of parallelFor and the helper tasks it submits,
+// a helper that only starts after all indices are claimed just returns
+struct ParallelForState {
+    std::function<void(size_t)> body;
+    size_t count = 0;
+    std::atomic<size_t> next{0};
+    std::mutex mutex;
+    std::condition_variable done;
+    size_t finished = 0;
+    std::exception_ptr firstError;
+
+    void runAvailable() {
+        size_t index;
+        while ((index = next.fetch_add(1)) < count) {
+            std::exception_ptr error;
+            try {
+                body(index);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            if (error && !firstError) {
+                firstError = error;
+            }
+            finished++;
+            if (finished == count) {
+                done.notify_all();
+            }
+        }
+    }
+};
+
+}
+
+ThreadPool::ThreadPool(size_t threads) :
+    nextQueue_(0), queued_(0), stopping_(false), pending_(0) {
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    if (threads == 0) {
+        threads = 1;  // hardware_concurrency is allowed to return 0
+    }
+
+    queues_.reserve(threads);
+    for (size_t i = 0; i < threads; i++) {
+        queues_.push_back(std::make_unique<WorkerQueue>());
+    }
+    workers_.reserve(threads);
+    for (size_t i = 0; i < threads; i++) {
+        workers_.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_ = true;
+    }
+    taskReady_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(doneMutex_);
+        pending_++;
+    }
+
+    // a worker keeps what it spawns (usually still hot in its cache)
+    size_t target = currentPool == this ? currentWorker : nextQueue_.fetch_add(1) % queues_.size();
+    {
+        std::lock_guard<std::mutex> lock(queues_[target]->mutex);
+        queues_[target]->tasks.push_back(std::move(task));
+    }
+    queued_.fetch_add(1);
+
+    // taking the lock orders this wake-up after any worker that is about to sleep
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+    }
+    taskReady_.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(doneMutex_);
+    allDone_.wait(lock, [this] { return pending_ == 0; });
+
+    if (firstError_) {
+        std::exception_ptr error = firstError_;
+        firstError_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+
+    auto state = std::make_shared<ParallelForState>();
+    state->body = body;
+    state->count = count;
+
+    // one helper per worker at most, the caller takes indices as well so the
+    // loop still finishes if every worker is busy (e.g. nested inside a task)
+    size_t helpers = std::min(workers_.size(), count - 1);
+    for (size_t i = 0; i < helpers; i++) {
+        submit([state] { state->runAvailable(); });
+    }
+    state->runAvailable();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&state] { return state->finished == state->count; });
+    if (state->firstError) {
+        std::rethrow_exception(state->firstError);
+    }
+}
+
+size_t ThreadPool::size() const {
+    return workers_.size();
+}
+
+size_t ThreadPool::workerIndex() const {
+    return currentPool == this ? currentWorker : workers_.size();
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+bool ThreadPool::takeTask(size_t index, std::function<void()>& task) {
+    {
+        WorkerQueue& own = *queues_[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queued_.fetch_sub(1);
+            return true;
+        }
+    }
+
+    for (size_t offset = 1; offset < queues_.size(); offset++) {
+        WorkerQueue& victim = *queues_[(index + offset) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queued_.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    currentPool = this;
+    currentWorker = index;
+
+    while (true) {
+        std::function<void()> task;
+        if (!takeTask(index, task)) {
+            std::unique_lock<std::mutex> lock(sleepMutex_);
+            taskReady_.wait(lock, [this] { return stopping_ || queued_.load() > 0; });
+            if (stopping_ && queued_.load() == 0) {
+                return;  // stopping and nothing left to run
+            }
+            continue;
+        }
+
+        std::exception_ptr error;
+        try {
+            task();
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock(doneMutex_);
+        if (error && !firstError_) {
+            firstError_ = error;
+        }
+        pending_--;
+        if (pending_ == 0) {
+            allDone_.notify_all();
+        }
+    }
+}
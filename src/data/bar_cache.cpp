@@ -0,0 +1,238 @@
+#include "bar_cache.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <cstdlib>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char kMagic[8] = {'B', 'T', 'C', 'A', 'C', 'H', 'E', '\0'};
+const size_t kAlignment = 64;
+
+// column type codes stored in the header
+const uint8_t kFloat64 = 1;
+const uint8_t kInt64 = 2;
+const uint8_t kColumnTypes[BarCache::kColumnCount] = {kInt64, kFloat64, kFloat64, kFloat64, kFloat64, kFloat64};
+
+struct CacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t columnCount;
+    uint8_t columnTypes[8];
+    uint64_t rowCount;
+    uint64_t sourceSize;
+    int64_t sourceMtimeNs;
+};
+
+size_t alignUp(size_t value) {
+    return (value + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+// every column type is 8 bytes wide
+size_t columnOffset(size_t column, size_t rows) {
+    return alignUp(sizeof(CacheHeader)) + column * alignUp(rows * sizeof(double));
+}
+
+// a file of fileSize bytes holds every column of a header's rowCount rows.
+// rowCount is bounded by the file size first, so a corrupt one can't
+// overflow the offsets into passing the size check
+bool holdsRows(uint64_t rowCount, size_t fileSize) {
+    size_t dataStart = alignUp(sizeof(CacheHeader));
+    if (fileSize < dataStart || rowCount > (fileSize - dataStart) / (BarCache::kColumnCount * sizeof(double))) {
+        return false;
+    }
+    return fileSize >= columnOffset(BarCache::kColumnCount, static_cast<size_t>(rowCount));
+}
+
+// writes one column, gathering through a small buffer when the view is strided
+template <typename T>
+bool writeColumn(std::FILE* out, const ColumnView<T>& values) {
+    static_assert(sizeof(T) == 8, "cache columns are 8 bytes wide");
+    if (values.isContiguous()) {
+        return values.empty() || std::fwrite(values.data(), sizeof(T), values.size(), out) == values.size();
+    }
+
+    std::vector<T> buffer(4096);
+    for (size_t start = 0; start < values.size(); start += buffer.size()) {
+        size_t count = std::min(buffer.size(), values.size() - start);
+        for (size_t i = 0; i < count; i++) {
+            buffer[i] = values[start + i];
+        }
+        if (std::fwrite(buffer.data(), sizeof(T), count, out) != count) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool writeZeros(std::FILE* out, size_t count) {
+    static const char zeros[kAlignment] = {};
+    return count == 0 || std::fwrite(zeros, 1, count, out) == count;
+}
+
+}
+
+bool SourceStamp::read(const std::string& file, SourceStamp& stamp) {
+    struct stat info;
+    if (::stat(file.c_str(), &info) != 0) {
+        return false;
+    }
+    stamp.size = static_cast<uint64_t>(info.st_size);
+#ifdef __APPLE__
+    stamp.mtimeNs = static_cast<int64_t>(info.st_mtimespec.tv_sec) * 1000000000 + info.st_mtimespec.tv_nsec;
+#else
+    stamp.mtimeNs = static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+#endif
+    return true;
+}
+
+bool SourceStamp::operator==(const SourceStamp& other) const {
+    return size == other.size && mtimeNs == other.mtimeNs;
+}
+
+std::string BarCache::sidecarPath(const std::string& sourceFile) {
+    return sourceFile + ".bcache";
+}
+
+bool BarCache::write(const std::string& cacheFile, const MarketData& data, const SourceStamp& source) {
+    CacheHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.columnCount = kColumnCount;
+    for (size_t i = 0; i < kColumnCount; i++) {
+        header.columnTypes[i] = kColumnTypes[i];
+    }
+    header.rowCount = data.size();
+    header.sourceSize = source.size;
+    header.sourceMtimeNs = source.mtimeNs;
+
+    // a temp file of our own, so two processes caching the same CSV can't
+    // rename each other's half-written file into place
+    std::string tempFile = cacheFile + ".XXXXXX";
+    int fd = ::mkstemp(&tempFile[0]);
+    if (fd < 0) {
+        return false;
+    }
+    ::fchmod(fd, 0644);  // mkstemp makes it owner-only
+    std::FILE* out = ::fdopen(fd, "wb");
+    if (!out) {
+        ::close(fd);
+        std::remove(tempFile.c_str());
+        return false;
+    }
+
+    bool ok = std::fwrite(&header, sizeof(header), 1, out) == 1;
+    ok = ok && writeZeros(out, alignUp(sizeof(header)) - sizeof(header));
+
+    size_t columnBytes = data.size() * sizeof(double);
+    size_t padding = alignUp(columnBytes) - columnBytes;
+
+    ok = ok && writeColumn(out, data.timestamp()) && writeZeros(out, padding);
+    const ColumnView<double> values[] = {data.open(), data.high(), data.low(), data.close(), data.volume()};
+    for (const ColumnView<double>& column : values) {
+        ok = ok && writeColumn(out, column) && writeZeros(out, padding);
+    }
+
+    ok = (std::fclose(out) == 0) && ok;
+    if (!ok || std::rename(tempFile.c_str(), cacheFile.c_str()) != 0) {
+        std::remove(tempFile.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool BarCache::readLayout(const std::string& cacheFile, size_t& rows, size_t offsets[kColumnCount]) {
+    std::FILE* in = std::fopen(cacheFile.c_str(), "rb");
+    if (!in) {
+        return false;
+    }
+    CacheHeader header;
+    bool valid = std::fread(&header, sizeof(header), 1, in) == 1;
+    std::fseek(in, 0, SEEK_END);
+    long fileSize = std::ftell(in);
+    std::fclose(in);
+
+    valid = valid && std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0
+        && header.version == kVersion
+        && header.columnCount == kColumnCount;
+    for (size_t i = 0; valid && i < kColumnCount; i++) {
+        valid = header.columnTypes[i] == kColumnTypes[i];
+    }
+    valid = valid && fileSize >= 0 && holdsRows(header.rowCount, static_cast<size_t>(fileSize));
+    if (!valid) {
+        return false;
+    }
+
+    rows = header.rowCount;
+    for (size_t i = 0; i < kColumnCount; i++) {
+        offsets[i] = columnOffset(i, rows);
+    }
+    return true;
+}
+
+BarCache::BarCache() : rows_(0), columns_() {
+}
+
+bool BarCache::open(const std::string& cacheFile, const SourceStamp& expected) {
+    close();
+    if (!file_.open(cacheFile) || file_.size() < sizeof(CacheHeader)) {
+        close();
+        return false;
+    }
+
+    CacheHeader header;
+    std::memcpy(&header, file_.data(), sizeof(header));
+
+    bool valid = std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0
+        && header.version == kVersion
+        && header.columnCount == kColumnCount
+        && header.sourceSize == expected.size
+        && header.sourceMtimeNs == expected.mtimeNs;
+    for (size_t i = 0; valid && i < kColumnCount; i++) {
+        valid = header.columnTypes[i] == kColumnTypes[i];
+    }
+    // the file must actually hold every column the header promises
+    valid = valid && holdsRows(header.rowCount, file_.size());
+    if (!valid) {
+        close();
+        return false;
+    }
+
+    rows_ = header.rowCount;
+    for (size_t i = 0; i < kColumnCount; i++) {
+        columns_[i] = file_.data() + columnOffset(i, rows_);
+    }
+    return true;
+}
+
+void BarCache::close() {
+    file_.close();
+    rows_ = 0;
+    for (size_t i = 0; i < kColumnCount; i++) {
+        columns_[i] = nullptr;
+    }
+}
+
+bool BarCache::isOpen() const {
+    return file_.isOpen();
+}
+
+size_t BarCache::size() const {
+    return rows_;
+}
+
+size_t BarCache::fileSize() const {
+    return file_.size();
+}
+
+const int64_t* BarCache::timestamps() const {
+    return reinterpret_cast<const int64_t*>(columns_[0]);
+}
+
+const double* BarCache::column(size_t index) const {
+    return reinterpret_cast<const double*>(columns_[index]);
+}
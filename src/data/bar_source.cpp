@@ -0,0 +1,342 @@
+#include "bar_source.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// enough to find the header and one complete row at either end of the file
+const size_t kProbeBytes = 64 * 1024;
+
+bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+}
+
+BarSource::BarSource() :
+    fd_(-1), format_(Format::Csv), fileSize_(0), reversed_(false), dataBegin_(0), dataEnd_(0),
+    rows_(0), nextRow_(0), offsets_(), pendingNext_(0), barsRead_(0), bytesRead_(0), malformedRows_(0),
+    outOfOrderRows_(0), lastTimestamp_(0) {
+}
+
+BarSource::~BarSource() {
+    close();
+}
+
+bool BarSource::open(const std::string& file) {
+    return endsWith(file, ".bcache") ? openBinary(file) : openCsv(file);
+}
+
+bool BarSource::openCsv(const std::string& file) {
+    close();
+    fd_ = ::open(file.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        return false;
+    }
+    struct stat info;
+    if (::fstat(fd_, &info) != 0) {
+        close();
+        return false;
+    }
+    format_ = Format::Csv;
+    fileSize_ = static_cast<size_t>(info.st_size);
+
+    // skip the header line
+    std::vector<char> head(std::min(fileSize_, kProbeBytes));
+    if (!readAt(0, head.size(), head.data())) {
+        close();
+        return false;
+    }
+    const char* newline = static_cast<const char*>(std::memchr(head.data(), '\n', head.size()));
+    dataBegin_ = newline ? static_cast<size_t>(newline - head.data()) + 1 : fileSize_;
+    dataEnd_ = fileSize_;
+
+    // newest first when the first row is later than the last one
+    int64_t firstTime = 0;
+    int64_t lastTime = 0;
+    size_t tailBytes = std::min(dataEnd_ - dataBegin_, kProbeBytes);
+    std::vector<char> tail(tailBytes);
+    if (tailBytes > 0 && readAt(dataEnd_ - tailBytes, tailBytes, tail.data()) &&
+        firstRowTime(head.data() + std::min(dataBegin_, head.size()), head.data() + head.size(), firstTime)) {
+        // walk back from the end to the last row that parses
+        const char* end = tail.data() + tail.size();
+        bool found = false;
+        while (!found && end > tail.data()) {
+            const char* lineEnd = end;
+            if (lineEnd[-1] == '\n') {
+                lineEnd--;
+            }
+            const char* lineBegin = lineEnd;
+            while (lineBegin > tail.data() && lineBegin[-1] != '\n') {
+                lineBegin--;
+            }
+            Bar bar;
+            // the first line of the probe may be cut, only trust it if the probe starts a row
+            bool whole = lineBegin > tail.data() || tailBytes == dataEnd_ - dataBegin_;
+            if (whole && lineBegin < lineEnd && MarketData::parseCsvRow(lineBegin, lineEnd, bar)) {
+                lastTime = bar.timestamp;
+                found = true;
+            }
+            end = lineBegin;
+        }
+        reversed_ = found && firstTime > lastTime;
+    }
+
+    // the probes were only for finding the order, they don't count as read
+    bytesRead_ = 0;
+    return true;
+}
+
+bool BarSource::openBinary(const std::string& cacheFile) {
+    close();
+    if (!BarCache::readLayout(cacheFile, rows_, offsets_)) {
+        return false;
+    }
+    fd_ = ::open(cacheFile.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        return false;
+    }
+    format_ = Format::Binary;
+    nextRow_ = 0;
+    return true;
+}
+
+void BarSource::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    fd_ = -1;
+    fileSize_ = 0;
+    reversed_ = false;
+    dataBegin_ = 0;
+    dataEnd_ = 0;
+    partial_.clear();
+    rows_ = 0;
+    nextRow_ = 0;
+    pending_.clear();
+    pendingNext_ = 0;
+    barsRead_ = 0;
+    bytesRead_ = 0;
+    malformedRows_ = 0;
+    outOfOrderRows_ = 0;
+    lastTimestamp_ = 0;
+}
+
+size_t BarSource::read(Bar* out, size_t count) {
+    size_t copied = 0;
+    while (copied < count) {
+        if (pendingNext_ == pending_.size() && !refill()) {
+            break;
+        }
+        size_t take = std::min(count - copied, pending_.size() - pendingNext_);
+        for (size_t i = 0; i < take; i++) {
+            const Bar& bar = pending_[pendingNext_ + i];
+            if (barsRead_ + i > 0 && bar.timestamp < lastTimestamp_) {
+                outOfOrderRows_++;
+            }
+            lastTimestamp_ = bar.timestamp;
+            out[copied + i] = bar;
+        }
+        pendingNext_ += take;
+        copied += take;
+        barsRead_ += take;
+    }
+    return copied;
+}
+
+bool BarSource::next(Bar& bar) {
+    return read(&bar, 1) == 1;
+}
+
+bool BarSource::readAt(size_t offset, size_t bytes, void* out) {
+    char* p = static_cast<char*>(out);
+    while (bytes > 0) {
+        ssize_t got = ::pread(fd_, p, bytes, static_cast<off_t>(offset));
+        if (got <= 0) {
+            return false;
+        }
+        p += got;
+        offset += static_cast<size_t>(got);
+        bytes -= static_cast<size_t>(got);
+        bytesRead_ += static_cast<size_t>(got);
+    }
+    return true;
+}
+
+bool BarSource::refill() {
+    pending_.clear();
+    pendingNext_ = 0;
+    if (fd_ < 0) {
+        return false;
+    }
+    // a refill can end on a partial row and parse nothing, keep going
+    while (pending_.empty()) {
+        bool more = format_ == Format::Binary ? refillBinary()
+                  : reversed_ ? refillCsvBackward() : refillCsvForward();
+        if (!more) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BarSource::refillCsvForward() {
+    if (dataBegin_ == dataEnd_) {
+        return false;
+    }
+    size_t bytes = std::min(kChunkBytes, dataEnd_ - dataBegin_);
+
+    // the cut row from last time, then the new bytes
+    chunk_.assign(partial_.begin(), partial_.end());
+    size_t carried = chunk_.size();
+    chunk_.resize(carried + bytes);
+    if (!readAt(dataBegin_, bytes, chunk_.data() + carried)) {
+        dataBegin_ = dataEnd_;
+        return false;
+    }
+    dataBegin_ += bytes;
+
+    const char* begin = chunk_.data();
+    const char* end = begin + chunk_.size();
+    if (dataBegin_ == dataEnd_) {
+        partial_.clear();
+        parseRows(begin, end);
+        return true;
+    }
+
+    // everything up to the last newline is whole rows
+    const char* cut = end;
+    while (cut > begin && cut[-1] != '\n') {
+        cut--;
+    }
+    partial_.assign(cut, end);
+    parseRows(begin, cut);
+    return true;
+}
+
+bool BarSource::refillCsvBackward() {
+    if (dataBegin_ == dataEnd_) {
+        return false;
+    }
+    size_t bytes = std::min(kChunkBytes, dataEnd_ - dataBegin_);
+    size_t start = dataEnd_ - bytes;
+
+    // the new bytes come before the rows already seen, the cut row finishes them
+    chunk_.resize(bytes);
+    if (!readAt(start, bytes, chunk_.data())) {
+        dataEnd_ = dataBegin_;
+        return false;
+    }
+    chunk_.insert(chunk_.end(), partial_.begin(), partial_.end());
+    dataEnd_ = start;
+
+    const char* begin = chunk_.data();
+    const char* end = begin + chunk_.size();
+    const char* whole = begin;
+    if (start > dataBegin_) {
+        // the first row may have started in bytes not read yet
+        const char* newline = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+        whole = newline ? newline + 1 : end;
+    }
+    std::vector<char> cut(begin, whole);
+
+    size_t first = pending_.size();
+    parseRows(whole, end);
+    // newest first in the file, oldest first out
+    std::reverse(pending_.begin() + first, pending_.end());
+    partial_.swap(cut);
+    return true;
+}
+
+bool BarSource::refillBinary() {
+    if (nextRow_ == rows_) {
+        return false;
+    }
+    size_t count = std::min(rows_ - nextRow_, kChunkBytes / sizeof(double));
+    pending_.resize(count);
+    chunk_.resize(count * sizeof(double));
+
+    static double Bar::* const kValues[BarCache::kColumnCount - 1] = {
+        &Bar::open, &Bar::high, &Bar::low, &Bar::close, &Bar::volume
+    };
+    for (size_t column = 0; column < BarCache::kColumnCount; column++) {
+        if (!readAt(offsets_[column] + nextRow_ * sizeof(double), chunk_.size(), chunk_.data())) {
+            pending_.clear();
+            nextRow_ = rows_;
+            return false;
+        }
+        const char* values = chunk_.data();
+        for (size_t i = 0; i < count; i++) {
+            if (column == 0) {
+                std::memcpy(&pending_[i].timestamp, values + i * sizeof(double), sizeof(int64_t));
+            }
+            else {
+                std::memcpy(&(pending_[i].*kValues[column - 1]), values + i * sizeof(double), sizeof(double));
+            }
+        }
+    }
+    nextRow_ += count;
+    return true;
+}
+
+void BarSource::parseRows(const char* begin, const char* end) {
+    // same line splitting as MarketData::parseBuffer
+    const char* p = begin;
+    while (p < end) {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char* lineEnd = newline ? newline : end;
+
+        Bar bar;
+        if (MarketData::parseCsvRow(p, lineEnd, bar)) {
+            pending_.push_back(bar);
+        }
+        else {
+            malformedRows_++;
+        }
+        p = newline ? newline + 1 : end;
+    }
+}
+
+bool BarSource::firstRowTime(const char* begin, const char* end, int64_t& time) const {
+    const char* p = begin;
+    while (p < end) {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!newline) {
+            return false;  // cut off by the probe
+        }
+        Bar bar;
+        if (MarketData::parseCsvRow(p, newline, bar)) {
+            time = bar.timestamp;
+            return true;
+        }
+        p = newline + 1;
+    }
+    return false;
+}
+
+bool BarSource::isOpen() const {
+    return fd_ >= 0;
+}
+
+BarSource::Format BarSource::getFormat() const {
+    return format_;
+}
+
+size_t BarSource::barsRead() const {
+    return barsRead_;
+}
+
+size_t BarSource::bytesRead() const {
+    return bytesRead_;
+}
+
+size_t BarSource::malformedRows() const {
+    return malformedRows_;
+}
+
+size_t BarSource::outOfOrderRows() const {
+    return outOfOrderRows_;
+}
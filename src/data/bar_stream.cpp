@@ -0,0 +1,144 @@
+#include "bar_stream.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+BarStream::BarStream() :
+    fd_(-1), ownsFd_(false), buffer_(kBufferBytes), begin_(0), end_(0), finished_(false), barsRead_(0),
+    bytesRead_(0), malformedRows_(0) {
+}
+
+BarStream::~BarStream() {
+    close();
+}
+
+bool BarStream::open(const std::string& path) {
+    close();
+    struct stat info;
+    if (::stat(path.c_str(), &info) != 0) {
+        return false;
+    }
+    int fd = -1;
+    if (S_ISSOCK(info.st_mode)) {
+        sockaddr_un address;
+        if (path.size() >= sizeof(address.sun_path)) {
+            return false;
+        }
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, path.c_str(), path.size());
+        fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    else {
+        fd = ::open(path.c_str(), O_RDONLY);
+    }
+    if (fd < 0) {
+        return false;
+    }
+    openFd(fd);
+    ownsFd_ = true;
+    return true;
+}
+
+bool BarStream::openFd(int fd) {
+    close();
+    if (fd < 0) {
+        return false;
+    }
+    fd_ = fd;
+    ownsFd_ = false;
+    begin_ = 0;
+    end_ = 0;
+    finished_ = false;
+    barsRead_ = 0;
+    bytesRead_ = 0;
+    malformedRows_ = 0;
+    return true;
+}
+
+void BarStream::close() {
+    if (fd_ >= 0 && ownsFd_) {
+        ::close(fd_);
+    }
+    fd_ = -1;
+    ownsFd_ = false;
+}
+
+bool BarStream::refill() {
+    // keep the partial line, move it to the front
+    if (begin_ > 0) {
+        std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+        end_ -= begin_;
+        begin_ = 0;
+    }
+    if (end_ == buffer_.size()) {
+        // a line longer than the buffer, drop it
+        malformedRows_++;
+        end_ = 0;
+    }
+    while (true) {
+        ssize_t got = ::read(fd_, buffer_.data() + end_, buffer_.size() - end_);
+        if (got > 0) {
+            end_ += static_cast<size_t>(got);
+            bytesRead_ += static_cast<size_t>(got);
+            return true;
+        }
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        finished_ = true;
+        return false;
+    }
+}
+
+bool BarStream::next(Bar& bar) {
+    if (fd_ < 0) {
+        return false;
+    }
+    while (true) {
+        const char* begin = buffer_.data() + begin_;
+        const char* newline = static_cast<const char*>(std::memchr(begin, '\n', end_ - begin_));
+        if (newline == nullptr && !finished_ && refill()) {
+            continue;
+        }
+        if (newline == nullptr && begin_ == end_) {
+            return false;  // done, nothing left over
+        }
+        // a whole line, or the last one without its newline
+        const char* lineEnd = newline != nullptr ? newline : buffer_.data() + end_;
+        begin_ = newline != nullptr ? static_cast<size_t>(newline - buffer_.data()) + 1 : end_;
+        const char* rowEnd = lineEnd;
+        if (rowEnd > begin && rowEnd[-1] == '\r') {
+            rowEnd--;
+        }
+        if (MarketData::parseCsvRow(begin, rowEnd, bar)) {
+            barsRead_++;
+            return true;
+        }
+        malformedRows_++;
+    }
+}
+
+bool BarStream::isOpen() const {
+    return fd_ >= 0;
+}
+
+size_t BarStream::barsRead() const {
+    return barsRead_;
+}
+
+size_t BarStream::bytesRead() const {
+    return bytesRead_;
+}
+
+size_t BarStream::malformedRows() const {
+    return malformedRows_;
+}
@@ -0,0 +1,90 @@
+#include "mapped_file.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile() : data_(nullptr), size_(0), open_(false) {
+}
+
+MappedFile::MappedFile(const std::string& file) : data_(nullptr), size_(0), open_(false) {
+    open(file);
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept :
+    data_(other.data_), size_(other.size_), open_(other.open_) {
+    other.data_ = nullptr;
+    other.size_ = 0;
+    other.open_ = false;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        data_ = other.data_;
+        size_ = other.size_;
+        open_ = other.open_;
+        other.data_ = nullptr;
+        other.size_ = 0;
+        other.open_ = false;
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::string& file) {
+    close();
+
+    int fd = ::open(file.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    size_t length = static_cast<size_t>(info.st_size);
+    if (length > 0) {
+        void* address = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address == MAP_FAILED) {
+            ::close(fd);
+            return false;
+        }
+        // we read front to back exactly once, let the kernel read ahead
+        ::madvise(address, length, MADV_SEQUENTIAL);
+        data_ = static_cast<const char*>(address);
+    }
+
+    // the mapping stays valid after the descriptor is closed
+    ::close(fd);
+    size_ = length;
+    open_ = true;
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_ != nullptr) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+    open_ = false;
+}
+
+bool MappedFile::isOpen() const {
+    return open_;
+}
+
+const char* MappedFile::data() const {
+    return data_;
+}
+
+size_t MappedFile::size() const {
+    return size_;
+}
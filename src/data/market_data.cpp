@@ -1,57 +1,611 @@
 #include "market_data.h"
+#include "mapped_file.h"
+#include "bar_cache.h"
+#include "thread_pool.h"
+#include "profiler.h"
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+
+namespace {
+
+bool isFieldSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+// parses the number at the start of [first, last) the same way std::stod does:
+// leading whitespace is skipped and anything after the number is ignored
+bool parseField(const char* first, const char* last, double& value) {
+    while (first != last && isFieldSpace(*first)) {
+        first++;
+    }
+    if (first != last && *first == '+' && first + 1 != last && first[1] != '-' && first[1] != '+') {
+        first++;  // from_chars rejects an explicit '+', strtod does not
+    }
+    std::from_chars_result result = std::from_chars(first, last, value);
+    return result.ec == std::errc();
+}
+
+// reads exactly `count` digits
+bool readDigits(const char*& p, const char* last, int count, int& value) {
+    if (last - p < count) {
+        return false;
+    }
+    value = 0;
+    for (int i = 0; i < count; i++) {
+        if (p[i] < '0' || p[i] > '9') {
+            return false;
+        }
+        value = value * 10 + (p[i] - '0');
+    }
+    p += count;
+    return true;
+}
+
+bool readChar(const char*& p, const char* last, char expected) {
+    if (p == last || *p != expected) {
+        return false;
+    }
+    p++;
+    return true;
+}
+
+bool isLeapYear(int year) {
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+int daysInMonth(int year, int month) {
+    static const int days[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    return month == 2 && isLeapYear(year) ? 29 : days[month - 1];
+}
+
+// days since 1970-01-01 in the proleptic Gregorian calendar (H. Hinnant's days_from_civil)
+int64_t daysFromCivil(int64_t year, unsigned month, unsigned day) {
+    year -= month <= 2;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const unsigned yearOfEra = static_cast<unsigned>(year - era * 400);
+    const unsigned dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + static_cast<int64_t>(dayOfEra) - 719468;
+}
+
+// inverse of daysFromCivil
+void civilFromDays(int64_t days, int& year, int& month, int& day) {
+    days += 719468;
+    const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const unsigned dayOfEra = static_cast<unsigned>(days - era * 146097);
+    const unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    const unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    const unsigned monthIndex = (5 * dayOfYear + 2) / 153;
+    day = static_cast<int>(dayOfYear - (153 * monthIndex + 2) / 5 + 1);
+    month = static_cast<int>(monthIndex < 10 ? monthIndex + 3 : monthIndex - 9);
+    year = static_cast<int>(static_cast<int64_t>(yearOfEra) + era * 400 + (month <= 2));
+}
+
+const int64_t kNanosPerSecond = 1000000000;
+
+// "YYYY-MM-DD" or "YYYY-MM-DD HH:MM[:SS[.fffffffff]]" ('T' instead of the
+// space and a trailing 'Z' are accepted too), read as UTC epoch nanoseconds
+bool parseTimestampField(const char* first, const char* last, int64_t& nanos) {
+    while (first != last && isFieldSpace(*first)) {
+        first++;
+    }
+    while (last != first && isFieldSpace(last[-1])) {
+        last--;
+    }
+    if (last != first && last[-1] == 'Z') {
+        last--;
+    }
+
+    const char* p = first;
+    int year, month, day;
+    if (!readDigits(p, last, 4, year) || !readChar(p, last, '-') ||
+        !readDigits(p, last, 2, month) || !readChar(p, last, '-') ||
+        !readDigits(p, last, 2, day)) {
+        return false;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > daysInMonth(year, month)) {
+        return false;
+    }
+
+    int hour = 0, minute = 0, second = 0;
+    int64_t fraction = 0;
+    if (p != last) {
+        if (*p != ' ' && *p != 'T') {
+            return false;
+        }
+        p++;
+        if (!readDigits(p, last, 2, hour) || !readChar(p, last, ':') || !readDigits(p, last, 2, minute)) {
+            return false;
+        }
+        if (p != last && *p == ':') {
+            p++;
+            if (!readDigits(p, last, 2, second)) {
+                return false;
+            }
+            if (p != last && *p == '.') {
+                p++;
+                int digits = 0;
+                int64_t scale = kNanosPerSecond;
+                while (p != last && *p >= '0' && *p <= '9' && digits < 9) {
+                    scale /= 10;
+                    fraction += (*p - '0') * scale;
+                    p++;
+                    digits++;
+                }
+                if (digits == 0) {
+                    return false;
+                }
+            }
+        }
+        if (hour > 23 || minute > 59 || second > 59) {
+            return false;
+        }
+    }
+    if (p != last) {
+        return false;
+    }
+
+    int64_t seconds = daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+    nanos = seconds * kNanosPerSecond + fraction;
+    return true;
+}
+
+// splits one row on ',' without copying it, mirrors parseLine field for field
+bool parseRow(const char* p, const char* lineEnd, Bar& bar) {
+    double* fields[] = {&bar.open, &bar.high, &bar.low, &bar.close, &bar.volume};
+
+    bool moreFields = true;
+    for (int i = 0; i < 6; i++) {
+        if (!moreFields) {
+            return false;  // Not enough fields
+        }
+        const char* comma = static_cast<const char*>(std::memchr(p, ',', lineEnd - p));
+        const char* fieldEnd = comma ? comma : lineEnd;
+        bool parsed = i == 0 ? parseTimestampField(p, fieldEnd, bar.timestamp)
+                             : parseField(p, fieldEnd, *fields[i - 1]);
+        if (!parsed) {
+            return false;
+        }
+        moreFields = comma != nullptr;
+        p = moreFields ? comma + 1 : lineEnd;
+    }
+    return true;
+}
+
+// sorts bars oldest first: newest-first files (like the Alpha Vantage
+// exports in data/) are simply reversed, anything else gets a stable sort.
+// rows sharing a timestamp are kept and counted
+void normaliseOrder(std::vector<Bar>& bars, LoadStats& stats) {
+    auto byTime = [](const Bar& a, const Bar& b) { return a.timestamp < b.timestamp; };
+    auto byTimeDescending = [](const Bar& a, const Bar& b) { return a.timestamp > b.timestamp; };
+
+    stats.reordered = false;
+    if (!std::is_sorted(bars.begin(), bars.end(), byTime)) {
+        stats.reordered = true;
+        if (std::is_sorted(bars.begin(), bars.end(), byTimeDescending)) {
+            std::reverse(bars.begin(), bars.end());
+        }
+        else {
+            std::stable_sort(bars.begin(), bars.end(), byTime);
+        }
+    }
+
+    stats.duplicateTimestamps = 0;
+    for (size_t i = 1; i < bars.size(); i++) {
+        if (bars[i].timestamp == bars[i - 1].timestamp) {
+            stats.duplicateTimestamps++;
+        }
+    }
+}
+
+// guesses the row count from the first few lines so the bar vector is allocated once
+size_t estimateRows(const char* begin, const char* end) {
+    const size_t sampleLines = 64;
+    const char* p = begin;
+    size_t lines = 0;
+    while (p < end && lines < sampleLines) {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        p = newline ? newline + 1 : end;
+        lines++;
+    }
+    if (lines == 0) {
+        return 0;
+    }
+    size_t averageLength = static_cast<size_t>(p - begin) / lines;
+    if (averageLength == 0) {
+        averageLength = 1;
+    }
+    // a little slack so slightly shorter rows later on don't force a regrow
+    size_t estimate = static_cast<size_t>(end - begin) / averageLength;
+    return estimate + estimate / 16 + 1;
+}
+
+// below this the thread hand-off costs more than the parsing it saves
+const size_t kParallelLoadThreshold = 16 * 1024 * 1024;
+
+// every chunk should have enough rows that the stitching stays cheap
+const size_t kMinChunkBytes = 1024 * 1024;
+
+const char* skipHeader(const char* begin, const char* end) {
+    if (begin == end) {
+        return end;
+    }
+    const char* newline = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+    return newline ? newline + 1 : end;
+}
+
+// the double Bar fields in declaration order, the same order their columns are stored in
+const size_t kValueFieldCount = 5;
+double Bar::* const kValueFields[kValueFieldCount] = {
+    &Bar::open, &Bar::high, &Bar::low, &Bar::close, &Bar::volume
+};
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+struct MarketData::Storage {
+    Layout layout = Layout::Rows;
+    size_t rows = 0;
+    std::vector<Bar> bars;              // Layout::Rows
+    std::vector<int64_t> timestamps;    // Layout::Columns
+    std::vector<double> values;         // Layout::Columns, kValueFieldCount arrays of `rows` back to back
+    BarCache cache;                     // Layout::Columns mapped from the binary cache instead of owned
+    mutable IndicatorCache indicators;  // series derived from these bars, filled on demand
+    mutable std::atomic<bool> indicatorsUsed{false};  // indicator() since BarWindow's last push
+
+    // resampled bars (see MarketData::resample()): bucket b is the source rows
+    // [bucketEnds[b - 1], bucketEnds[b]), the first one starting at sourceBegin.
+    // Timestamps are owned, value columns are aggregated on first use
+    std::shared_ptr<const Storage> source;
+    size_t sourceBegin = 0;
+    std::vector<size_t> bucketEnds;
+    mutable std::once_flag aggregatedOnce[kValueFieldCount];
+    mutable std::vector<double> aggregated[kValueFieldCount];
+
+    // resampled storages made from these bars by (interval, begin, size),
+    // alive as long as some view uses them
+    mutable std::mutex resampleMutex;
+    mutable std::map<std::tuple<int64_t, size_t, size_t>, std::weak_ptr<const Storage>> resamples;
+
+    const int64_t* timestampData() const {
+        return cache.isOpen() ? cache.timestamps() : timestamps.data();
+    }
+
+    // field indexes kValueFields
+    const double* valueData(size_t field) const {
+        if (source) {
+            return aggregate(field);
+        }
+        return cache.isOpen() ? cache.column(field + 1) : values.data() + field * rows;
+    }
+
+    const double* aggregate(size_t field) const;
+};
+
+const double* MarketData::Storage::aggregate(size_t field) const {
+    std::call_once(aggregatedOnce[field], [this, field] {
+        if (rows == 0) {
+            return;
+        }
+        const Storage& from = *source;
+        ColumnView<double> in = from.layout == Layout::Rows
+                                    ? ColumnView<double>(&(from.bars[0].*kValueFields[field]), from.rows, sizeof(Bar))
+                                    : ColumnView<double>(from.valueData(field), from.rows);
+        std::vector<double>& out = aggregated[field];
+        out.resize(rows);
+        size_t first = sourceBegin;
+        for (size_t b = 0; b < rows; b++) {
+            size_t last = bucketEnds[b];
+            double value = in[first];
+            if (field == 1) {
+                for (size_t row = first + 1; row < last; row++) value = std::max(value, in[row]);
+            }
+            else if (field == 2) {
+                for (size_t row = first + 1; row < last; row++) value = std::min(value, in[row]);
+            }
+            else if (field == 3) {
+                value = in[last - 1];
+            }
+            else if (field == 4) {
+                for (size_t row = first + 1; row < last; row++) value += in[row];
+            }
+            out[b] = value;
+            first = last;
+        }
+    });
+    return aggregated[field].data();
+}
+
+double LoadStats::megabytesPerSecond() const {
+    if (seconds <= 0.0) {
+        return 0.0;
+    }
+    return (bytes / (1024.0 * 1024.0)) / seconds;
+}
+
+double LoadStats::rowsPerSecond() const {
+    if (seconds <= 0.0) {
+        return 0.0;
+    }
+    return rows / seconds;
+}
 
 // TODO: Implement constructors
-MarketData::MarketData(){
+MarketData::MarketData() :
+    storage_(std::make_shared<Storage>()), begin_(0), size_(0), layout_(Layout::Rows) {
     filename_ = "";
 }
 
-MarketData::MarketData(const std::string& file) {
+MarketData::MarketData(const std::string& file, Layout layout) :
+    storage_(std::make_shared<Storage>()), begin_(0), size_(0), layout_(layout) {
     filename_ = file;
-    loadFromFile(file);
+    load(file);
 };
 
+MarketData::MarketData(std::vector<Bar> bars, Layout layout) :
+    storage_(std::make_shared<Storage>()), begin_(0), size_(0), layout_(layout) {
+    filename_ = "";
+    loadStats_.rows = bars.size();
+    adoptRows(std::move(bars));
+}
+
+bool MarketData::load(const std::string& file) {
+    SourceStamp stamp;
+    if (!SourceStamp::read(file, stamp)) {
+        return false;
+    }
+    if (loadFromCache(file)) {
+        return true;
+    }
+    if (!loadFromCsv(file)) {
+        return false;
+    }
+
+    // stamped with what we saw before parsing, so an edit made while we were
+    // reading just makes the cache stale instead of wrong.
+    // a read-only data directory simply means no cache
+    BarCache::write(BarCache::sidecarPath(file), *this, stamp);
+    return true;
+}
+
+bool MarketData::loadFromCsv(const std::string& file) {
+    MappedFile probe;
+    if (!probe.open(file)) {
+        return false;
+    }
+    bool large = probe.size() >= kParallelLoadThreshold;
+    probe.close();
+
+    if (large && ThreadPool::shared().size() > 1) {
+        return loadFromFileParallel(file);
+    }
+    return loadFromFileMapped(file);
+}
+
 // TODO: Implement loadFromFile method
 bool MarketData::loadFromFile(const std::string& file) {
+    BACKTESTER_PROFILE_SCOPE(ProfileStage::Load);
+    auto start = std::chrono::steady_clock::now();
     std::ifstream inputfile(file);
     if(!inputfile) {
         return false;
     }
 
-    bars_.clear();
+    std::vector<Bar> bars;
+    loadStats_ = LoadStats();
 
     //read line by line
     std::string line;
     bool first_line = true;
 
     while(std::getline(inputfile,line)) {
+        loadStats_.bytes += line.size() + 1;
         if(first_line) {
             first_line = false;
             continue;
         }
         Bar bar;
         if (parseLine(line, bar)) {
-            bars_.push_back(bar);
+            bars.push_back(bar);
         }
         else {
+            loadStats_.malformedRows++;
             std::cerr << "Warning: Could not parse line: " << line << std::endl;
         }
     }
     inputfile.close();
+
+    loadStats_.rows = bars.size();
+    adoptRows(std::move(bars));
+    loadStats_.seconds = secondsSince(start);
     return true;
 }
 
+bool MarketData::loadFromFileMapped(const std::string& file) {
+    BACKTESTER_PROFILE_SCOPE(ProfileStage::Load);
+    auto start = std::chrono::steady_clock::now();
+    MappedFile mapped;
+    if (!mapped.open(file)) {
+        return false;
+    }
+
+    loadStats_ = LoadStats();
+    loadStats_.bytes = mapped.size();
+
+    const char* end = mapped.data() + mapped.size();
+    const char* begin = skipHeader(mapped.data(), end);
+
+    std::vector<Bar> bars;
+    bars.reserve(estimateRows(begin, end));
+    loadStats_.malformedRows = parseBuffer(begin, end, bars);
+
+    loadStats_.rows = bars.size();
+    adoptRows(std::move(bars));
+    loadStats_.seconds = secondsSince(start);
+    return true;
+}
+
+bool MarketData::loadFromFileParallel(const std::string& file, size_t chunks) {
+    BACKTESTER_PROFILE_SCOPE(ProfileStage::Load);
+    auto start = std::chrono::steady_clock::now();
+    MappedFile mapped;
+    if (!mapped.open(file)) {
+        return false;
+    }
+
+    loadStats_ = LoadStats();
+    loadStats_.bytes = mapped.size();
+
+    const char* end = mapped.data() + mapped.size();
+    const char* begin = skipHeader(mapped.data(), end);
+    size_t bytes = static_cast<size_t>(end - begin);
+
+    ThreadPool& pool = ThreadPool::shared();
+    if (chunks == 0) {
+        chunks = pool.size();
+    }
+    chunks = std::max<size_t>(1, std::min(chunks, bytes / kMinChunkBytes));
+
+    // cut points are pushed forward to just past the next '\n' so every row
+    // belongs to exactly one chunk
+    std::vector<const char*> cuts(chunks + 1);
+    cuts[0] = begin;
+    cuts[chunks] = end;
+    for (size_t i = 1; i < chunks; i++) {
+        const char* cut = std::max(begin + bytes / chunks * i, cuts[i - 1]);
+        const char* newline = static_cast<const char*>(std::memchr(cut, '\n', end - cut));
+        cuts[i] = newline ? newline + 1 : end;
+    }
+
+    std::vector<std::vector<Bar>> parts(chunks);
+    std::vector<size_t> malformed(chunks, 0);
+    pool.parallelFor(chunks, [&](size_t i) {
+        parts[i].reserve(estimateRows(cuts[i], cuts[i + 1]));
+        malformed[i] = parseBuffer(cuts[i], cuts[i + 1], parts[i]);
+    });
+
+    // stitch back in file order, each chunk copies into its own slice
+    std::vector<size_t> offsets(chunks + 1, 0);
+    for (size_t i = 0; i < chunks; i++) {
+        offsets[i + 1] = offsets[i] + parts[i].size();
+        loadStats_.malformedRows += malformed[i];
+    }
+    std::vector<Bar> bars(offsets[chunks]);
+    pool.parallelFor(chunks, [&](size_t i) {
+        std::copy(parts[i].begin(), parts[i].end(), bars.begin() + offsets[i]);
+        std::vector<Bar>().swap(parts[i]);
+    });
+
+    loadStats_.rows = bars.size();
+    adoptRows(std::move(bars));
+    loadStats_.seconds = secondsSince(start);
+    return true;
+}
+
+bool MarketData::loadFromCache(const std::string& sourceFile) {
+    BACKTESTER_PROFILE_SCOPE(ProfileStage::Load);
+    auto start = std::chrono::steady_clock::now();
+    SourceStamp stamp;
+    if (!SourceStamp::read(sourceFile, stamp)) {
+        return false;
+    }
+
+    BarCache cache;
+    if (!cache.open(BarCache::sidecarPath(sourceFile), stamp)) {
+        return false;
+    }
+
+    loadStats_ = LoadStats();
+    loadStats_.bytes = cache.fileSize();
+    loadStats_.rows = cache.size();
+
+    auto storage = std::make_shared<Storage>();
+    storage->layout = layout_;
+    storage->rows = cache.size();
+    if (layout_ == Layout::Columns) {
+        // zero copy: the columns stay in the mapping, shared through the page cache
+        storage->cache = std::move(cache);
+    }
+    else {
+        // no parsing, just gather the columns back into rows.
+        // the cache was written from normalised bars, so no sorting either
+        storage->bars.resize(storage->rows);
+        const int64_t* timestamps = cache.timestamps();
+        for (size_t i = 0; i < storage->rows; i++) {
+            storage->bars[i].timestamp = timestamps[i];
+        }
+        for (size_t field = 0; field < kValueFieldCount; field++) {
+            const double* values = cache.column(field + 1);
+            for (size_t i = 0; i < storage->rows; i++) {
+                storage->bars[i].*kValueFields[field] = values[i];
+            }
+        }
+    }
+    storage_ = storage;
+    begin_ = 0;
+    size_ = storage->rows;
+
+    loadStats_.seconds = secondsSince(start);
+    return true;
+}
+
+bool MarketData::writeCache(const std::string& sourceFile) const {
+    SourceStamp stamp;
+    if (!SourceStamp::read(sourceFile, stamp)) {
+        return false;
+    }
+    return BarCache::write(BarCache::sidecarPath(sourceFile), *this, stamp);
+}
+
+size_t MarketData::parseBuffer(const char* begin, const char* end, std::vector<Bar>& out) {
+    size_t malformed = 0;
+    const char* p = begin;
+
+    // same line splitting as std::getline: a trailing '\n' does not start an empty row
+    while (p < end) {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char* lineEnd = newline ? newline : end;
+
+        Bar bar;
+        if (parseRow(p, lineEnd, bar)) {
+            out.push_back(bar);
+        }
+        else {
+            malformed++;
+        }
+        p = newline ? newline + 1 : end;
+    }
+    return malformed;
+}
+
 bool MarketData::parseLine(const std::string& line, Bar& bar){
     std::stringstream ss(line);
     std::string token;
 
     // O(1) space: Fixed array of pointers to Bar fields
-    double* fields[] = {&bar.timestamp, &bar.open, &bar.high, &bar.low, &bar.close, &bar.volume};
+    double* fields[] = {&bar.open, &bar.high, &bar.low, &bar.close, &bar.volume};
     
     try {
-        for (int i = 0; i < 6; i++) {
+        //the timestamp is a date, not a number
+        if (!std::getline(ss, token, ',') ||
+            !parseTimestampField(token.data(), token.data() + token.size(), bar.timestamp)) {
+            return false;
+        }
+        for (int i = 0; i < 5; i++) {
             //getline till ',' is found. aka the delimiter
             if (!std::getline(ss, token, ',')) {
                 return false;  // Not enough fields
@@ -64,14 +618,321 @@ bool MarketData::parseLine(const std::string& line, Bar& bar){
     }
 }
 
+void MarketData::adoptRows(std::vector<Bar> bars) {
+    normaliseOrder(bars, loadStats_);
+
+    auto storage = std::make_shared<Storage>();
+    storage->layout = layout_;
+    storage->rows = bars.size();
+
+    if (layout_ == Layout::Rows) {
+        storage->bars = std::move(bars);
+    }
+    else {
+        storage->timestamps.resize(storage->rows);
+        storage->values.resize(kValueFieldCount * storage->rows);
+        for (size_t i = 0; i < storage->rows; i++) {
+            storage->timestamps[i] = bars[i].timestamp;
+        }
+        for (size_t field = 0; field < kValueFieldCount; field++) {
+            double* values = storage->values.data() + field * storage->rows;
+            for (size_t i = 0; i < storage->rows; i++) {
+                values[i] = bars[i].*kValueFields[field];
+            }
+        }
+    }
+    storage_ = storage;
+    begin_ = 0;
+    size_ = storage->rows;
+}
+
+bool MarketData::parseCsvRow(const char* begin, const char* end, Bar& bar) {
+    return parseRow(begin, end, bar);
+}
+
+bool MarketData::parseTimestamp(const std::string& text, int64_t& nanos) {
+    return parseTimestampField(text.data(), text.data() + text.size(), nanos);
+}
+
+std::string MarketData::formatTimestamp(int64_t nanos) {
+    int64_t seconds = nanos / kNanosPerSecond;
+    int64_t fraction = nanos % kNanosPerSecond;
+    if (fraction < 0) {
+        seconds--;
+        fraction += kNanosPerSecond;
+    }
+    int64_t days = seconds / 86400;
+    int64_t secondOfDay = seconds % 86400;
+    if (secondOfDay < 0) {
+        days--;
+        secondOfDay += 86400;
+    }
+
+    int year, month, day;
+    civilFromDays(days, year, month, day);
+
+    char text[40];
+    if (secondOfDay == 0 && fraction == 0) {
+        std::snprintf(text, sizeof(text), "%04d-%02d-%02d", year, month, day);
+    }
+    else if (fraction == 0) {
+        std::snprintf(text, sizeof(text), "%04d-%02d-%02d %02d:%02d:%02d", year, month, day,
+                      static_cast<int>(secondOfDay / 3600), static_cast<int>(secondOfDay / 60 % 60),
+                      static_cast<int>(secondOfDay % 60));
+    }
+    else {
+        std::snprintf(text, sizeof(text), "%04d-%02d-%02d %02d:%02d:%02d.%09d", year, month, day,
+                      static_cast<int>(secondOfDay / 3600), static_cast<int>(secondOfDay / 60 % 60),
+                      static_cast<int>(secondOfDay % 60), static_cast<int>(fraction));
+    }
+    return text;
+}
+
 // getters
 size_t MarketData::size() const {
-    return bars_.size();
+    return size_;
 }
 
-const Bar& MarketData::getBar(size_t index) const {
-    if (index >= bars_.size()){
+Bar MarketData::getBar(size_t index) const {
+    const Storage& storage = *storage_;
+    if (index >= size_){
         throw std::out_of_range("index out of range");
     }
-    return bars_[index];
+    size_t row = begin_ + index;
+    if (storage.layout == Layout::Rows) {
+        return storage.bars[row];
+    }
+
+    Bar bar;
+    bar.timestamp = storage.timestampData()[row];
+    for (size_t field = 0; field < kValueFieldCount; field++) {
+        bar.*kValueFields[field] = storage.valueData(field)[row];
+    }
+    return bar;
+}
+
+const LoadStats& MarketData::getLoadStats() const {
+    return loadStats_;
+}
+
+MarketData::Layout MarketData::getLayout() const {
+    return layout_;
+}
+
+void MarketData::setLayout(Layout layout) {
+    if (layout == layout_) {
+        return;
+    }
+    layout_ = layout;
+
+    // already in the requested shape, e.g. after switching back and forth
+    if (storage_->layout == layout) {
+        return;
+    }
+
+    // only the bars this view covers are converted
+    std::vector<Bar> bars(size_);
+    for (size_t i = 0; i < bars.size(); i++) {
+        bars[i] = getBar(i);
+    }
+    adoptRows(std::move(bars));
+}
+
+size_t MarketData::lowerBound(int64_t time) const {
+    ColumnView<int64_t> times = timestamp();
+    size_t low = 0;
+    size_t high = times.size();
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (times[middle] < time) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+MarketData MarketData::slice(size_t first, size_t count) const {
+    MarketData view(*this);
+    first = std::min(first, size_);
+    view.begin_ = begin_ + first;
+    view.size_ = std::min(count, size_ - first);
+    return view;
+}
+
+MarketData MarketData::sliceByTime(int64_t from, int64_t to) const {
+    size_t first = lowerBound(from);
+    size_t last = std::max(first, lowerBound(to));
+    return slice(first, last - first);
+}
+
+MarketData MarketData::resample(int64_t interval) const {
+    if (interval <= 0) {
+        throw std::invalid_argument("MarketData::resample: interval must be positive");
+    }
+    const Storage& from = *storage_;
+    std::shared_ptr<const Storage> buckets;
+    {
+        std::lock_guard<std::mutex> lock(from.resampleMutex);
+        std::weak_ptr<const Storage>& memo = from.resamples[std::make_tuple(interval, begin_, size_)];
+        buckets = memo.lock();
+        if (!buckets) {
+            // one pass over the timestamps for the bucket boundaries, the
+            // values wait until a column is read
+            auto storage = std::make_shared<Storage>();
+            storage->layout = Layout::Columns;
+            storage->source = storage_;
+            storage->sourceBegin = begin_;
+            ColumnView<int64_t> times = timestamp();
+            int64_t current = 0;
+            for (size_t i = 0; i < size_; i++) {
+                int64_t offset = times[i] - kResampleOrigin;
+                int64_t bucket = offset / interval - (offset % interval < 0 ? 1 : 0);
+                if (i == 0 || bucket != current) {
+                    if (i > 0) {
+                        storage->bucketEnds.push_back(begin_ + i);
+                    }
+                    storage->timestamps.push_back(kResampleOrigin + bucket * interval);
+                    current = bucket;
+                }
+            }
+            if (size_ > 0) {
+                storage->bucketEnds.push_back(begin_ + size_);
+            }
+            storage->rows = storage->timestamps.size();
+            buckets = storage;
+            memo = buckets;
+        }
+    }
+
+    MarketData view;
+    view.storage_ = std::move(buckets);
+    view.layout_ = Layout::Columns;
+    view.begin_ = 0;
+    view.size_ = view.storage_->rows;
+    view.filename_ = filename_;
+    return view;
+}
+
+ColumnView<double> MarketData::column(size_t field) const {
+    const Storage& storage = *storage_;
+    if (storage.layout == Layout::Rows) {
+        if (storage.bars.empty()) {
+            return ColumnView<double>();
+        }
+        ColumnView<double> all(&(storage.bars[0].*kValueFields[field]), storage.rows, sizeof(Bar));
+        return all.subview(begin_, size_);
+    }
+    return ColumnView<double>(storage.valueData(field) + begin_, size_);
+}
+
+IndicatorCache::Series MarketData::indicator(IndicatorKind kind, size_t period, Field field) const {
+    size_t fieldIndex = static_cast<size_t>(field);
+    IndicatorKey key{kind, period, fieldIndex, begin_, size_};
+    storage_->indicatorsUsed.store(true, std::memory_order_relaxed);
+    // two pointers fit std::function's inline buffer, a hit allocates nothing
+    return storage_->indicators.get(key, [this, &key] {
+        return IndicatorCache::compute(key.kind, key.period, column(key.field));
+    });
+}
+
+IndicatorCache& MarketData::indicatorCache() const {
+    return storage_->indicators;
+}
+
+ColumnView<int64_t> MarketData::timestamp() const {
+    const Storage& storage = *storage_;
+    if (storage.layout == Layout::Rows) {
+        if (storage.bars.empty()) {
+            return ColumnView<int64_t>();
+        }
+        ColumnView<int64_t> all(&storage.bars[0].timestamp, storage.rows, sizeof(Bar));
+        return all.subview(begin_, size_);
+    }
+    return ColumnView<int64_t>(storage.timestampData() + begin_, size_);
+}
+
+ColumnView<double> MarketData::open() const { return column(0); }
+ColumnView<double> MarketData::high() const { return column(1); }
+ColumnView<double> MarketData::low() const { return column(2); }
+ColumnView<double> MarketData::close() const { return column(3); }
+ColumnView<double> MarketData::volume() const { return column(4); }
+
+// ---------------- BarWindow ----------------
+
+BarWindow::BarWindow(size_t lookback, size_t capacity) :
+    view_(), storage_(nullptr), timestamps_(nullptr), values_(),
+    lookback_(std::max<size_t>(lookback, 1)), next_(0), pushed_(0), compactions_(0) {
+    if (capacity == 0) {
+        capacity = std::max(kMinCapacity, 8 * lookback_);
+    }
+    // a move has to leave room for at least one new bar
+    capacity = std::max(capacity, lookback_ + 1);
+
+    auto storage = std::make_shared<MarketData::Storage>();
+    storage->layout = MarketData::Layout::Columns;
+    storage->rows = capacity;
+    storage->timestamps.assign(capacity, 0);
+    storage->values.assign(kValueFieldCount * capacity, 0.0);
+
+    storage_ = storage.get();
+    timestamps_ = storage->timestamps.data();
+    for (size_t field = 0; field < kValueFieldCount; field++) {
+        values_[field] = storage->values.data() + field * capacity;
+    }
+
+    view_.storage_ = std::move(storage);
+    view_.layout_ = MarketData::Layout::Columns;
+    view_.begin_ = 0;
+    view_.size_ = capacity;
+}
+
+size_t BarWindow::push(const Bar& bar) {
+    size_t capacity = storage_->rows;
+    if (next_ == capacity) {
+        // keep the newest lookback - 1 bars, the new one completes the window
+        size_t keep = lookback_ - 1;
+        size_t from = capacity - keep;
+        std::memmove(timestamps_, timestamps_ + from, keep * sizeof(int64_t));
+        for (size_t field = 0; field < kValueFieldCount; field++) {
+            std::memmove(values_[field], values_[field] + from, keep * sizeof(double));
+        }
+        next_ = keep;
+        compactions_++;
+    }
+
+    timestamps_[next_] = bar.timestamp;
+    for (size_t field = 0; field < kValueFieldCount; field++) {
+        values_[field][next_] = bar.*kValueFields[field];
+    }
+    // cached series are keyed by the view, which every push changes. The
+    // flag saves a locked clear() per bar when nothing was cached
+    if (storage_->indicatorsUsed.load(std::memory_order_relaxed)) {
+        storage_->indicators.clear();
+        storage_->indicatorsUsed.store(false, std::memory_order_relaxed);
+    }
+    pushed_++;
+    return next_++;
+}
+
+const MarketData& BarWindow::view() const {
+    return view_;
+}
+
+size_t BarWindow::lookback() const {
+    return lookback_;
+}
+
+size_t BarWindow::capacity() const {
+    return storage_->rows;
+}
+
+size_t BarWindow::pushed() const {
+    return pushed_;
+}
+
+size_t BarWindow::compactions() const {
+    return compactions_;
 }
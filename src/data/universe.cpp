@@ -0,0 +1,174 @@
+#include "universe.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const std::string kPrefix = "daily_";
+const std::string kSuffix = ".csv";
+
+bool startsWith(const std::string& text, const std::string& prefix) {
+    return text.size() >= prefix.size() && text.compare(0, prefix.size(), prefix) == 0;
+}
+
+bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+std::string trim(const std::string& text) {
+    size_t first = text.find_first_not_of(" \t\r");
+    if (first == std::string::npos) {
+        return "";
+    }
+    size_t last = text.find_last_not_of(" \t\r");
+    return text.substr(first, last - first + 1);
+}
+
+SymbolInfo makeSymbol(const std::string& file) {
+    SymbolInfo info;
+    info.symbol = Universe::symbolFromPath(file);
+    info.file = file;
+    return info;
+}
+
+}
+
+Universe::Universe() {
+}
+
+bool Universe::loadDirectory(const std::string& dir) {
+    std::vector<SymbolInfo> symbols;
+    std::error_code error;
+    for (fs::directory_iterator it(dir, error), end; !error && it != end; it.increment(error)) {
+        std::string name = it->path().filename().string();
+        if (startsWith(name, kPrefix) && endsWith(name, kSuffix) && name.size() > kPrefix.size() + kSuffix.size()) {
+            symbols.push_back(makeSymbol(it->path().string()));
+        }
+    }
+    return adopt(std::move(symbols));
+}
+
+bool Universe::loadManifest(const std::string& manifest) {
+    std::ifstream in(manifest);
+    if (!in) {
+        symbols_.clear();
+        return false;
+    }
+    fs::path base = fs::path(manifest).parent_path();
+
+    std::vector<SymbolInfo> symbols;
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) {
+            line.erase(comment);
+        }
+        line = trim(line);
+        if (line.empty()) {
+            continue;
+        }
+        if (line.find('/') != std::string::npos || endsWith(line, kSuffix)) {
+            fs::path file(line);
+            symbols.push_back(makeSymbol(file.is_absolute() ? file.string() : (base / file).string()));
+        }
+        else {
+            SymbolInfo info;
+            info.symbol = line;
+            info.file = (base / (kPrefix + line + kSuffix)).string();
+            symbols.push_back(info);
+        }
+    }
+    return adopt(std::move(symbols));
+}
+
+bool Universe::loadFiles(const std::vector<std::string>& files) {
+    std::vector<SymbolInfo> symbols;
+    for (const std::string& file : files) {
+        symbols.push_back(makeSymbol(file));
+    }
+    return adopt(std::move(symbols));
+}
+
+bool Universe::adopt(std::vector<SymbolInfo> symbols) {
+    // file sizes double as the existence check
+    std::vector<SymbolInfo> found;
+    for (SymbolInfo& info : symbols) {
+        std::error_code error;
+        uintmax_t bytes = fs::file_size(info.file, error);
+        if (!error) {
+            info.bytes = static_cast<uint64_t>(bytes);
+            found.push_back(std::move(info));
+        }
+    }
+
+    std::stable_sort(found.begin(), found.end(), [](const SymbolInfo& a, const SymbolInfo& b) {
+        return a.symbol < b.symbol;
+    });
+    // the first mention of a symbol wins
+    found.erase(std::unique(found.begin(), found.end(), [](const SymbolInfo& a, const SymbolInfo& b) {
+        return a.symbol == b.symbol;
+    }), found.end());
+
+    for (size_t i = 0; i < found.size(); i++) {
+        found[i].id = static_cast<uint32_t>(i);
+    }
+    symbols_ = std::move(found);
+    return !symbols_.empty();
+}
+
+size_t Universe::size() const {
+    return symbols_.size();
+}
+
+bool Universe::empty() const {
+    return symbols_.empty();
+}
+
+const SymbolInfo& Universe::operator[](uint32_t id) const {
+    if (id >= symbols_.size()) {
+        throw std::out_of_range("symbol id out of range");
+    }
+    return symbols_[id];
+}
+
+const std::vector<SymbolInfo>& Universe::symbols() const {
+    return symbols_;
+}
+
+uint64_t Universe::totalBytes() const {
+    uint64_t total = 0;
+    for (const SymbolInfo& info : symbols_) {
+        total += info.bytes;
+    }
+    return total;
+}
+
+uint32_t Universe::find(const std::string& symbol) const {
+    auto it = std::lower_bound(symbols_.begin(), symbols_.end(), symbol,
+                               [](const SymbolInfo& info, const std::string& name) { return info.symbol < name; });
+    return it != symbols_.end() && it->symbol == symbol ? it->id : UINT32_MAX;
+}
+
+std::vector<uint32_t> Universe::largestFirst() const {
+    std::vector<uint32_t> order(symbols_.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = static_cast<uint32_t>(i);
+    }
+    std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+        return symbols_[a].bytes > symbols_[b].bytes;
+    });
+    return order;
+}
+
+std::string Universe::symbolFromPath(const std::string& file) {
+    std::string name = fs::path(file).filename().string();
+    if (startsWith(name, kPrefix) && endsWith(name, kSuffix) && name.size() > kPrefix.size() + kSuffix.size()) {
+        return name.substr(kPrefix.size(), name.size() - kPrefix.size() - kSuffix.size());
+    }
+    return fs::path(file).stem().string();
+}
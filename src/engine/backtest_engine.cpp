@@ -0,0 +1,216 @@
+#include "backtest_engine.h"
+#include "profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+BacktestEngine::BacktestEngine(const MarketData& data) :
+    data_(&data), tradeLog_(false), equityCurve_(false), bars_(data.size()),
+    lastClose_(data.size() > 0 ? data.close()[data.size() - 1] : 0.0), lastRunSeconds_(0.0), lastWindowBytes_(0) {
+}
+
+BacktestEngine::BacktestEngine() :
+    data_(nullptr), tradeLog_(false), equityCurve_(false), bars_(0), lastClose_(0.0), lastRunSeconds_(0.0), lastWindowBytes_(0) {
+}
+
+size_t BacktestEngine::addStrategy(const std::string& name, std::unique_ptr<Strategy> strategy, Portfolio portfolio) {
+    slots_.push_back(Slot{name, std::move(strategy), std::move(portfolio), StrategyStats(), PerformanceTracker(),
+                          Signal::Hold, {}});
+    return slots_.size() - 1;
+}
+
+void BacktestEngine::run(Mode mode) {
+    if (data_ == nullptr) {
+        throw std::logic_error("BacktestEngine::run: no data, use runStreaming()");
+    }
+    const MarketData& data = *data_;
+    BACKTESTER_PROFILE_SCOPE(ProfileStage::Run);
+    auto start = std::chrono::steady_clock::now();
+    for (Slot& slot : slots_) {
+        resetSlot(slot);
+    }
+
+    size_t bars = data.size();
+    ColumnView<double> close = data.close();
+
+    if (mode == Mode::Batch) {
+        for (Slot& slot : slots_) {
+            BACKTESTER_PROFILE_SCOPE(ProfileStage::Analyze);
+            slot.signals = slot.strategy->analyzeAll(data);
+        }
+        BACKTESTER_PROFILE_SCOPE(ProfileStage::Execute);
+        for (size_t i = 0; i < bars; i++) {
+            double price = close[i];
+            for (Slot& slot : slots_) {
+                record(slot, slot.signals[i], price, i);
+            }
+        }
+        for (Slot& slot : slots_) {
+            std::vector<Signal>().swap(slot.signals);
+        }
+    }
+    else {
+        ProfileLoop profile(slots_.size());
+        for (size_t i = 0; i < bars; i++) {
+            double price = close[i];
+            if (profile.sampled(i)) {
+                stepProfiled(profile, data, i, price, i);
+                continue;
+            }
+            for (Slot& slot : slots_) {
+                record(slot, slot.strategy->analyze(data, i), price, i);
+            }
+        }
+    }
+
+    bars_ = bars;
+    lastClose_ = bars > 0 ? close[bars - 1] : 0.0;
+    lastRunSeconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void BacktestEngine::runStreaming(BarSource& source, size_t windowCapacity) {
+    BACKTESTER_PROFILE_SCOPE(ProfileStage::Run);
+    auto start = std::chrono::steady_clock::now();
+    size_t lookback = 1;
+    for (Slot& slot : slots_) {
+        if (slot.strategy->lookback() == 0) {
+            throw std::logic_error("BacktestEngine::runStreaming: " + slot.name + " declares no lookback()");
+        }
+        lookback = std::max(lookback, slot.strategy->lookback());
+        resetSlot(slot);
+    }
+
+    BarWindow window(lookback, windowCapacity);
+    const MarketData& view = window.view();
+    ProfileLoop profile(slots_.size());
+
+    // bars come out of the source a block at a time
+    std::vector<Bar> block(4096);
+    size_t index = 0;
+    double close = 0.0;
+    for (size_t count; (count = source.read(block.data(), block.size())) > 0; ) {
+        for (size_t b = 0; b < count; b++, index++) {
+            size_t slotIndex = window.push(block[b]);
+            close = block[b].close;
+            if (profile.sampled(index)) {
+                stepProfiled(profile, view, slotIndex, close, index);
+                continue;
+            }
+            for (Slot& slot : slots_) {
+                record(slot, slot.strategy->analyze(view, slotIndex), close, index);
+            }
+        }
+    }
+
+    bars_ = index;
+    lastClose_ = close;
+    lastWindowBytes_ = window.capacity() * sizeof(Bar);
+    lastRunSeconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void BacktestEngine::stepProfiled(ProfileLoop& profile, const MarketData& data, size_t dataIndex, double price,
+                                  size_t index) {
+    for (Slot& slot : slots_) {
+        uint64_t begin = Profiler::now();
+        Signal signal = slot.strategy->analyze(data, dataIndex);
+        uint64_t analyzed = Profiler::now();
+        record(slot, signal, price, index);
+        profile.add(ProfileStage::Analyze, analyzed - begin);
+        profile.add(ProfileStage::Execute, Profiler::now() - analyzed);
+    }
+}
+
+void BacktestEngine::record(Slot& slot, Signal signal, double price, size_t index) {
+    StrategyStats& stats = slot.stats;
+    if (signal == Signal::Buy) stats.buySignals++;
+    else if (signal == Signal::Sell) stats.sellSignals++;
+    else stats.holdSignals++;
+
+    if (index > 0 && signal != slot.lastSignal && signal != Signal::Hold) {
+        stats.signalChanges++;
+        if (tradeLog_) {
+            std::cout << slot.name << " TRADE " << stats.signalChanges << " - Day " << index << ": "
+                      << signalToString(signal) << " at $" << price << std::endl;
+        }
+    }
+    slot.lastSignal = signal;
+
+    if (signal != Signal::Hold) {
+        slot.portfolio.executeSignal(signal, price, index);
+    }
+    slot.performance.update(slot.portfolio.getTotalValue(price), slot.portfolio.getShares() > 0);
+}
+
+void BacktestEngine::resetSlot(Slot& slot) {
+    slot.stats = StrategyStats();
+    slot.lastSignal = Signal::Hold;
+    slot.performance.setRecordCurve(equityCurve_);
+    slot.performance.reset();
+}
+
+void BacktestEngine::setTradeLog(bool enabled) {
+    tradeLog_ = enabled;
+}
+
+void BacktestEngine::setEquityCurve(bool enabled) {
+    equityCurve_ = enabled;
+}
+
+void BacktestEngine::printSummary(size_t slot) const {
+    const Slot& entry = slots_.at(slot);
+    std::cout << "\n=== " << entry.name << " ===" << std::endl;
+    std::cout << "Total Days Analyzed: " << bars_ << std::endl;
+    std::cout << "Total Trades: " << entry.stats.signalChanges << std::endl;
+    std::cout << "BUY signals: " << entry.stats.buySignals << std::endl;
+    std::cout << "SELL signals: " << entry.stats.sellSignals << std::endl;
+    std::cout << "HOLD signals: " << entry.stats.holdSignals << std::endl;
+
+    if (bars_ > 0) {
+        entry.portfolio.printSummary(lastClose_);
+        entry.performance.printSummary();
+    }
+}
+
+size_t BacktestEngine::size() const {
+    return slots_.size();
+}
+
+const std::string& BacktestEngine::getName(size_t slot) const {
+    return slots_.at(slot).name;
+}
+
+Strategy& BacktestEngine::getStrategy(size_t slot) {
+    return *slots_.at(slot).strategy;
+}
+
+const Portfolio& BacktestEngine::getPortfolio(size_t slot) const {
+    return slots_.at(slot).portfolio;
+}
+
+const StrategyStats& BacktestEngine::getStats(size_t slot) const {
+    return slots_.at(slot).stats;
+}
+
+const PerformanceTracker& BacktestEngine::getPerformance(size_t slot) const {
+    return slots_.at(slot).performance;
+}
+
+double BacktestEngine::getReturn(size_t slot) const {
+    if (bars_ == 0) {
+        return 0.0;
+    }
+    return slots_.at(slot).portfolio.getReturn(lastClose_);
+}
+
+size_t BacktestEngine::barsProcessed() const {
+    return bars_;
+}
+
+double BacktestEngine::lastRunSeconds() const {
+    return lastRunSeconds_;
+}
+
+size_t BacktestEngine::lastWindowBytes() const {
+    return lastWindowBytes_;
+}
@@ -0,0 +1,351 @@
+#include "monte_carlo.h"
+#include "portfolio.h"
+#include "signal_kernels.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+struct PathOutcome {
+    double returnPercent;
+    double maxDrawdown;
+};
+
+// trades the signals at the close like ParameterSweep does and follows the
+// peak for the drawdown, without a PerformanceTracker's other metrics
+PathOutcome tradePath(const double* close, const Signal* signals, size_t count, Portfolio& portfolio) {
+    double cash = portfolio.getCash();
+    int shares = portfolio.getShares();
+    double peak = cash;
+    double maxDrawdown = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        if (signals[i] != Signal::Hold) {
+            portfolio.executeSignal(signals[i], close[i], i);
+            cash = portfolio.getCash();
+            shares = portfolio.getShares();
+        }
+        double equity = cash + shares * close[i];
+        peak = std::max(peak, equity);
+        double fall = peak - equity;
+        if (fall > maxDrawdown * peak) {
+            maxDrawdown = fall / peak;
+        }
+    }
+    return {portfolio.getReturn(close[count - 1]), maxDrawdown * 100.0};
+}
+
+// the realised P&L of every sell, at the average cost of the shares held
+std::vector<double> realisedPnl(const TradeLedger& trades) {
+    std::vector<double> pnl;
+    int held = 0;
+    double cost = 0.0;
+    for (size_t i = 0; i < trades.size(); i++) {
+        int quantity = trades.quantities()[i];
+        double price = toDollars(trades.prices()[i]);
+        if (trades.types()[i] == Signal::Buy) {
+            cost += quantity * price;
+            held += quantity;
+        }
+        else if (trades.types()[i] == Signal::Sell && held > 0) {
+            double average = cost / held;
+            pnl.push_back(quantity * (price - average));
+            cost -= quantity * average;
+            held -= quantity;
+        }
+    }
+    return pnl;
+}
+
+// max drawdown in percent of startingCash plus the P&Ls in `order`
+double pnlDrawdown(double startingCash, const double* pnl, const size_t* order, size_t count) {
+    double equity = startingCash;
+    double peak = equity;
+    double maxDrawdown = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        equity += pnl[order[i]];
+        peak = std::max(peak, equity);
+        if (peak > 0.0) {
+            maxDrawdown = std::max(maxDrawdown, (peak - equity) / peak);
+        }
+    }
+    return maxDrawdown * 100.0;
+}
+
+}
+
+double PathRandom::normal() {
+    if (hasSpare_) {
+        hasSpare_ = false;
+        return spare_;
+    }
+    // 1 - uniform() is in (0, 1], so the log is finite
+    double radius = std::sqrt(-2.0 * std::log(1.0 - uniform()));
+    double angle = 6.283185307179586 * uniform();
+    spare_ = radius * std::sin(angle);
+    hasSpare_ = true;
+    return radius * std::cos(angle);
+}
+
+double MonteCarloResult::pathsPerSecond() const {
+    return seconds > 0.0 ? paths / seconds : 0.0;
+}
+
+MonteCarlo::MonteCarlo(double startingCash, ThreadPool& pool) :
+    startingCash_(startingCash), pool_(pool), seed_(42), confidence_(0.95), batchSize_(64) {
+    scratch_.reserve(pool_.size() + 1);
+    for (size_t thread = 0; thread <= pool_.size(); thread++) {
+        scratch_.push_back(Scratch{{}, {}, {}, Portfolio(startingCash_)});
+    }
+}
+
+void MonteCarlo::setSeed(uint64_t seed) {
+    seed_ = seed;
+}
+
+void MonteCarlo::setConfidence(double confidence) {
+    if (!(confidence > 0.0 && confidence < 1.0)) {
+        throw std::invalid_argument("confidence must be in (0, 1)");
+    }
+    confidence_ = confidence;
+}
+
+void MonteCarlo::setBatchSize(size_t paths) {
+    batchSize_ = std::max<size_t>(paths, 1);
+}
+
+MonteCarlo::PathStrategy MonteCarlo::sma(int shortPeriod, int longPeriod) {
+    return [shortPeriod, longPeriod](const double* close, size_t count, Signal* out) {
+        SignalKernels::smaCrossover(close, count, shortPeriod, longPeriod, 0, out);
+    };
+}
+
+MonteCarlo::PathStrategy MonteCarlo::rsi(int period, double oversold, double overbought) {
+    return [period, oversold, overbought](const double* close, size_t count, Signal* out) {
+        SignalKernels::rsiThreshold(close, count, period, oversold, overbought, 0, out);
+    };
+}
+
+GBMParams MonteCarlo::fitGBM(const MarketData& data) {
+    GBMParams params;
+    ColumnView<double> close = data.close();
+    if (data.size() == 0) {
+        return params;
+    }
+    params.start = close[0];
+    // Welford over the log returns
+    size_t count = 0;
+    double mean = 0.0;
+    double m2 = 0.0;
+    for (size_t i = 1; i < data.size(); i++) {
+        double r = std::log(close[i] / close[i - 1]);
+        count++;
+        double delta = r - mean;
+        mean += delta / count;
+        m2 += delta * (r - mean);
+    }
+    params.volatility = count > 1 ? std::sqrt(m2 / (count - 1)) : 0.0;
+    params.drift = mean + 0.5 * params.volatility * params.volatility;
+    return params;
+}
+
+ConfidenceInterval MonteCarlo::interval(std::vector<double> values, double confidence) {
+    ConfidenceInterval result;
+    if (values.empty()) {
+        return result;
+    }
+    // nearest rank on the sorted values
+    auto at = [&values](double q) {
+        size_t rank = static_cast<size_t>(q * (values.size() - 1) + 0.5);
+        std::nth_element(values.begin(), values.begin() + rank, values.end());
+        return values[rank];
+    };
+    result.low = at((1.0 - confidence) / 2.0);
+    result.median = at(0.5);
+    result.high = at((1.0 + confidence) / 2.0);
+    return result;
+}
+
+MonteCarloResult MonteCarlo::bootstrap(const MarketData& data, const PathStrategy& strategy, size_t paths,
+                                       size_t blockBars) const {
+    size_t bars = data.size();
+    if (bars < 2) {
+        throw std::invalid_argument("bootstrap needs at least two bars");
+    }
+    std::vector<double> closes(bars);
+    std::vector<double> growth(bars - 1);
+    ColumnView<double> close = data.close();
+    for (size_t i = 0; i < bars; i++) {
+        closes[i] = close[i];
+    }
+    for (size_t i = 1; i < bars; i++) {
+        growth[i - 1] = closes[i] / closes[i - 1];
+    }
+    size_t block = std::min(std::max<size_t>(blockBars, 1), growth.size());
+
+    MonteCarloResult result = runPaths(paths, bars, strategy, [&](PathRandom& random, double* out) {
+        out[0] = closes[0];
+        size_t i = 1;
+        while (i < bars) {
+            // circular blocks, so bars near the end are drawn as often as any other
+            size_t from = random.below(growth.size());
+            size_t take = std::min(block, bars - i);
+            for (size_t j = 0; j < take; j++) {
+                size_t k = from + j < growth.size() ? from + j : from + j - growth.size();
+                out[i] = out[i - 1] * growth[k];
+                i++;
+            }
+        }
+    });
+
+    std::vector<Signal> signals(bars);
+    strategy(closes.data(), bars, signals.data());
+    Portfolio portfolio(startingCash_);
+    PathOutcome actual = tradePath(closes.data(), signals.data(), bars, portfolio);
+    result.hasActual = true;
+    result.actualReturn = actual.returnPercent;
+    result.actualDrawdown = actual.maxDrawdown;
+    finish(result);
+    return result;
+}
+
+MonteCarloResult MonteCarlo::gbm(const GBMParams& params, size_t bars, const PathStrategy& strategy,
+                                 size_t paths) const {
+    if (bars < 2) {
+        throw std::invalid_argument("gbm needs at least two bars");
+    }
+    double step = params.drift - 0.5 * params.volatility * params.volatility;
+    MonteCarloResult result = runPaths(paths, bars, strategy, [&](PathRandom& random, double* out) {
+        out[0] = params.start;
+        for (size_t i = 1; i < bars; i++) {
+            out[i] = out[i - 1] * std::exp(step + params.volatility * random.normal());
+        }
+    });
+    // no real series to compare with
+    finish(result);
+    return result;
+}
+
+MonteCarloResult MonteCarlo::shuffleTrades(const TradeLedger& trades, double startingCash, size_t paths) const {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<double> pnl = realisedPnl(trades);
+    size_t count = pnl.size();
+
+    MonteCarloResult result;
+    result.paths = paths;
+    result.hasReturns = false;
+    result.drawdowns.resize(paths);
+    double total = 0.0;
+    for (double value : pnl) {
+        total += value;
+    }
+    result.hasActual = true;
+    result.actualReturn = total / startingCash * 100.0;
+    std::vector<size_t> identity(count);
+    for (size_t i = 0; i < count; i++) {
+        identity[i] = i;
+    }
+    result.actualDrawdown = pnlDrawdown(startingCash, pnl.data(), identity.data(), count);
+
+    size_t batches = (paths + batchSize_ - 1) / batchSize_;
+    pool_.parallelFor(batches, [&](size_t batch) {
+        std::vector<size_t>& order = scratch_[pool_.workerIndex()].order;
+        size_t first = batch * batchSize_;
+        size_t last = std::min(first + batchSize_, paths);
+        for (size_t path = first; path < last; path++) {
+            // Fisher-Yates from the identity, so the order only depends on the path
+            order.assign(identity.begin(), identity.end());
+            PathRandom random(seed_, path);
+            for (size_t i = count; i > 1; i--) {
+                std::swap(order[i - 1], order[random.below(i)]);
+            }
+            result.drawdowns[path] = pnlDrawdown(startingCash, pnl.data(), order.data(), count);
+        }
+    });
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    finish(result);
+    return result;
+}
+
+MonteCarloResult MonteCarlo::runPaths(size_t paths, size_t bars, const PathStrategy& strategy,
+                                      const std::function<void(PathRandom&, double*)>& generate) const {
+    auto start = std::chrono::steady_clock::now();
+    MonteCarloResult result;
+    result.paths = paths;
+    result.returns.resize(paths);
+    result.drawdowns.resize(paths);
+
+    size_t batches = (paths + batchSize_ - 1) / batchSize_;
+    pool_.parallelFor(batches, [&](size_t batch) {
+        Scratch& scratch = scratch_[pool_.workerIndex()];
+        std::vector<double>& close = scratch.close;
+        std::vector<Signal>& signals = scratch.signals;
+        Portfolio& portfolio = scratch.portfolio;
+        close.resize(bars);
+        signals.resize(bars);
+
+        size_t first = batch * batchSize_;
+        size_t last = std::min(first + batchSize_, paths);
+        for (size_t path = first; path < last; path++) {
+            PathRandom random(seed_, path);
+            generate(random, close.data());
+            strategy(close.data(), bars, signals.data());
+            portfolio.reset(startingCash_);
+            PathOutcome outcome = tradePath(close.data(), signals.data(), bars, portfolio);
+            result.returns[path] = outcome.returnPercent;
+            result.drawdowns[path] = outcome.maxDrawdown;
+        }
+    });
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+void MonteCarlo::finish(MonteCarloResult& result) const {
+    result.confidence = confidence_;
+    result.returnInterval = interval(result.returns, confidence_);
+    result.drawdownInterval = interval(result.drawdowns, confidence_);
+    if (!result.hasActual || result.paths == 0) {
+        return;
+    }
+    size_t lowerReturns = 0;
+    size_t smallerDrawdowns = 0;
+    for (size_t i = 0; i < result.paths; i++) {
+        if (result.hasReturns) {
+            lowerReturns += result.returns[i] < result.actualReturn;
+        }
+        smallerDrawdowns += result.drawdowns[i] < result.actualDrawdown;
+    }
+    result.returnRank = static_cast<double>(lowerReturns) / result.paths;
+    result.drawdownRank = static_cast<double>(smallerDrawdowns) / result.paths;
+}
+
+void MonteCarlo::printSummary(const char* name, const MonteCarloResult& result) {
+    std::ios::fmtflags flags = std::cout.flags();
+    std::streamsize precision = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << name << ": " << result.paths << " paths, the middle " << std::setprecision(0)
+              << result.confidence * 100.0 << std::setprecision(2) << "%";
+    if (result.hasReturns) {
+        std::cout << " return " << result.returnInterval.low << "% to " << result.returnInterval.high
+                  << "% (median " << result.returnInterval.median << "%),";
+    }
+    std::cout << " max drawdown " << result.drawdownInterval.low << "% to " << result.drawdownInterval.high << "%"
+              << std::endl;
+    if (result.hasActual && result.hasReturns) {
+        std::cout << "  actual: " << result.actualReturn << "%, above " << result.returnRank * 100.0
+                  << "% of paths; max drawdown " << result.actualDrawdown << "%, above "
+                  << result.drawdownRank * 100.0 << "% of paths" << std::endl;
+    }
+    else if (result.hasActual) {
+        std::cout << "  realised: " << result.actualReturn << "% (open position not counted); max drawdown "
+                  << result.actualDrawdown << "%, above " << result.drawdownRank * 100.0 << "% of paths"
+                  << std::endl;
+    }
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+}
@@ -0,0 +1,260 @@
+#include "parameter_sweep.h"
+#include "portfolio.h"
+#include "profiler.h"
+#include "rsi_strategy.h"
+#include "sma_crossover_strategy.h"
+#include "top_k.h"
+#include <algorithm>
+#include <chrono>
+
+ParameterSweep::ParameterSweep(const MarketData& data, double startingCash, ThreadPool& pool) :
+    data_(data), startingCash_(startingCash), pool_(pool), lastCombinations_(0), lastSeconds_(0.0),
+    sink_(nullptr), trackPerformance_(true) {
+    scratch_.reserve(pool_.size() + 1);
+    for (size_t thread = 0; thread <= pool_.size(); thread++) {
+        scratch_.push_back(Scratch{{}, Portfolio(startingCash_)});
+    }
+}
+
+std::vector<SweepResult> ParameterSweep::runSMA(const std::vector<SMAParams>& grid) {
+    // the concrete strategy on the stack: no factory, nothing allocated per combination
+    return runEach(grid.size(), [this, &grid](size_t i) {
+        SMACrossoverStrategy strategy(grid[i].shortPeriod, grid[i].longPeriod);
+        return evaluate(strategy);
+    });
+}
+
+std::vector<SweepResult> ParameterSweep::runRSI(const std::vector<RSIParams>& grid) {
+    return runEach(grid.size(), [this, &grid](size_t i) {
+        RSIStrategy strategy(grid[i].period, grid[i].oversold, grid[i].overbought);
+        return evaluate(strategy);
+    });
+}
+
+std::vector<SweepResult> ParameterSweep::runSMATopK(const std::vector<SMAParams>& grid, size_t k,
+                                                     SweepMetric metric, ResultWriter* store) {
+    return runTopKEach(grid.size(), [this, &grid](size_t i) {
+        SMACrossoverStrategy strategy(grid[i].shortPeriod, grid[i].longPeriod);
+        return evaluate(strategy);
+    }, k, metric, store);
+}
+
+std::vector<SweepResult> ParameterSweep::runRSITopK(const std::vector<RSIParams>& grid, size_t k,
+                                                     SweepMetric metric, ResultWriter* store) {
+    return runTopKEach(grid.size(), [this, &grid](size_t i) {
+        RSIStrategy strategy(grid[i].period, grid[i].oversold, grid[i].overbought);
+        return evaluate(strategy);
+    }, k, metric, store);
+}
+
+std::vector<SweepResult> ParameterSweep::run(size_t combinations, const StrategyFactory& make) {
+    return runEach(combinations, [this, &make](size_t i) { return evaluate(*make(i)); });
+}
+
+std::vector<SweepResult> ParameterSweep::runTopK(size_t combinations, const StrategyFactory& make, size_t k,
+                                                 SweepMetric metric, ResultWriter* store) {
+    return runTopKEach(combinations, [this, &make](size_t i) { return evaluate(*make(i)); }, k, metric, store);
+}
+
+template <typename Evaluate>
+std::vector<SweepResult> ParameterSweep::runEach(size_t combinations, const Evaluate& evaluateOne) {
+    auto start = std::chrono::steady_clock::now();
+
+    // each task writes only its own slot
+    std::vector<SweepResult> results(combinations);
+    pool_.parallelFor(combinations, [&](size_t i) {
+        results[i] = evaluateOne(i);
+        results[i].combination = i;
+    });
+
+    lastCombinations_ = combinations;
+    lastSeconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return results;
+}
+
+template <typename Evaluate>
+std::vector<SweepResult> ParameterSweep::runTopKEach(size_t combinations, const Evaluate& evaluateOne, size_t k,
+                                                     SweepMetric metric, ResultWriter* store) {
+    auto start = std::chrono::steady_clock::now();
+
+    auto ranks = [metric](const SweepResult& a, const SweepResult& b) { return better(a, b, metric); };
+    using Heap = TopK<SweepResult, decltype(ranks)>;
+    // one heap and one store buffer per pool thread, plus one for the caller
+    const size_t kStoreBlock = 1024;
+    size_t threads = pool_.size() + 1;
+    std::vector<Heap> heaps(threads, Heap(k, ranks));
+    std::vector<std::vector<StoredResult>> pending(threads);
+
+    pool_.parallelFor(combinations, [&](size_t i) {
+        SweepResult result = evaluateOne(i);
+        result.combination = i;
+
+        size_t thread = pool_.workerIndex();
+        heaps[thread].push(result);
+        if (store != nullptr) {
+            std::vector<StoredResult>& buffer = pending[thread];
+            buffer.push_back(toStored(result));
+            if (buffer.size() == kStoreBlock) {
+                store->append(buffer.data(), buffer.size());
+                buffer.clear();
+            }
+        }
+    });
+
+    Heap merged(k, ranks);
+    for (size_t thread = 0; thread < threads; thread++) {
+        merged.merge(heaps[thread]);
+        if (store != nullptr && !pending[thread].empty()) {
+            store->append(pending[thread].data(), pending[thread].size());
+        }
+    }
+
+    lastCombinations_ = combinations;
+    lastSeconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return merged.sorted();
+}
+
+SweepResult ParameterSweep::evaluate(Strategy& strategy) const {
+    BACKTESTER_PROFILE_SCOPE(ProfileStage::Run);
+    SweepResult result;
+    size_t bars = data_.size();
+    if (bars == 0) {
+        result.finalValue = startingCash_;
+        return result;
+    }
+
+    Scratch& scratch = scratch_[pool_.workerIndex()];
+    std::vector<Signal>& signals = scratch.signals;
+    signals.resize(bars);
+    {
+        BACKTESTER_PROFILE_SCOPE(ProfileStage::Analyze);
+        strategy.analyzeRange(data_, 0, bars, signals.data());
+    }
+
+    Portfolio& portfolio = scratch.portfolio;
+    portfolio.reset(startingCash_);
+    portfolio.setEventSink(sink_);
+    // cash and shares only change on a trade, so the per-bar equity for the
+    // tracker is one multiply-add on locals. The tracker is a local too and
+    // stays in registers; it allocates nothing without an equity curve
+    PerformanceTracker tracker;
+    double cash = portfolio.getCash();
+    int shares = 0;
+    ColumnView<double> close = data_.close();
+    {
+        BACKTESTER_PROFILE_SCOPE(ProfileStage::Execute);
+        if (trackPerformance_) {
+            for (size_t i = 0; i < bars; i++) {
+                if (signals[i] != Signal::Hold) {
+                    portfolio.executeSignal(signals[i], close[i], i);
+                    cash = portfolio.getCash();
+                    shares = portfolio.getShares();
+                }
+                tracker.update(cash + shares * close[i], shares > 0);
+            }
+        }
+        else {
+            for (size_t i = 0; i < bars; i++) {
+                if (signals[i] != Signal::Hold) {
+                    portfolio.executeSignal(signals[i], close[i], i);
+                }
+            }
+        }
+    }
+
+    double lastClose = close[bars - 1];
+    result.returnPercent = portfolio.getReturn(lastClose);
+    result.trades = portfolio.getTradeHistory().size();
+    result.finalValue = portfolio.getTotalValue(lastClose);
+    if (trackPerformance_) {
+        result.performance = tracker.stats();
+    }
+    return result;
+}
+
+std::vector<SMAParams> ParameterSweep::smaGrid(int shortMin, int shortMax, int longMin, int longMax, int step) {
+    step = std::max(step, 1);
+    std::vector<SMAParams> grid;
+    for (int shortPeriod = shortMin; shortPeriod <= shortMax; shortPeriod += step) {
+        for (int longPeriod = std::max(longMin, shortPeriod + 1); longPeriod <= longMax; longPeriod += step) {
+            grid.push_back({shortPeriod, longPeriod});
+        }
+    }
+    return grid;
+}
+
+std::vector<RSIParams> ParameterSweep::rsiGrid(const std::vector<int>& periods, const std::vector<double>& oversold,
+                                               const std::vector<double>& overbought) {
+    std::vector<RSIParams> grid;
+    for (int period : periods) {
+        for (double low : oversold) {
+            for (double high : overbought) {
+                if (low < high) {
+                    grid.push_back({period, low, high});
+                }
+            }
+        }
+    }
+    return grid;
+}
+
+std::vector<SweepResult> ParameterSweep::best(const std::vector<SweepResult>& results, size_t count,
+                                               SweepMetric metric) {
+    std::vector<SweepResult> sorted = results;
+    count = std::min(count, sorted.size());
+    std::partial_sort(sorted.begin(), sorted.begin() + count, sorted.end(),
+                      [metric](const SweepResult& a, const SweepResult& b) { return better(a, b, metric); });
+    sorted.resize(count);
+    return sorted;
+}
+
+double ParameterSweep::score(const SweepResult& result, SweepMetric metric) {
+    switch (metric) {
+        case SweepMetric::Sharpe:
+            return result.performance.sharpe;
+        case SweepMetric::Sortino:
+            return result.performance.sortino;
+        case SweepMetric::Drawdown:
+            return -result.performance.maxDrawdown;
+        default:
+            return result.returnPercent;
+    }
+}
+
+bool ParameterSweep::better(const SweepResult& a, const SweepResult& b, SweepMetric metric) {
+    double scoreA = score(a, metric);
+    double scoreB = score(b, metric);
+    if (scoreA != scoreB) {
+        return scoreA > scoreB;
+    }
+    return a.combination < b.combination;
+}
+
+StoredResult ParameterSweep::toStored(const SweepResult& result) {
+    StoredResult stored;
+    stored.combination = result.combination;
+    stored.trades = result.trades;
+    stored.returnPercent = result.returnPercent;
+    stored.finalValue = result.finalValue;
+    stored.sharpe = result.performance.sharpe;
+    stored.sortino = result.performance.sortino;
+    stored.maxDrawdown = result.performance.maxDrawdown;
+    stored.exposure = result.performance.exposure;
+    return stored;
+}
+
+void ParameterSweep::setEventSink(EventSink* sink) {
+    sink_ = sink;
+}
+
+void ParameterSweep::setTrackPerformance(bool enabled) {
+    trackPerformance_ = enabled;
+}
+
+double ParameterSweep::lastSeconds() const {
+    return lastSeconds_;
+}
+
+double ParameterSweep::combinationsPerSecond() const {
+    return lastSeconds_ > 0.0 ? lastCombinations_ / lastSeconds_ : 0.0;
+}
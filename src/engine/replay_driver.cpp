@@ -0,0 +1,154 @@
+#include "replay_driver.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+ReplayDriver::ReplayDriver() :
+    speed_(0.0), tradeCapacity_(0), bars_(0), lateBars_(0), lastClose_(0.0), lastRunSeconds_(0.0) {
+}
+
+size_t ReplayDriver::addStrategy(const std::string& name, std::unique_ptr<Strategy> strategy, Portfolio portfolio) {
+    slots_.push_back(Slot{name, std::move(strategy), std::move(portfolio), StrategyStats(), Signal::Hold});
+    return slots_.size() - 1;
+}
+
+void ReplayDriver::setSpeed(double speed) {
+    if (speed < 0.0) {
+        throw std::invalid_argument("ReplayDriver: speed must be >= 0");
+    }
+    speed_ = speed;
+}
+
+void ReplayDriver::setTradeCapacity(size_t trades) {
+    tradeCapacity_ = trades;
+}
+
+size_t ReplayDriver::run(BarSource& source) {
+    return replay(source);
+}
+
+size_t ReplayDriver::run(BarStream& stream) {
+    return replay(stream);
+}
+
+template <typename Source>
+size_t ReplayDriver::replay(Source& source) {
+    using Clock = std::chrono::steady_clock;
+    for (Slot& slot : slots_) {
+        slot.strategy->resetBars();
+        slot.stats = StrategyStats();
+        slot.lastSignal = Signal::Hold;
+        if (tradeCapacity_ > 0) {
+            slot.portfolio.reserveTrades(tradeCapacity_);
+        }
+    }
+    latency_.reset();
+    bars_ = 0;
+    lateBars_ = 0;
+
+    auto start = Clock::now();
+    Clock::time_point origin;  // when the first bar was due
+    int64_t firstTimestamp = 0;
+    Bar bar;
+    while (source.next(bar)) {
+        if (speed_ > 0.0) {
+            if (bars_ == 0) {
+                origin = Clock::now();
+                firstTimestamp = bar.timestamp;
+            }
+            // sleep_until() wakes tens of microseconds late, fine against bar gaps
+            auto due = origin + std::chrono::nanoseconds(
+                static_cast<int64_t>(static_cast<double>(bar.timestamp - firstTimestamp) / speed_));
+            if (Clock::now() < due) {
+                std::this_thread::sleep_until(due);
+            }
+            else if (bars_ > 0) {
+                lateBars_++;
+            }
+        }
+
+        auto tick = Clock::now();
+        double price = bar.close;
+        for (Slot& slot : slots_) {
+            Signal signal = slot.strategy->onBar(bar);
+            StrategyStats& stats = slot.stats;
+            if (signal == Signal::Buy) stats.buySignals++;
+            else if (signal == Signal::Sell) stats.sellSignals++;
+            else stats.holdSignals++;
+            if (bars_ > 0 && signal != slot.lastSignal && signal != Signal::Hold) {
+                stats.signalChanges++;
+            }
+            slot.lastSignal = signal;
+            if (signal != Signal::Hold) {
+                slot.portfolio.executeSignal(signal, price, bars_);
+            }
+        }
+        latency_.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now() - tick).count()));
+        lastClose_ = price;
+        bars_++;
+    }
+    lastRunSeconds_ = std::chrono::duration<double>(Clock::now() - start).count();
+    return bars_;
+}
+
+void ReplayDriver::printSummary() const {
+    std::cout << "Replayed " << bars_ << " bars through " << slots_.size() << " strategies in "
+              << lastRunSeconds_ * 1000.0 << " ms";
+    if (speed_ > 0.0) {
+        std::cout << " at " << speed_ << "x (" << lateBars_ << " late)";
+    }
+    std::cout << std::endl;
+    latency_.printSummary("tick-to-signal");
+    for (const Slot& slot : slots_) {
+        // trades as the portfolio made them, like UniverseBacktest reports
+        std::cout << std::left << std::setw(12) << slot.name << std::right << " trades "
+                  << slot.portfolio.getTradeHistory().size() << " (" << slot.stats.signalChanges
+                  << " signal changes), return " << (bars_ > 0 ? slot.portfolio.getReturn(lastClose_) : 0.0) << "%" << std::endl;
+    }
+}
+
+size_t ReplayDriver::size() const {
+    return slots_.size();
+}
+
+const std::string& ReplayDriver::getName(size_t slot) const {
+    return slots_.at(slot).name;
+}
+
+Strategy& ReplayDriver::getStrategy(size_t slot) {
+    return *slots_.at(slot).strategy;
+}
+
+const Portfolio& ReplayDriver::getPortfolio(size_t slot) const {
+    return slots_.at(slot).portfolio;
+}
+
+const StrategyStats& ReplayDriver::getStats(size_t slot) const {
+    return slots_.at(slot).stats;
+}
+
+double ReplayDriver::getReturn(size_t slot) const {
+    if (bars_ == 0) {
+        return 0.0;
+    }
+    return slots_.at(slot).portfolio.getReturn(lastClose_);
+}
+
+const LatencyHistogram& ReplayDriver::latency() const {
+    return latency_;
+}
+
+size_t ReplayDriver::barsReplayed() const {
+    return bars_;
+}
+
+size_t ReplayDriver::lateBars() const {
+    return lateBars_;
+}
+
+double ReplayDriver::lastRunSeconds() const {
+    return lastRunSeconds_;
+}
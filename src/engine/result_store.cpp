@@ -0,0 +1,179 @@
+#include "result_store.h"
+#include <cstring>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace {
+
+const char kMagic[8] = {'B', 'T', 'R', 'E', 'S', 'U', 'L', 'T'};
+const uint32_t kVersion = 1;
+
+struct ResultHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    char reserved[48];
+};
+static_assert(sizeof(ResultHeader) == 64, "records start on a 64 byte boundary");
+
+bool validHeader(const ResultHeader& header) {
+    return std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0
+        && header.version == kVersion
+        && header.recordSize == sizeof(StoredResult);
+}
+
+}
+
+// ---------------- ResultWriter ----------------
+
+ResultWriter::ResultWriter() : out_(nullptr), written_(0) {
+}
+
+ResultWriter::~ResultWriter() {
+    close();
+}
+
+bool ResultWriter::open(const std::string& file, bool append) {
+    close();
+    std::FILE* out = std::fopen(file.c_str(), append ? "ab+" : "wb+");
+    if (!out) {
+        return false;
+    }
+
+    // an existing file must already be ours, a new one gets the header
+    std::fseek(out, 0, SEEK_END);
+    long size = std::ftell(out);
+    if (size > 0) {
+        ResultHeader header;
+        std::rewind(out);
+        bool valid = std::fread(&header, sizeof(header), 1, out) == 1 && validHeader(header);
+        // drop a partial record a writer left when it died, or every record
+        // appended after it would be read shifted
+        size_t records = (static_cast<size_t>(size) - sizeof(header)) / sizeof(StoredResult);
+        off_t whole = static_cast<off_t>(sizeof(header) + records * sizeof(StoredResult));
+        if (valid && whole != size) {
+            valid = ::ftruncate(::fileno(out), whole) == 0;
+        }
+        if (!valid) {
+            std::fclose(out);
+            return false;
+        }
+    }
+    else {
+        ResultHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.recordSize = sizeof(StoredResult);
+        if (std::fwrite(&header, sizeof(header), 1, out) != 1) {
+            std::fclose(out);
+            return false;
+        }
+    }
+
+    out_ = out;
+    written_ = 0;
+    return true;
+}
+
+void ResultWriter::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (out_ != nullptr) {
+        std::fclose(out_);
+        out_ = nullptr;
+    }
+}
+
+bool ResultWriter::append(const StoredResult* records, size_t count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (out_ == nullptr) {
+        return false;
+    }
+    // "a" mode: every write lands at the end, whatever the read above did
+    size_t done = std::fwrite(records, sizeof(StoredResult), count, out_);
+    written_ += done;
+    return done == count;
+}
+
+void ResultWriter::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (out_ != nullptr) {
+        std::fflush(out_);
+    }
+}
+
+bool ResultWriter::isOpen() const {
+    return out_ != nullptr;
+}
+
+size_t ResultWriter::written() const {
+    return written_;
+}
+
+// ---------------- ResultStore ----------------
+
+ResultStore::ResultStore() : records_(nullptr), size_(0) {
+}
+
+ResultStore::ResultStore(const std::string& file) : ResultStore() {
+    open(file);
+}
+
+bool ResultStore::open(const std::string& file) {
+    close();
+    if (!file_.open(file) || file_.size() < sizeof(ResultHeader)) {
+        close();
+        return false;
+    }
+
+    ResultHeader header;
+    std::memcpy(&header, file_.data(), sizeof(header));
+    if (!validHeader(header)) {
+        close();
+        return false;
+    }
+
+    // the mapping is page aligned and the header 64 bytes, so the records are aligned too
+    records_ = reinterpret_cast<const StoredResult*>(file_.data() + sizeof(ResultHeader));
+    size_ = (file_.size() - sizeof(ResultHeader)) / sizeof(StoredResult);
+    return true;
+}
+
+void ResultStore::close() {
+    file_.close();
+    records_ = nullptr;
+    size_ = 0;
+}
+
+std::vector<StoredResult> ResultStore::filter(const std::function<bool(const StoredResult&)>& keep) const {
+    std::vector<StoredResult> kept;
+    for (const StoredResult& record : *this) {
+        if (keep(record)) {
+            kept.push_back(record);
+        }
+    }
+    return kept;
+}
+
+bool ResultStore::isOpen() const {
+    return file_.isOpen();
+}
+
+size_t ResultStore::size() const {
+    return size_;
+}
+
+const StoredResult& ResultStore::operator[](size_t index) const {
+    if (index >= size_) {
+        throw std::out_of_range("result index out of range");
+    }
+    return records_[index];
+}
+
+const StoredResult* ResultStore::begin() const {
+    return records_;
+}
+
+const StoredResult* ResultStore::end() const {
+    return records_ + size_;
+}
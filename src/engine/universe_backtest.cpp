@@ -0,0 +1,172 @@
+#include "universe_backtest.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+UniverseBacktest::UniverseBacktest(const Universe& universe, ThreadPool& pool) :
+    universe_(universe), pool_(pool), maxResident_(0), mode_(BacktestEngine::Mode::PerBar),
+    largestFirst_(true), lastSeconds_(0.0), resident_(0), peakResident_(0) {
+}
+
+std::vector<SymbolResult> UniverseBacktest::run(const Setup& setup) {
+    auto start = std::chrono::steady_clock::now();
+    peakResident_ = 0;
+
+    std::vector<uint32_t> order;
+    if (largestFirst_) {
+        order = universe_.largestFirst();
+    }
+    else {
+        for (const SymbolInfo& symbol : universe_.symbols()) {
+            order.push_back(symbol.id);
+        }
+    }
+
+    // parallelFor hands out indices in order, one at a time, so `order` is
+    // the order symbols start in. Each task writes only its own slot
+    std::vector<SymbolResult> results(universe_.size());
+    pool_.parallelFor(order.size(), [&](size_t i) {
+        const SymbolInfo& symbol = universe_[order[i]];
+        results[symbol.id] = runSymbol(symbol, setup);
+    });
+
+    lastSeconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return results;
+}
+
+SymbolResult UniverseBacktest::runSymbol(const SymbolInfo& symbol, const Setup& setup) {
+    auto start = std::chrono::steady_clock::now();
+    SymbolResult result;
+    result.id = symbol.id;
+
+    acquireSlot();
+    try {
+        // same loader choice as MarketData(file): binary cache when fresh, CSV otherwise
+        MarketData data;
+        data.setLayout(MarketData::Layout::Columns);
+        result.loaded = data.load(symbol.file) && data.size() > 0;
+        if (result.loaded) {
+            BacktestEngine engine(data);
+            setup(engine, symbol);
+            engine.run(mode_);
+
+            result.bars = data.size();
+            for (size_t slot = 0; slot < engine.size(); slot++) {
+                StrategyOutcome outcome;
+                outcome.name = engine.getName(slot);
+                outcome.returnPercent = engine.getReturn(slot);
+                outcome.trades = engine.getPortfolio(slot).getTradeHistory().size();
+                result.strategies.push_back(outcome);
+            }
+        }
+    } catch (...) {
+        releaseSlot();
+        throw;
+    }
+    releaseSlot();
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+void UniverseBacktest::acquireSlot() {
+    std::unique_lock<std::mutex> lock(residentMutex_);
+    if (maxResident_ > 0) {
+        residentFree_.wait(lock, [this] { return resident_ < maxResident_; });
+    }
+    resident_++;
+    peakResident_ = std::max(peakResident_, resident_);
+}
+
+void UniverseBacktest::releaseSlot() {
+    {
+        std::lock_guard<std::mutex> lock(residentMutex_);
+        resident_--;
+    }
+    residentFree_.notify_one();
+}
+
+void UniverseBacktest::setMaxResident(size_t symbols) {
+    maxResident_ = symbols;
+}
+
+void UniverseBacktest::setMode(BacktestEngine::Mode mode) {
+    mode_ = mode;
+}
+
+void UniverseBacktest::setLargestFirst(bool enabled) {
+    largestFirst_ = enabled;
+}
+
+UniverseSummary UniverseBacktest::summarize(const std::vector<SymbolResult>& results) {
+    UniverseSummary summary;
+    summary.symbols = results.size();
+
+    // strategy slots are matched by position, every symbol got the same Setup
+    std::vector<std::vector<double>> returns;
+    for (const SymbolResult& result : results) {
+        if (!result.loaded) {
+            summary.failed++;
+            continue;
+        }
+        summary.bars += result.bars;
+        for (size_t slot = 0; slot < result.strategies.size(); slot++) {
+            const StrategyOutcome& outcome = result.strategies[slot];
+            if (slot == summary.strategies.size()) {
+                summary.strategies.emplace_back();
+                summary.strategies.back().name = outcome.name;
+                returns.emplace_back();
+            }
+            StrategySummary& strategy = summary.strategies[slot];
+            if (strategy.symbols == 0 || outcome.returnPercent > strategy.bestReturn) {
+                strategy.best = result.id;
+                strategy.bestReturn = outcome.returnPercent;
+            }
+            if (strategy.symbols == 0 || outcome.returnPercent < strategy.worstReturn) {
+                strategy.worst = result.id;
+                strategy.worstReturn = outcome.returnPercent;
+            }
+            strategy.symbols++;
+            strategy.winners += outcome.returnPercent > 0.0;
+            strategy.trades += outcome.trades;
+            strategy.meanReturn += outcome.returnPercent;
+            returns[slot].push_back(outcome.returnPercent);
+        }
+    }
+
+    for (size_t slot = 0; slot < summary.strategies.size(); slot++) {
+        StrategySummary& strategy = summary.strategies[slot];
+        std::vector<double>& values = returns[slot];
+        strategy.meanReturn /= static_cast<double>(values.size());
+        std::sort(values.begin(), values.end());
+        size_t middle = values.size() / 2;
+        strategy.medianReturn = values.size() % 2 == 1 ? values[middle] : (values[middle - 1] + values[middle]) / 2.0;
+    }
+    return summary;
+}
+
+void UniverseBacktest::printSummary(const UniverseSummary& summary, const Universe& universe) {
+    std::cout << summary.symbols << " symbols (" << summary.failed << " failed to load), "
+              << summary.bars << " bars" << std::endl;
+    std::cout << std::left << std::setw(24) << "strategy" << std::right << std::setw(10) << "mean %"
+              << std::setw(10) << "median %" << std::setw(9) << "winners" << std::setw(9) << "trades"
+              << "  best / worst" << std::endl;
+    for (const StrategySummary& strategy : summary.strategies) {
+        std::cout << std::left << std::setw(24) << strategy.name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(10) << strategy.meanReturn << std::setw(10) << strategy.medianReturn
+                  << std::setw(5) << strategy.winners << "/" << std::left << std::setw(3) << strategy.symbols
+                  << std::right << std::setw(9) << strategy.trades << "  "
+                  << universe[strategy.best].symbol << " " << strategy.bestReturn << " / "
+                  << universe[strategy.worst].symbol << " " << strategy.worstReturn
+                  << std::defaultfloat << std::endl;
+    }
+}
+
+double UniverseBacktest::lastSeconds() const {
+    return lastSeconds_;
+}
+
+size_t UniverseBacktest::peakResident() const {
+    return peakResident_;
+}
@@ -0,0 +1,214 @@
+#include "walk_forward.h"
+#include "portfolio.h"
+#include "rsi_strategy.h"
+#include "sma_crossover_strategy.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+
+namespace {
+
+// per-bar equity and whether shares were held, for stitching folds
+struct EquityPath {
+    std::vector<double> equity;
+    std::vector<uint8_t> invested;
+};
+
+// trades bars [first, last) at the close like ParameterSweep does, signals[0]
+// is bar first's signal and day indexes stay absolute. The tracker and
+// path, if given, see every bar; without them only the signals are walked
+SweepResult tradeWindow(const Signal* signals, ColumnView<double> close, size_t first, size_t last,
+                        Portfolio& portfolio, PerformanceTracker* tracker, EquityPath* path = nullptr) {
+    if (tracker == nullptr && path == nullptr) {
+        for (size_t i = first; i < last; i++) {
+            Signal signal = signals[i - first];
+            if (signal != Signal::Hold) {
+                portfolio.executeSignal(signal, close[i], i);
+            }
+        }
+    }
+    else {
+        double cash = portfolio.getCash();
+        int shares = portfolio.getShares();
+        for (size_t i = first; i < last; i++) {
+            Signal signal = signals[i - first];
+            if (signal != Signal::Hold) {
+                portfolio.executeSignal(signal, close[i], i);
+                cash = portfolio.getCash();
+                shares = portfolio.getShares();
+            }
+            double equity = cash + shares * close[i];
+            if (tracker != nullptr) {
+                tracker->update(equity, shares > 0);
+            }
+            if (path != nullptr) {
+                path->equity.push_back(equity);
+                path->invested.push_back(shares > 0);
+            }
+        }
+    }
+
+    SweepResult result;
+    double lastClose = close[last - 1];
+    result.returnPercent = portfolio.getReturn(lastClose);
+    result.trades = portfolio.getTradeHistory().size();
+    result.finalValue = portfolio.getTotalValue(lastClose);
+    if (tracker != nullptr) {
+        result.performance = tracker->stats();
+    }
+    return result;
+}
+
+}
+
+WalkForward::WalkForward(const MarketData& data, double startingCash, ThreadPool& pool) :
+    data_(data), startingCash_(startingCash), pool_(pool), trainBars_(0), testBars_(0), stepBars_(0),
+    metric_(SweepMetric::Return) {
+    scratch_.reserve(pool_.size() + 1);
+    for (size_t thread = 0; thread <= pool_.size(); thread++) {
+        scratch_.push_back(Scratch{{}, Portfolio(startingCash_)});
+    }
+}
+
+void WalkForward::setWindows(size_t trainBars, size_t testBars, size_t stepBars) {
+    if (trainBars == 0 || testBars == 0) {
+        throw std::invalid_argument("walk-forward windows need at least one bar");
+    }
+    if (stepBars > testBars) {
+        // the bars between test windows would be missing from the stitched curve
+        throw std::invalid_argument("walk-forward step must not be longer than the test window");
+    }
+    trainBars_ = trainBars;
+    testBars_ = testBars;
+    stepBars_ = stepBars == 0 ? testBars : stepBars;
+}
+
+void WalkForward::setMetric(SweepMetric metric) {
+    metric_ = metric;
+}
+
+std::vector<WalkForwardFold> WalkForward::folds(size_t bars) const {
+    std::vector<WalkForwardFold> result;
+    if (trainBars_ == 0) {
+        return result;
+    }
+    for (size_t begin = 0; begin + trainBars_ < bars; begin += stepBars_) {
+        WalkForwardFold fold;
+        fold.trainBegin = begin;
+        fold.trainEnd = begin + trainBars_;
+        fold.testBegin = fold.trainEnd;
+        fold.testEnd = std::min(fold.testBegin + testBars_, bars);
+        result.push_back(fold);
+    }
+    return result;
+}
+
+WalkForwardResult WalkForward::runSMA(const std::vector<SMAParams>& grid) {
+    return run(grid.size(), [&grid](size_t i) {
+        return std::unique_ptr<Strategy>(new SMACrossoverStrategy(grid[i].shortPeriod, grid[i].longPeriod));
+    });
+}
+
+WalkForwardResult WalkForward::runRSI(const std::vector<RSIParams>& grid) {
+    return run(grid.size(), [&grid](size_t i) {
+        return std::unique_ptr<Strategy>(new RSIStrategy(grid[i].period, grid[i].oversold, grid[i].overbought));
+    });
+}
+
+WalkForwardResult WalkForward::run(size_t combinations, const ParameterSweep::StrategyFactory& make) {
+    if (trainBars_ == 0) {
+        throw std::logic_error("WalkForward::run: call setWindows() first");
+    }
+    auto start = std::chrono::steady_clock::now();
+    WalkForwardResult result;
+    result.folds = folds(data_.size());
+    size_t foldCount = result.folds.size();
+    if (foldCount == 0 || combinations == 0) {
+        return result;
+    }
+    ColumnView<double> close = data_.close();
+    SweepMetric metric = metric_;
+
+    // train: one task per combination, every fold from one signal column.
+    // best[thread][fold] is that thread's winner so far, merged below
+    size_t threads = pool_.size() + 1;
+    std::vector<std::vector<SweepResult>> best(threads, std::vector<SweepResult>(foldCount));
+    std::vector<std::vector<bool>> seen(threads, std::vector<bool>(foldCount, false));
+    size_t lastTrainEnd = result.folds.back().trainEnd;
+
+    pool_.parallelFor(combinations, [&](size_t combination) {
+        std::unique_ptr<Strategy> strategy = make(combination);
+        size_t thread = pool_.workerIndex();
+        std::vector<Signal>& signals = scratch_[thread].signals;
+        signals.resize(lastTrainEnd);
+        strategy->analyzeRange(data_, 0, lastTrainEnd, signals.data());
+
+        Portfolio& portfolio = scratch_[thread].portfolio;
+        for (size_t f = 0; f < foldCount; f++) {
+            const WalkForwardFold& fold = result.folds[f];
+            portfolio.reset(startingCash_);
+            // ranking by return needs no per-bar tracking
+            PerformanceTracker tracker;
+            SweepResult trained = tradeWindow(signals.data() + fold.trainBegin, close, fold.trainBegin,
+                                              fold.trainEnd, portfolio,
+                                              metric == SweepMetric::Return ? nullptr : &tracker);
+            trained.combination = combination;
+            if (!seen[thread][f] || ParameterSweep::better(trained, best[thread][f], metric)) {
+                best[thread][f] = trained;
+                seen[thread][f] = true;
+            }
+        }
+    });
+
+    for (size_t f = 0; f < foldCount; f++) {
+        const SweepResult* winner = nullptr;
+        for (size_t thread = 0; thread < threads; thread++) {
+            if (seen[thread][f] && (winner == nullptr || ParameterSweep::better(best[thread][f], *winner, metric))) {
+                winner = &best[thread][f];
+            }
+        }
+        WalkForwardFold& fold = result.folds[f];
+        fold.best = winner->combination;
+        fold.trainScore = ParameterSweep::score(*winner, metric);
+        fold.trainReturn = winner->returnPercent;
+    }
+
+    // test: the winners out of sample, one task per fold
+    std::vector<EquityPath> paths(foldCount);
+    pool_.parallelFor(foldCount, [&](size_t f) {
+        WalkForwardFold& fold = result.folds[f];
+        std::unique_ptr<Strategy> strategy = make(fold.best);
+        std::vector<Signal> signals(fold.testEnd - fold.testBegin);
+        strategy->analyzeRange(data_, fold.testBegin, fold.testEnd, signals.data());
+
+        Portfolio portfolio(startingCash_);
+        PerformanceTracker tracker;
+        SweepResult tested = tradeWindow(signals.data(), close, fold.testBegin, fold.testEnd, portfolio, &tracker,
+                                         &paths[f]);
+        fold.testReturn = tested.returnPercent;
+        fold.testTrades = tested.trades;
+        fold.test = tested.performance;
+    });
+
+    // stitch: every fold's curve scaled to start where the last one ended.
+    // Test windows overlap when step < test, so a fold only contributes the
+    // bars before the next fold's test window starts
+    double carried = startingCash_;
+    PerformanceTracker outOfSample;
+    for (size_t f = 0; f < foldCount; f++) {
+        const EquityPath& path = paths[f];
+        double scale = carried / startingCash_;
+        size_t bars = f + 1 < foldCount ? std::min(stepBars_, path.equity.size()) : path.equity.size();
+        for (size_t i = 0; i < bars; i++) {
+            result.equity.push_back(path.equity[i] * scale);
+            outOfSample.update(result.equity.back(), path.invested[i] != 0);
+        }
+        if (!result.equity.empty()) {
+            carried = result.equity.back();
+        }
+    }
+    result.outOfSample = outOfSample.stats();
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
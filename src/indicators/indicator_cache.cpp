@@ -0,0 +1,155 @@
+#include "indicator_cache.h"
+#include "indicators.h"
+#include <algorithm>
+
+namespace {
+
+// out[i] = indicator.update(source[i])
+template <typename Indicator>
+std::vector<double> rollingSeries(Indicator indicator, const ColumnView<double>& source) {
+    std::vector<double> out(source.size());
+    for (size_t i = 0; i < source.size(); i++) {
+        out[i] = indicator.update(source[i]);
+    }
+    return out;
+}
+
+// RollingSMA without the ring buffer: the same subtraction and addition per
+// bar (0.0 drops out while the window fills) and the same division
+std::vector<double> smaSeries(size_t period, const ColumnView<double>& source) {
+    period = std::max<size_t>(period, 1);
+    std::vector<double> out(source.size());
+    double sum = 0.0;
+    for (size_t i = 0; i < source.size(); i++) {
+        double dropped = i >= period ? source[i - period] : 0.0;
+        sum += source[i] - dropped;
+        out[i] = i + 1 >= period ? sum / period : 0.0;
+    }
+    return out;
+}
+
+}
+
+bool IndicatorKey::operator==(const IndicatorKey& other) const {
+    return kind == other.kind && period == other.period && field == other.field &&
+           begin == other.begin && count == other.count;
+}
+
+size_t IndicatorKeyHash::operator()(const IndicatorKey& key) const {
+    // boost::hash_combine style mixing
+    size_t hash = static_cast<size_t>(key.kind);
+    for (size_t part : {key.period, key.field, key.begin, key.count}) {
+        hash ^= std::hash<size_t>()(part) + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+    }
+    return hash;
+}
+
+IndicatorCache::IndicatorCache(size_t byteBudget) :
+    byteBudget_(byteBudget), bytes_(0), hits_(0), misses_(0), evictions_(0) {
+}
+
+IndicatorCache::Series IndicatorCache::get(const IndicatorKey& key,
+                                           const std::function<std::vector<double>()>& compute) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto found = entries_.find(key);
+    if (found != entries_.end()) {
+        hits_++;
+        recent_.splice(recent_.begin(), recent_, found->second.recent);
+        std::shared_future<Series> series = found->second.series;
+        lock.unlock();
+        return series.get();  // waits if another thread is still computing it
+    }
+
+    misses_++;
+    std::promise<Series> promise;
+    recent_.push_front(key);
+    entries_[key] = Entry{promise.get_future().share(), 0, false, &promise, recent_.begin()};
+    lock.unlock();
+
+    // computed outside the lock, other keys stay available meanwhile
+    Series series;
+    try {
+        series = std::make_shared<const std::vector<double>>(compute());
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+        lock.lock();
+        found = entries_.find(key);
+        if (found != entries_.end() && found->second.owner == &promise) {
+            recent_.erase(found->second.recent);
+            entries_.erase(found);
+        }
+        throw;
+    }
+    promise.set_value(series);
+
+    lock.lock();
+    found = entries_.find(key);
+    if (found != entries_.end() && found->second.owner == &promise) {  // clear() may have dropped it
+        found->second.ready = true;
+        found->second.owner = nullptr;
+        found->second.bytes = series->size() * sizeof(double);
+        bytes_ += found->second.bytes;
+        evictOverBudget();
+    }
+    return series;
+}
+
+void IndicatorCache::evictOverBudget() {
+    // oldest first, series still being computed can't be measured or dropped yet
+    auto candidate = recent_.end();
+    while (bytes_ > byteBudget_ && candidate != recent_.begin()) {
+        --candidate;
+        auto found = entries_.find(*candidate);
+        if (!found->second.ready) {
+            continue;
+        }
+        bytes_ -= found->second.bytes;
+        evictions_++;
+        entries_.erase(found);
+        candidate = recent_.erase(candidate);
+    }
+}
+
+void IndicatorCache::setByteBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    byteBudget_ = bytes;
+    evictOverBudget();
+}
+
+size_t IndicatorCache::byteBudget() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return byteBudget_;
+}
+
+IndicatorCacheStats IndicatorCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    IndicatorCacheStats stats;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.evictions = evictions_;
+    stats.entries = entries_.size();
+    stats.bytes = bytes_;
+    return stats;
+}
+
+void IndicatorCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // series still being computed are dropped too, their callers get them
+    // straight from compute() and only the cached copy is lost
+    entries_.clear();
+    recent_.clear();
+    bytes_ = 0;
+}
+
+std::vector<double> IndicatorCache::compute(IndicatorKind kind, size_t period, const ColumnView<double>& source) {
+    switch (kind) {
+        case IndicatorKind::SMA: return smaSeries(period, source);
+        case IndicatorKind::EMA: return rollingSeries(EMA(period), source);
+        case IndicatorKind::RSI: return rollingSeries(RollingRSI(period), source);
+        case IndicatorKind::WilderRSI: return rollingSeries(WilderRSI(period), source);
+        case IndicatorKind::StdDev: return rollingSeries(RollingStdDev(period), source);
+        case IndicatorKind::Min: return rollingSeries(RollingMin(period), source);
+        case IndicatorKind::Max: return rollingSeries(RollingMax(period), source);
+    }
+    return std::vector<double>(source.size(), 0.0);
+}
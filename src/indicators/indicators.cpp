@@ -0,0 +1,355 @@
+#include "indicators.h"
+#include <cmath>
+
+// ---------------- RollingWindow ----------------
+
+RollingWindow::RollingWindow(size_t capacity) :
+    values_(), capacity_(capacity > 0 ? capacity : 1), next_(0), count_(0) {
+}
+
+double RollingWindow::push(double x) {
+    if (values_.empty()) {
+        values_.assign(capacity_, 0.0);
+    }
+    double dropped = full() ? values_[next_] : 0.0;
+    values_[next_] = x;
+    next_ = next_ + 1 == values_.size() ? 0 : next_ + 1;
+    if (count_ < values_.size()) {
+        count_++;
+    }
+    return dropped;
+}
+
+void RollingWindow::clear() {
+    next_ = 0;
+    count_ = 0;
+}
+
+bool RollingWindow::full() const {
+    return count_ == capacity_;
+}
+
+size_t RollingWindow::size() const {
+    return count_;
+}
+
+size_t RollingWindow::capacity() const {
+    return capacity_;
+}
+
+double RollingWindow::newest() const {
+    if (count_ == 0) {
+        return 0.0;
+    }
+    return values_[next_ == 0 ? values_.size() - 1 : next_ - 1];
+}
+
+double RollingWindow::oldest() const {
+    if (count_ == 0) {
+        return 0.0;
+    }
+    return full() ? values_[next_] : values_[0];
+}
+
+double RollingWindow::at(size_t position) const {
+    if (count_ == 0) {
+        return 0.0;
+    }
+    size_t first = full() ? next_ : 0;
+    size_t slot = first + position;
+    return values_[slot >= values_.size() ? slot - values_.size() : slot];
+}
+
+// ---------------- RollingSMA ----------------
+
+RollingSMA::RollingSMA(size_t period) : window_(period), sum_(0.0) {
+}
+
+double RollingSMA::update(double x) {
+    // before the window is full the dropped value is 0.0, so this is a plain add
+    double dropped = window_.push(x);
+    sum_ += x - dropped;
+    return ready() ? value() : 0.0;
+}
+
+void RollingSMA::reset() {
+    window_.clear();
+    sum_ = 0.0;
+}
+
+bool RollingSMA::ready() const {
+    return window_.full();
+}
+
+double RollingSMA::value() const {
+    return sum_ / window_.capacity();
+}
+
+size_t RollingSMA::period() const {
+    return window_.capacity();
+}
+
+// ---------------- EMA ----------------
+
+EMA::EMA(size_t period) :
+    period_(period > 0 ? period : 1), alpha_(2.0 / (period_ + 1.0)), count_(0), value_(0.0) {
+}
+
+double EMA::update(double x) {
+    count_++;
+    if (count_ < period_) {
+        value_ += x;  // summing the seed
+        return 0.0;
+    }
+    if (count_ == period_) {
+        value_ = (value_ + x) / period_;
+    }
+    else {
+        value_ += alpha_ * (x - value_);
+    }
+    return value_;
+}
+
+void EMA::reset() {
+    count_ = 0;
+    value_ = 0.0;
+}
+
+bool EMA::ready() const {
+    return count_ >= period_;
+}
+
+double EMA::value() const {
+    return value_;
+}
+
+size_t EMA::period() const {
+    return period_;
+}
+
+// ---------------- RollingRSI ----------------
+
+RollingRSI::RollingRSI(size_t period) :
+    changes_(period), previousClose_(0.0), closes_(0),
+    totalGain_(0.0), totalLoss_(0.0), gainDays_(0), lossDays_(0) {
+}
+
+double RollingRSI::update(double close) {
+    closes_++;
+    if (closes_ == 1) {
+        previousClose_ = close;
+        return 0.0;
+    }
+
+    double change = close - previousClose_;
+    previousClose_ = close;
+
+    // while the window fills the dropped change is 0.0, which moves nothing
+    double dropped = changes_.push(change);
+    totalGain_ += gainOf(change) - gainOf(dropped);
+    totalLoss_ += lossOf(change) - lossOf(dropped);
+    gainDays_ += (gainOf(change) > 0) - (gainOf(dropped) > 0);
+    lossDays_ += (lossOf(change) > 0) - (lossOf(dropped) > 0);
+
+    // keep "no losses in the window" exact, so RSI is exactly 100 like the
+    // window sum gives instead of 99.999... from leftover rounding
+    if (gainDays_ == 0) totalGain_ = 0.0;
+    if (lossDays_ == 0) totalLoss_ = 0.0;
+
+    return ready() ? value() : 0.0;
+}
+
+void RollingRSI::reset() {
+    changes_.clear();
+    previousClose_ = 0.0;
+    closes_ = 0;
+    totalGain_ = 0.0;
+    totalLoss_ = 0.0;
+    gainDays_ = 0;
+    lossDays_ = 0;
+}
+
+bool RollingRSI::ready() const {
+    return closes_ > changes_.capacity();
+}
+
+double RollingRSI::value() const {
+    double period = static_cast<double>(changes_.capacity());
+    return rsiFromAverages(totalGain_ / period, totalLoss_ / period);
+}
+
+size_t RollingRSI::period() const {
+    return changes_.capacity();
+}
+
+// ---------------- WilderRSI ----------------
+
+WilderRSI::WilderRSI(size_t period) :
+    period_(period > 0 ? period : 1), previousClose_(0.0), closes_(0),
+    averageGain_(0.0), averageLoss_(0.0) {
+}
+
+double WilderRSI::update(double close) {
+    closes_++;
+    if (closes_ == 1) {
+        previousClose_ = close;
+        return 0.0;
+    }
+
+    double change = close - previousClose_;
+    previousClose_ = close;
+    size_t changes = closes_ - 1;
+
+    if (changes <= period_) {
+        // seed phase, the averages hold plain sums until the first period is complete
+        averageGain_ += gainOf(change);
+        averageLoss_ += lossOf(change);
+        if (changes == period_) {
+            averageGain_ /= period_;
+            averageLoss_ /= period_;
+        }
+    }
+    else {
+        averageGain_ = (averageGain_ * (period_ - 1) + gainOf(change)) / period_;
+        averageLoss_ = (averageLoss_ * (period_ - 1) + lossOf(change)) / period_;
+    }
+    return ready() ? value() : 0.0;
+}
+
+void WilderRSI::reset() {
+    previousClose_ = 0.0;
+    closes_ = 0;
+    averageGain_ = 0.0;
+    averageLoss_ = 0.0;
+}
+
+bool WilderRSI::ready() const {
+    return closes_ > period_;
+}
+
+double WilderRSI::value() const {
+    return rsiFromAverages(averageGain_, averageLoss_);
+}
+
+size_t WilderRSI::period() const {
+    return period_;
+}
+
+// ---------------- RollingExtreme ----------------
+
+RollingExtreme::RollingExtreme(size_t period, bool keepMax) :
+    period_(period > 0 ? period : 1), keepMax_(keepMax), seen_(0),
+    queue_(period_ + 1), head_(0), count_(0) {
+}
+
+double RollingExtreme::update(double x) {
+    size_t index = seen_++;
+    size_t capacity = queue_.size();
+    auto slot = [capacity](size_t position) {
+        return position >= capacity ? position - capacity : position;
+    };
+
+    // drop candidates the new value beats, they can never be the extreme again
+    while (count_ > 0) {
+        const Entry& back = queue_[slot(head_ + count_ - 1)];
+        bool beaten = keepMax_ ? back.value <= x : back.value >= x;
+        if (!beaten) {
+            break;
+        }
+        count_--;
+    }
+    queue_[slot(head_ + count_)] = Entry{index, x};
+    count_++;
+
+    // and the ones that left the window
+    while (queue_[head_].index + period_ <= index) {
+        head_ = slot(head_ + 1);
+        count_--;
+    }
+    return ready() ? value() : 0.0;
+}
+
+void RollingExtreme::reset() {
+    seen_ = 0;
+    head_ = 0;
+    count_ = 0;
+}
+
+bool RollingExtreme::ready() const {
+    return seen_ >= period_;
+}
+
+double RollingExtreme::value() const {
+    return queue_[head_].value;
+}
+
+size_t RollingExtreme::period() const {
+    return period_;
+}
+
+// ---------------- RollingStdDev ----------------
+
+RollingStdDev::RollingStdDev(size_t period) : window_(period), mean_(0.0), m2_(0.0), slides_(0) {
+}
+
+double RollingStdDev::update(double x) {
+    if (!window_.full()) {
+        // growing: plain Welford step
+        window_.push(x);
+        double delta = x - mean_;
+        mean_ += delta / window_.size();
+        m2_ += delta * (x - mean_);
+    }
+    else {
+        // sliding: replace the oldest value in one step
+        double dropped = window_.push(x);
+        double oldMean = mean_;
+        mean_ += (x - dropped) / window_.capacity();
+        m2_ += (x - dropped) * (x - mean_ + dropped - oldMean);
+        if (m2_ < 0.0) {
+            m2_ = 0.0;
+        }
+        if (++slides_ == window_.capacity()) {
+            resync();
+        }
+    }
+    return ready() ? value() : 0.0;
+}
+
+void RollingStdDev::resync() {
+    slides_ = 0;
+    size_t count = window_.size();
+    double sum = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        sum += window_.at(i);
+    }
+    mean_ = sum / count;
+    m2_ = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        double distance = window_.at(i) - mean_;
+        m2_ += distance * distance;
+    }
+}
+
+void RollingStdDev::reset() {
+    window_.clear();
+    mean_ = 0.0;
+    m2_ = 0.0;
+    slides_ = 0;
+}
+
+bool RollingStdDev::ready() const {
+    return window_.full();
+}
+
+double RollingStdDev::value() const {
+    return std::sqrt(m2_ / window_.capacity());
+}
+
+double RollingStdDev::mean() const {
+    return mean_;
+}
+
+size_t RollingStdDev::period() const {
+    return window_.capacity();
+}
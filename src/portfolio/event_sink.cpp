@@ -0,0 +1,224 @@
+#include "event_sink.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <unordered_set>
+#include <utility>
+
+namespace {
+
+std::atomic<uint64_t> nextSinkId{1};
+
+// ids of the AsyncFileSinks not yet destroyed
+std::mutex liveSinksMutex;
+std::unordered_set<uint64_t> liveSinks;
+
+// per thread: which ring this thread owns in each AsyncFileSink it has used.
+// ids are never reused, so an entry of a destroyed sink never matches again;
+// such entries are pruned whenever the thread registers with a new sink, so
+// the list stays as short as the live sinks it writes to
+thread_local std::vector<std::pair<uint64_t, void*>> localRings;
+
+size_t roundUpToPowerOfTwo(size_t value) {
+    size_t power = 1;
+    while (power < value) {
+        power <<= 1;
+    }
+    return power;
+}
+
+// same text (and %g-style number formatting) as the old std::cout lines,
+// returns the length like snprintf
+int formatEvent(const TradeEvent& event, char* text, size_t size) {
+    switch (event.type) {
+        case TradeEventType::Buy:
+            return std::snprintf(text, size, "Day %zu: BUY %d shares at $%g (cost: $%g)",
+                                 event.dayIndex, event.quantity, event.price, event.amount);
+        case TradeEventType::Sell:
+            return std::snprintf(text, size, "Day %zu: SELL %d shares at $%g (proceeds: $%g)",
+                                 event.dayIndex, event.quantity, event.price, event.amount);
+        case TradeEventType::RejectedBuy:
+            return std::snprintf(text, size, "Day %zu: Not enough cash to buy (need $%g, have $%g)",
+                                 event.dayIndex, event.price, event.amount);
+        case TradeEventType::RejectedSell:
+            return std::snprintf(text, size, "Day %zu: Cannot sell - own 0 shares", event.dayIndex);
+        case TradeEventType::InvalidBuy:
+            return std::snprintf(text, size, "Error: Cannot buy %d shares", event.quantity);
+        case TradeEventType::InvalidSell:
+            if (event.quantity > 0) {
+                return std::snprintf(text, size, "Error: Cannot sell %d shares, only own %d",
+                                     event.quantity, static_cast<int>(event.amount));
+            }
+            else {
+                return std::snprintf(text, size, "Error: Cannot sell %d shares", event.quantity);
+            }
+        default:
+            return std::snprintf(text, size, "Day %zu: unknown event", event.dayIndex);
+    }
+}
+
+}
+
+std::string TradeEvent::toString() const {
+    char text[160];
+    formatEvent(*this, text, sizeof(text));
+    return text;
+}
+
+// ---------------- ConsoleSink ----------------
+
+ConsoleSink::ConsoleSink(std::ostream& out) : out_(out) {
+}
+
+void ConsoleSink::onEvent(const TradeEvent& event) {
+    std::string line = event.toString();
+    std::lock_guard<std::mutex> lock(mutex_);
+    out_ << line << std::endl;
+}
+
+void ConsoleSink::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    out_.flush();
+}
+
+ConsoleSink& ConsoleSink::shared() {
+    static ConsoleSink sink(std::cout);
+    return sink;
+}
+
+// ---------------- AsyncFileSink ----------------
+
+AsyncFileSink::Ring::Ring(size_t capacity) :
+    slots(capacity), mask(capacity - 1), head(0), cachedTail(0), dropped(0), tail(0) {
+}
+
+AsyncFileSink::AsyncFileSink(const std::string& file, size_t ringCapacity) :
+    id_(nextSinkId.fetch_add(1)), ringCapacity_(roundUpToPowerOfTwo(std::max<size_t>(ringCapacity, 2))),
+    file_(std::fopen(file.c_str(), "w")), written_(0), stopping_(false) {
+    if (file_ != nullptr) {
+        // the drain writes in big blocks
+        std::setvbuf(file_, nullptr, _IOFBF, 1 << 20);
+    }
+    {
+        std::lock_guard<std::mutex> lock(liveSinksMutex);
+        liveSinks.insert(id_);
+    }
+    drainer_ = std::thread(&AsyncFileSink::drainLoop, this);
+}
+
+AsyncFileSink::~AsyncFileSink() {
+    {
+        std::lock_guard<std::mutex> lock(liveSinksMutex);
+        liveSinks.erase(id_);
+    }
+    stopping_.store(true);
+    drainer_.join();
+    drain();
+    if (file_ != nullptr) {
+        std::fclose(file_);
+    }
+}
+
+AsyncFileSink::Ring& AsyncFileSink::localRing() {
+    for (const auto& entry : localRings) {
+        if (entry.first == id_) {
+            return *static_cast<Ring*>(entry.second);
+        }
+    }
+
+    // first event from this thread: forget the sinks destroyed since the last time
+    {
+        std::lock_guard<std::mutex> lock(liveSinksMutex);
+        localRings.erase(std::remove_if(localRings.begin(), localRings.end(),
+                                        [](const std::pair<uint64_t, void*>& entry) {
+                                            return liveSinks.count(entry.first) == 0;
+                                        }),
+                         localRings.end());
+    }
+    std::lock_guard<std::mutex> lock(ringsMutex_);
+    rings_.push_back(std::make_unique<Ring>(ringCapacity_));
+    Ring* ring = rings_.back().get();
+    localRings.emplace_back(id_, ring);
+    return *ring;
+}
+
+void AsyncFileSink::onEvent(const TradeEvent& event) {
+    Ring& ring = localRing();
+    size_t head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.cachedTail == ring.slots.size()) {
+        // only look at the consumer's line when the stale copy says full
+        ring.cachedTail = ring.tail.load(std::memory_order_acquire);
+        if (head - ring.cachedTail == ring.slots.size()) {
+            // single writer, no read-modify-write needed
+            ring.dropped.store(ring.dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    ring.slots[head & ring.mask] = event;
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+size_t AsyncFileSink::drain() {
+    std::lock_guard<std::mutex> drainLock(drainMutex_);
+
+    // rings only ever get added, copy the pointers so producers can keep registering
+    std::vector<Ring*> rings;
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex_);
+        for (const auto& ring : rings_) {
+            rings.push_back(ring.get());
+        }
+    }
+
+    size_t count = 0;
+    for (Ring* ring : rings) {
+        size_t tail = ring->tail.load(std::memory_order_relaxed);
+        size_t head = ring->head.load(std::memory_order_acquire);
+        for (; tail != head; tail++) {
+            if (file_ != nullptr) {
+                char line[160];
+                int length = formatEvent(ring->slots[tail & ring->mask], line, sizeof(line) - 1);
+                length = std::min<int>(length, sizeof(line) - 2);
+                line[length] = '\n';
+                std::fwrite(line, 1, length + 1, file_);
+            }
+            count++;
+        }
+        ring->tail.store(tail, std::memory_order_release);
+    }
+    written_.fetch_add(count, std::memory_order_relaxed);
+    return count;
+}
+
+void AsyncFileSink::drainLoop() {
+    while (!stopping_.load()) {
+        if (drain() == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+void AsyncFileSink::flush() {
+    drain();
+    std::lock_guard<std::mutex> drainLock(drainMutex_);
+    if (file_ != nullptr) {
+        std::fflush(file_);
+    }
+}
+
+bool AsyncFileSink::isOpen() const {
+    return file_ != nullptr;
+}
+
+size_t AsyncFileSink::written() const {
+    return written_.load();
+}
+
+size_t AsyncFileSink::dropped() const {
+    size_t total = 0;
+    std::lock_guard<std::mutex> lock(ringsMutex_);
+    for (const auto& ring : rings_) {
+        total += ring->dropped.load(std::memory_order_relaxed);
+    }
+    return total;
+}
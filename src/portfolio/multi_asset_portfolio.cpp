@@ -0,0 +1,229 @@
+#include "multi_asset_portfolio.h"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+MultiAssetPortfolio::MultiAssetPortfolio(double startingCash, size_t symbols, EventSink* sink,
+                                         std::pmr::memory_resource* resource) :
+    cash_(toPrice(startingCash)), startingValue_(toPrice(startingCash)), sink_(sink),
+    shares_(symbols, 0), averagePrices_(symbols, 0), lastPrices_(symbols, 0.0),
+    tradeHistory_(resource), tradeSymbols_(resource) {
+    if (symbols > UINT32_MAX) {
+        throw std::out_of_range("too many symbols");
+    }
+}
+
+void MultiAssetPortfolio::reset(double startingCash) {
+    cash_ = toPrice(startingCash);
+    startingValue_ = toPrice(startingCash);
+    std::fill(shares_.begin(), shares_.end(), 0);
+    std::fill(averagePrices_.begin(), averagePrices_.end(), Price(0));
+    tradeHistory_.clear();
+    tradeSymbols_.clear();
+}
+
+void MultiAssetPortfolio::setEventSink(EventSink* sink) {
+    sink_ = sink;
+}
+
+void MultiAssetPortfolio::markPrices(const double* prices) {
+    std::copy(prices, prices + lastPrices_.size(), lastPrices_.begin());
+}
+
+void MultiAssetPortfolio::markPrice(uint32_t symbol, double price) {
+    checkSymbol(symbol);
+    lastPrices_[symbol] = price;
+}
+
+size_t MultiAssetPortfolio::executeOrders(const Order* orders, size_t count, size_t dayIndex) {
+    size_t filled = 0;
+    for (size_t i = 0; i < count; i++) {
+        const Order& order = orders[i];
+        checkSymbol(order.symbol);
+        if (order.quantity > 0) {
+            filled += buy(order.symbol, order.quantity, dayIndex);
+        }
+        else if (order.quantity < 0) {
+            filled += sell(order.symbol, -order.quantity, dayIndex);
+        }
+    }
+    return filled;
+}
+
+size_t MultiAssetPortfolio::executeOrders(const std::vector<Order>& orders, size_t dayIndex) {
+    return executeOrders(orders.data(), orders.size(), dayIndex);
+}
+
+size_t MultiAssetPortfolio::executeSignals(const Signal* signals, size_t dayIndex) {
+    size_t filled = 0;
+    buys_.clear();
+    for (uint32_t symbol = 0; symbol < shares_.size(); symbol++) {
+        if (signals[symbol] == Signal::Sell) {
+            if (shares_[symbol] == 0) {
+                emitEvent(sink_, {TradeEventType::RejectedSell, 0, dayIndex, lastPrices_[symbol], 0.0, symbol});
+                continue;
+            }
+            filled += sell(symbol, shares_[symbol], dayIndex);
+        }
+        else if (signals[symbol] == Signal::Buy) {
+            buys_.push_back(symbol);
+        }
+    }
+    if (buys_.empty()) {
+        return filled;
+    }
+
+    // sized off the cash before any of these buys, so the order of the ids
+    // doesn't favour the first ones
+    Price cashToSpend = cash_ / 2 / static_cast<Price>(buys_.size());
+    for (uint32_t symbol : buys_) {
+        double price = lastPrices_[symbol];
+        Price fill = toPrice(price);
+        if (cashToSpend < fill) {
+            emitEvent(sink_, {TradeEventType::RejectedBuy, 0, dayIndex, price, toDollars(cashToSpend), symbol});
+            continue;
+        }
+        filled += buy(symbol, static_cast<int32_t>(cashToSpend / fill), dayIndex);
+    }
+    return filled;
+}
+
+bool MultiAssetPortfolio::buy(uint32_t symbol, int32_t quantity, size_t dayIndex) {
+    double price = lastPrices_[symbol];
+    Price fill = toPrice(price);
+    Price cost = quantity * fill;
+    if (cost > cash_) {
+        emitEvent(sink_, {TradeEventType::RejectedBuy, quantity, dayIndex, price, toDollars(cash_), symbol});
+        return false;
+    }
+
+    // weighted average, same as Position::buyShares
+    int32_t held = shares_[symbol];
+    averagePrices_[symbol] = held == 0 ? fill : (held * averagePrices_[symbol] + cost) / (held + quantity);
+    shares_[symbol] = held + quantity;
+    cash_ -= cost;
+
+    tradeHistory_.record(Signal::Buy, quantity, fill, dayIndex);
+    tradeSymbols_.push_back(symbol);
+    emitEvent(sink_, {TradeEventType::Buy, quantity, dayIndex, price, toDollars(cost), symbol});
+    return true;
+}
+
+bool MultiAssetPortfolio::sell(uint32_t symbol, int32_t quantity, size_t dayIndex) {
+    double price = lastPrices_[symbol];
+    int32_t held = shares_[symbol];
+    if (quantity > held) {
+        emitEvent(sink_, {TradeEventType::InvalidSell, quantity, dayIndex, price, static_cast<double>(held), symbol});
+        return false;
+    }
+
+    Price fill = toPrice(price);
+    Price proceeds = quantity * fill;
+    shares_[symbol] = held - quantity;
+    if (shares_[symbol] == 0) {
+        averagePrices_[symbol] = 0;
+    }
+    cash_ += proceeds;
+
+    tradeHistory_.record(Signal::Sell, quantity, fill, dayIndex);
+    tradeSymbols_.push_back(symbol);
+    emitEvent(sink_, {TradeEventType::Sell, quantity, dayIndex, price, toDollars(proceeds), symbol});
+    return true;
+}
+
+double MultiAssetPortfolio::getCash() const {
+    return toDollars(cash_);
+}
+
+Price MultiAssetPortfolio::positionsValue() const {
+    // four independent sums: the compiler may not reorder one floating point
+    // sum, but it can keep these in vector registers and the adds overlap
+    const int32_t* shares = shares_.data();
+    const double* prices = lastPrices_.data();
+    size_t count = shares_.size();
+    Price sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        sum0 += shares[i] * toPrice(prices[i]);
+        sum1 += shares[i + 1] * toPrice(prices[i + 1]);
+        sum2 += shares[i + 2] * toPrice(prices[i + 2]);
+        sum3 += shares[i + 3] * toPrice(prices[i + 3]);
+    }
+    for (; i < count; i++) {
+        sum0 += shares[i] * toPrice(prices[i]);
+    }
+    return (sum0 + sum1) + (sum2 + sum3);
+}
+
+double MultiAssetPortfolio::getPositionsValue() const {
+    return toDollars(positionsValue());
+}
+
+double MultiAssetPortfolio::getTotalValue() const {
+    return toDollars(cash_ + positionsValue());
+}
+
+double MultiAssetPortfolio::getReturn() const {
+    Price total = cash_ + positionsValue();
+    return (static_cast<double>(total - startingValue_) / static_cast<double>(startingValue_)) * 100.0;
+}
+
+size_t MultiAssetPortfolio::openPositions() const {
+    return shares_.size() - static_cast<size_t>(std::count(shares_.begin(), shares_.end(), 0));
+}
+
+size_t MultiAssetPortfolio::size() const {
+    return shares_.size();
+}
+
+int32_t MultiAssetPortfolio::getShares(uint32_t symbol) const {
+    checkSymbol(symbol);
+    return shares_[symbol];
+}
+
+double MultiAssetPortfolio::getAveragePrice(uint32_t symbol) const {
+    checkSymbol(symbol);
+    return toDollars(averagePrices_[symbol]);
+}
+
+double MultiAssetPortfolio::getLastPrice(uint32_t symbol) const {
+    checkSymbol(symbol);
+    return lastPrices_[symbol];
+}
+
+const int32_t* MultiAssetPortfolio::shares() const {
+    return shares_.data();
+}
+
+const Price* MultiAssetPortfolio::averagePrices() const {
+    return averagePrices_.data();
+}
+
+const double* MultiAssetPortfolio::lastPrices() const {
+    return lastPrices_.data();
+}
+
+const TradeLedger& MultiAssetPortfolio::getTradeHistory() const {
+    return tradeHistory_;
+}
+
+const uint32_t* MultiAssetPortfolio::tradeSymbols() const {
+    return tradeSymbols_.data();
+}
+
+void MultiAssetPortfolio::printSummary() const {
+    std::cout << "\n=== MULTI-ASSET PORTFOLIO SUMMARY ===" << std::endl;
+    std::cout << "Starting Value: $" << toDollars(startingValue_) << std::endl;
+    std::cout << "Current Cash: $" << toDollars(cash_) << std::endl;
+    std::cout << "Open Positions: " << openPositions() << " of " << shares_.size() << " symbols" << std::endl;
+    std::cout << "Positions Value: $" << getPositionsValue() << std::endl;
+    std::cout << "Total Portfolio Value: $" << getTotalValue() << std::endl;
+    std::cout << "Total Return: " << getReturn() << "%" << std::endl;
+    std::cout << "Total Trades: " << tradeHistory_.size() << std::endl;
+}
+
+void MultiAssetPortfolio::checkSymbol(uint32_t symbol) const {
+    if (symbol >= shares_.size()) {
+        throw std::out_of_range("symbol id out of range");
+    }
+}
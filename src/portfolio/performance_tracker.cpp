@@ -0,0 +1,98 @@
+#include "performance_tracker.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+PerformanceTracker::PerformanceTracker(double periodsPerYear) :
+    periodsPerYear_(periodsPerYear), recordCurve_(false) {
+    reset();
+}
+
+void PerformanceTracker::reset() {
+    curve_.clear();
+    bars_ = 0;
+    startValue_ = 0.0;
+    lastValue_ = 0.0;
+    returns_ = 0;
+    mean_ = 0.0;
+    m2_ = 0.0;
+    downsideSquares_ = 0.0;
+    flatReturns_ = 0;
+    peak_ = 0.0;
+    maxDrawdown_ = 0.0;
+    underwaterBars_ = 0;
+    maxUnderwaterBars_ = 0;
+    investedBars_ = 0;
+    invested_ = false;
+    entryValue_ = 0.0;
+    wins_ = 0;
+    losses_ = 0;
+    grossWin_ = 0.0;
+    grossLoss_ = 0.0;
+}
+
+void PerformanceTracker::setRecordCurve(bool enabled) {
+    recordCurve_ = enabled;
+}
+
+const std::vector<double>& PerformanceTracker::equityCurve() const {
+    return curve_;
+}
+
+PerformanceStats PerformanceTracker::stats() const {
+    PerformanceStats stats;
+    stats.bars = bars_;
+    if (bars_ == 0) {
+        return stats;
+    }
+    stats.startValue = startValue_;
+    stats.finalValue = lastValue_;
+    stats.totalReturn = startValue_ != 0.0 ? (lastValue_ - startValue_) / startValue_ * 100.0 : 0.0;
+
+    // the flat run still open at the last bar
+    size_t returns = returns_;
+    double mean = mean_;
+    double m2 = m2_;
+    if (flatReturns_ > 0) {
+        mergeFlat(returns, mean, m2, flatReturns_);
+    }
+    stats.meanReturn = mean;
+
+    // sample variance; Sortino's downside deviation is over every return
+    double annualise = std::sqrt(periodsPerYear_);
+    stats.volatility = returns > 1 ? std::sqrt(m2 / static_cast<double>(returns - 1)) : 0.0;
+    stats.sharpe = stats.volatility > 0.0 ? mean / stats.volatility * annualise : 0.0;
+    double downside = returns > 0 ? std::sqrt(downsideSquares_ / static_cast<double>(returns)) : 0.0;
+    stats.sortino = downside > 0.0 ? mean / downside * annualise : 0.0;
+
+    stats.maxDrawdown = maxDrawdown_ * 100.0;
+    stats.maxDrawdownBars = maxUnderwaterBars_;
+    stats.exposure = static_cast<double>(investedBars_) / static_cast<double>(bars_);
+
+    stats.wins = wins_;
+    stats.losses = losses_;
+    stats.roundTrips = wins_ + losses_;
+    if (stats.roundTrips > 0) {
+        stats.winRate = static_cast<double>(wins_) / static_cast<double>(stats.roundTrips);
+    }
+    stats.averageWin = wins_ > 0 ? grossWin_ / static_cast<double>(wins_) : 0.0;
+    stats.averageLoss = losses_ > 0 ? grossLoss_ / static_cast<double>(losses_) : 0.0;
+    stats.profitFactor = grossLoss_ > 0.0 ? grossWin_ / grossLoss_ : 0.0;
+    return stats;
+}
+
+size_t PerformanceTracker::bars() const {
+    return bars_;
+}
+
+double PerformanceTracker::periodsPerYear() const {
+    return periodsPerYear_;
+}
+
+void PerformanceTracker::printSummary() const {
+    PerformanceStats s = stats();
+    std::cout << "Sharpe: " << s.sharpe << ", Sortino: " << s.sortino << std::endl;
+    std::cout << "Max Drawdown: " << s.maxDrawdown << "% (longest " << s.maxDrawdownBars << " bars)" << std::endl;
+    std::cout << "Exposure: " << s.exposure * 100.0 << "% of bars" << std::endl;
+    std::cout << "Round Trips: " << s.roundTrips << " (" << s.wins << " won, " << s.losses << " lost)" << std::endl;
+}
@@ -1,70 +1,104 @@
 #include "portfolio.h"
 #include <iostream>
 
-Portfolio::Portfolio(double startingCash) : 
-    cash_(startingCash), 
+Portfolio::Portfolio(double startingCash, EventSink* sink, std::pmr::memory_resource* resource) : 
+    cash_(toPrice(startingCash)), 
     position_(),                    // Default constructor - starts with 0 shares
-    tradeHistory_(),               // Empty vector of trades
-    startingValue_(startingCash)   // Remember starting amount for return calculation
+    tradeHistory_(resource),       // Empty ledger, nothing allocated yet
+    startingValue_(toPrice(startingCash)),  // Remember starting amount for return calculation
+    sink_(sink)
 {
 }
 
 double Portfolio::getCash() const {
+    return toDollars(cash_);
+}
+
+Price Portfolio::getFixedCash() const {
     return cash_;
 }
 
-double Portfolio::getTotalValue(double currentPrice) const {
+int Portfolio::getShares() const {
+    return position_.getShares();
+}
+
+Price Portfolio::totalValue(double currentPrice) const {
     // Total portfolio value = cash + value of position
-    return cash_ + position_.getCurrentValue(currentPrice);
+    return cash_ + position_.getShares() * toPrice(currentPrice);
+}
+
+double Portfolio::getTotalValue(double currentPrice) const {
+    return toDollars(totalValue(currentPrice));
 }
 
 double Portfolio::getReturn(double currentPrice) const {
     // Calculate percentage return from starting value
-    double currentTotalValue = getTotalValue(currentPrice);
-    return ((currentTotalValue - startingValue_) / startingValue_) * 100.0;
+    Price currentTotalValue = totalValue(currentPrice);
+    return (static_cast<double>(currentTotalValue - startingValue_) / static_cast<double>(startingValue_)) * 100.0;
 }
 
-const std::vector<Trade>& Portfolio::getTradeHistory() const {
+void Portfolio::reset(double startingCash) {
+    cash_ = toPrice(startingCash);
+    position_ = Position();
+    tradeHistory_.clear();
+    startingValue_ = toPrice(startingCash);
+}
+
+void Portfolio::reserveTrades(size_t trades) {
+    tradeHistory_.reserve(trades);
+}
+
+void Portfolio::setEventSink(EventSink* sink) {
+    sink_ = sink;
+}
+
+const TradeLedger& Portfolio::getTradeHistory() const {
     return tradeHistory_;
 } 
 
 void Portfolio::executeSignal(Signal signal, double price, size_t dayIndex) {
+    // the fill price, rounded to a whole micro-dollar with fixed prices
+    Price fill = toPrice(price);
 
     if (signal == Signal::Buy) {
         //buy logic
-        double cashToSpend = cash_ * 0.5;
-        if  (cashToSpend < price) {
-            std::cout << "Day " << dayIndex << ": Not enough cash to buy (need $" 
-            << price << ", have $" << cashToSpend << ")" << std::endl;
+        Price cashToSpend = cash_ / 2;
+        if  (cashToSpend < fill) {
+            emitEvent(sink_, {TradeEventType::RejectedBuy, 0, dayIndex, price, toDollars(cashToSpend)});
             return;
         }
 
-        int sharesToBuy = static_cast<int> (cashToSpend/price);
-        double actualCost = sharesToBuy * price;
+        int sharesToBuy = static_cast<int> (cashToSpend/fill);
+        Price actualCost = sharesToBuy * fill;
 
         //execute purchase
+        if (!position_.buyShares(sharesToBuy,fill)) {
+            emitEvent(sink_, {TradeEventType::InvalidBuy, sharesToBuy, dayIndex, price, 0.0});
+            return;
+        }
         cash_ -= actualCost;
-        position_.buyShares(sharesToBuy,price);
 
-        tradeHistory_.push_back(Trade(Signal::Buy, sharesToBuy, price, dayIndex));
-        std::cout << "Day " << dayIndex << ": BUY " << sharesToBuy 
-                  << " shares at $" << price << " (cost: $" << actualCost << ")" << std::endl;
+        tradeHistory_.record(Signal::Buy, sharesToBuy, fill, dayIndex);
+        emitEvent(sink_, {TradeEventType::Buy, sharesToBuy, dayIndex, price, toDollars(actualCost)});
     }
     else if (signal == Signal::Sell) {
         int sharesToSell = position_.getShares();
         if (sharesToSell == 0) {
-            std::cout << "Day " << dayIndex << ": Cannot sell - own 0 shares" << std::endl;
+            emitEvent(sink_, {TradeEventType::RejectedSell, 0, dayIndex, price, 0.0});
             return;
         }
 
-        double saleProceeds = sharesToSell * price;
+        Price saleProceeds = sharesToSell * fill;
 
-        position_.sellShares(sharesToSell,price);
+        if (!position_.sellShares(sharesToSell,fill)) {
+            emitEvent(sink_, {TradeEventType::InvalidSell, sharesToSell, dayIndex, price,
+                              static_cast<double>(position_.getShares())});
+            return;
+        }
         cash_ += saleProceeds;
 
-        tradeHistory_.push_back(Trade(Signal::Sell,sharesToSell,price,dayIndex));
-        std::cout << "Day " << dayIndex << ": SELL " << sharesToSell 
-                  << " shares at $" << price << " (proceeds: $" << saleProceeds << ")" << std::endl;
+        tradeHistory_.record(Signal::Sell, sharesToSell, fill, dayIndex);
+        emitEvent(sink_, {TradeEventType::Sell, sharesToSell, dayIndex, price, toDollars(saleProceeds)});
     }
     
     else if (signal == Signal::Hold) {
@@ -76,8 +110,8 @@ void Portfolio::printSummary(double currentPrice) const {
     double returnPercent = getReturn(currentPrice);
     
     std::cout << "\n=== PORTFOLIO SUMMARY ===" << std::endl;
-    std::cout << "Starting Value: $" << startingValue_ << std::endl;
-    std::cout << "Current Cash: $" << cash_ << std::endl;
+    std::cout << "Starting Value: $" << toDollars(startingValue_) << std::endl;
+    std::cout << "Current Cash: $" << toDollars(cash_) << std::endl;
     std::cout << "Current Position: " << position_.getShares() << " shares" << std::endl;
     std::cout << "Position Value: $" << position_.getCurrentValue(currentPrice) << std::endl;
     std::cout << "Total Portfolio Value: $" << currentTotalValue << std::endl;
@@ -1,14 +1,12 @@
 #include "position.h"
-#include <iostream>
 
 Position::Position(): shares_(0), averagePrice_(0){
 
 }
 
-void Position::buyShares(int quantity, double price) {
+bool Position::buyShares(int quantity, Price price) {
     if(quantity <= 0) {
-        std::cout << "Error: Cannot buy " << quantity << " shares" << std::endl;
-        return;
+        return false;
     }
 
     if (shares_ == 0) {
@@ -21,25 +19,22 @@ void Position::buyShares(int quantity, double price) {
         updateAveragePrice(quantity, price);
         shares_ += quantity;
     }
+    return true;
 }
 
-void Position::sellShares(int quantity, double price) {
-    if (quantity <= 0) {
-        std::cout << "Error: Cannot sell " << quantity << " shares" << std::endl;
-        return;
-    }
-
-    if (quantity > shares_) {
-        std::cout << "Error: Cannot sell " << quantity << " shares, only own " << shares_ << std::endl;
-        return;
+bool Position::sellShares(int quantity, Price price) {
+    (void)price;
+    if (quantity <= 0 || quantity > shares_) {
+        return false;
     }
     
     shares_ -= quantity;
     
     // If we sold all shares, reset average price
     if (shares_ == 0) {
-        averagePrice_ = 0.0;
+        averagePrice_ = 0;
     }
+    return true;
 }
 
 int Position::getShares() const {
@@ -47,6 +42,10 @@ int Position::getShares() const {
 }
 
 double Position::getAveragePrice() const {
+    return toDollars(averagePrice_);
+}
+
+Price Position::getFixedAveragePrice() const {
     return averagePrice_;
 }
 
@@ -62,15 +61,16 @@ double Position::getUnrealizedPnL(double currentPrice) const {
     if (shares_ == 0) {
         return 0.0;
     }
-    return (currentPrice - averagePrice_) * shares_;
+    return toDollars((toPrice(currentPrice) - averagePrice_) * shares_);
 }
 
-void Position::updateAveragePrice(int newShares, double newPrice) {
+void Position::updateAveragePrice(int newShares, Price newPrice) {
     // Calculate weighted average
     // Total value = (existing shares × existing avg) + (new shares × new price)
     // New average = total value ÷ total shares
     
-    double totalValue = (shares_ * averagePrice_) + (newShares * newPrice);
+    // (whole micro-dollars with fixed prices, the division rounds toward 0)
+    Price totalValue = (shares_ * averagePrice_) + (newShares * newPrice);
     int totalShares = shares_ + newShares;
     averagePrice_ = totalValue / totalShares;
 }
\ No newline at end of file
@@ -1,6 +1,6 @@
 #include "trade.h"
 
-Trade::Trade(Signal type, int quantity, double price, size_t dayIndex):
+Trade::Trade(Signal type, int quantity, Price price, size_t dayIndex):
 type_(type), quantity_(quantity), price_(price), dayIndex_(dayIndex) {
 
 }
@@ -14,6 +14,10 @@ int Trade::getQuantity() const {
 }
 
 double Trade::getPrice() const {
+    return toDollars(price_);
+}
+
+Price Trade::getFixedPrice() const {
     return price_;
 }
 
@@ -22,5 +26,5 @@ size_t Trade::getDayIndex() const {
 }
 
 double Trade::getTotalValue() const {
-    return quantity_ * price_;
+    return toDollars(quantity_ * price_);
 }
\ No newline at end of file
@@ -0,0 +1,163 @@
+#include "trade_ledger.h"
+#include "profiler.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+TradeLedger::TradeLedger(std::pmr::memory_resource* resource) :
+    resource_(resource), block_(nullptr), size_(0), capacity_(0), allocations_(0),
+    prices_(nullptr), quantities_(nullptr), dayIndexes_(nullptr), types_(nullptr) {
+}
+
+TradeLedger::~TradeLedger() {
+    if (block_ != nullptr) {
+        resource_->deallocate(block_, blockBytes(capacity_), alignof(LedgerPrice));
+    }
+}
+
+TradeLedger::TradeLedger(const TradeLedger& other) : TradeLedger(other.resource_) {
+    *this = other;
+}
+
+TradeLedger& TradeLedger::operator=(const TradeLedger& other) {
+    if (this == &other) {
+        return *this;
+    }
+    size_ = 0;
+    if (capacity_ < other.size_) {
+        grow(other.size_);
+    }
+    std::memcpy(prices_, other.prices_, other.size_ * sizeof(LedgerPrice));
+    std::memcpy(quantities_, other.quantities_, other.size_ * sizeof(int32_t));
+    std::memcpy(dayIndexes_, other.dayIndexes_, other.size_ * sizeof(uint32_t));
+    std::memcpy(types_, other.types_, other.size_ * sizeof(Signal));
+    size_ = other.size_;
+    return *this;
+}
+
+TradeLedger::TradeLedger(TradeLedger&& other) noexcept :
+    resource_(other.resource_), block_(other.block_), size_(other.size_), capacity_(other.capacity_),
+    allocations_(other.allocations_), prices_(other.prices_), quantities_(other.quantities_),
+    dayIndexes_(other.dayIndexes_), types_(other.types_) {
+    other.block_ = nullptr;
+    other.size_ = 0;
+    other.capacity_ = 0;
+    other.prices_ = nullptr;
+    other.quantities_ = nullptr;
+    other.dayIndexes_ = nullptr;
+    other.types_ = nullptr;
+}
+
+TradeLedger& TradeLedger::operator=(TradeLedger&& other) {
+    if (this == &other) {
+        return *this;
+    }
+    // blocks can only change hands between ledgers on the same resource
+    if (*resource_ != *other.resource_) {
+        return *this = static_cast<const TradeLedger&>(other);
+    }
+    std::swap(block_, other.block_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(prices_, other.prices_);
+    std::swap(quantities_, other.quantities_);
+    std::swap(dayIndexes_, other.dayIndexes_);
+    std::swap(types_, other.types_);
+    size_ = other.size_;
+    other.size_ = 0;
+    return *this;
+}
+
+size_t TradeLedger::blockBytes(size_t capacity) {
+    return capacity * bytesPerTrade();
+}
+
+void TradeLedger::grow(size_t capacity) {
+    void* block = resource_->allocate(blockBytes(capacity), alignof(LedgerPrice));
+    allocations_++;
+
+    // carve the columns, widest first so no padding is needed between them
+    auto* prices = static_cast<LedgerPrice*>(block);
+    auto* quantities = reinterpret_cast<int32_t*>(prices + capacity);
+    auto* dayIndexes = reinterpret_cast<uint32_t*>(quantities + capacity);
+    auto* types = reinterpret_cast<Signal*>(dayIndexes + capacity);
+
+    if (block_ != nullptr) {
+        std::memcpy(prices, prices_, size_ * sizeof(LedgerPrice));
+        std::memcpy(quantities, quantities_, size_ * sizeof(int32_t));
+        std::memcpy(dayIndexes, dayIndexes_, size_ * sizeof(uint32_t));
+        std::memcpy(types, types_, size_ * sizeof(Signal));
+        resource_->deallocate(block_, blockBytes(capacity_), alignof(LedgerPrice));
+    }
+
+    block_ = block;
+    capacity_ = capacity;
+    prices_ = prices;
+    quantities_ = quantities;
+    dayIndexes_ = dayIndexes;
+    types_ = types;
+}
+
+void TradeLedger::record(Signal type, int quantity, Price price, size_t dayIndex) {
+    BACKTESTER_PROFILE_SAMPLE(ProfileStage::Record);
+    if (dayIndex > UINT32_MAX) {
+        throw std::out_of_range("TradeLedger: bar index does not fit in 32 bits");
+    }
+    if (size_ == capacity_) {
+        grow(std::max<size_t>(capacity_ * 2, 64));
+    }
+    prices_[size_] = static_cast<LedgerPrice>(price);
+    quantities_[size_] = quantity;
+    dayIndexes_[size_] = static_cast<uint32_t>(dayIndex);
+    types_[size_] = type;
+    size_++;
+}
+
+void TradeLedger::reserve(size_t trades) {
+    if (trades > capacity_) {
+        grow(trades);
+    }
+}
+
+void TradeLedger::clear() {
+    size_ = 0;
+}
+
+size_t TradeLedger::size() const {
+    return size_;
+}
+
+bool TradeLedger::empty() const {
+    return size_ == 0;
+}
+
+size_t TradeLedger::capacity() const {
+    return capacity_;
+}
+
+Trade TradeLedger::operator[](size_t index) const {
+    if (index >= size_) {
+        throw std::out_of_range("TradeLedger: trade index out of range");
+    }
+    return Trade(types_[index], quantities_[index], prices_[index], dayIndexes_[index]);
+}
+
+size_t TradeLedger::allocations() const {
+    return allocations_;
+}
+
+const Signal* TradeLedger::types() const {
+    return types_;
+}
+
+const int32_t* TradeLedger::quantities() const {
+    return quantities_;
+}
+
+const uint32_t* TradeLedger::dayIndexes() const {
+    return dayIndexes_;
+}
+
+const LedgerPrice* TradeLedger::prices() const {
+    return prices_;
+}
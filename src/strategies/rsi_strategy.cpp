@@ -1,20 +1,116 @@
 #include "rsi_strategy.h"
+#include "signal_kernels.h"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
 
-RSIStrategy::RSIStrategy(int rsi_period) : rsi_period_(rsi_period) {
+RSIStrategy::RSIStrategy(int rsi_period, double oversold, double overbought) :
+    rsi_period_(rsi_period), oversold_(oversold), overbought_(overbought), rsi_(rsi_period), series_(nullptr), nextIndex_(0), useCache_(true) {
     // Constructor body
 }
 
+void RSIStrategy::advanceTo(const ColumnView<double>& close, size_t index) {
+    bool sameSeries = close.data() == series_;
+    if (sameSeries && index + 1 == nextIndex_) {
+        return;  // same bar asked again
+    }
+
+    if (!sameSeries || index != nextIndex_) {
+        // not the next bar: rebuild from the rsi_period changes ending at index
+        rsi_.reset();
+        size_t window = static_cast<size_t>(rsi_period_);
+        series_ = close.data();
+        nextIndex_ = index >= window ? index - window : 0;
+    }
+
+    for (; nextIndex_ <= index; nextIndex_++) {
+        rsi_.update(close[nextIndex_]);
+    }
+}
+
 
 Signal RSIStrategy::analyze(const MarketData& data, size_t index) {
-    double rsi = calculateRSI(data, index,rsi_period_);
-    if (rsi < 30) return Signal::Buy;
-    if (rsi > 70) return Signal::Sell;
+    if (index >= data.size()) {
+        throw std::out_of_range("index out of range");
+    }
+    advanceTo(data.close(), index);
+    return signal();
+}
+
+Signal RSIStrategy::onBar(const Bar& bar) {
+    if (series_ != nullptr) {
+        // the RSI was built by analyze()
+        resetBars();
+    }
+    rsi_.update(bar.close);
+    return signal();
+}
+
+void RSIStrategy::resetBars() {
+    rsi_.reset();
+    series_ = nullptr;
+    nextIndex_ = 0;
+}
+
+Signal RSIStrategy::signal() const {
+    // 50 until there are rsi_period changes, same as calculateRSI
+    double rsi = rsi_.ready() ? rsi_.value() : 50.0;
+    if (rsi < oversold_) return Signal::Buy;
+    if (rsi > overbought_) return Signal::Sell;
     return Signal::Hold;
 }
 
+void RSIStrategy::analyzeRange(const MarketData& data, size_t first, size_t last, Signal* out) {
+    if (first > last || last > data.size()) {
+        throw std::out_of_range("range out of range");
+    }
+    if (first == last) {
+        return;
+    }
+
+    // start where analyze(data, first) would rebuild from
+    size_t window = static_cast<size_t>(rsi_period_);
+    size_t start = first >= window ? first - window : 0;
+
+    if (useCache_) {
+        // one series per period, shared by every threshold pair
+        MarketData bars = data.slice(start, last - start);
+        IndicatorCache::Series rsi = bars.indicator(IndicatorKind::RSI, window);
+        // not ready before `window` changes, analyze() uses 50 there
+        size_t ready = std::min(std::max(first, start + std::max<size_t>(window, 1)), last);
+        Signal warmup = Signal::Hold;
+        if (50.0 < oversold_) warmup = Signal::Buy;
+        else if (50.0 > overbought_) warmup = Signal::Sell;
+        std::fill(out, out + (ready - first), warmup);
+        SignalKernels::thresholds(rsi->data() + (ready - start), last - ready, oversold_, overbought_,
+                                  out + (ready - first));
+        return;
+    }
+
+    ColumnView<double> close = data.close().subview(start, last - start);
+
+    // Layout::Rows has no plain close array, gather one
+    std::vector<double> gathered;
+    if (!close.isContiguous()) {
+        gathered.resize(close.size());
+        close.copyTo(gathered.data());
+    }
+    const double* series = close.isContiguous() ? close.data() : gathered.data();
+
+    SignalKernels::rsiThreshold(series, close.size(), window, oversold_, overbought_, first - start, out);
+}
+
+void RSIStrategy::setIndicatorCache(bool enabled) {
+    useCache_ = enabled;
+}
+
+size_t RSIStrategy::lookback() const {
+    return static_cast<size_t>(std::max(rsi_period_, 0)) + 1;
+}
 
 double RSIStrategy::calculateRSI(const MarketData& data, size_t index, int period) {
     if (index < period) return 50.0;
+    ColumnView<double> close = data.close();
     double totalGain = 0.0;
     double totalLoss = 0.0;
 
@@ -23,8 +119,8 @@ double RSIStrategy::calculateRSI(const MarketData& data, size_t index, int perio
         size_t yesterday_idx = index - i - 1;
 
         //calculate change:
-        double today_price = data.getBar(today_idx).close;
-        double yesterday_price = data.getBar(yesterday_idx).close;
+        double today_price = close[today_idx];
+        double yesterday_price = close[yesterday_idx];
         double change = today_price - yesterday_price;
 
         if (change > 0) {
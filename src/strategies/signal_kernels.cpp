@@ -0,0 +1,584 @@
+#include "signal_kernels.h"
+#include "indicators.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define BACKTESTER_X86_KERNELS 1
+#else
+#define BACKTESTER_X86_KERNELS 0
+#endif
+
+// the SIMD passes build each signal as Hold - buy + sell
+static_assert(static_cast<int>(Signal::Buy) == 0 && static_cast<int>(Signal::Hold) == 1 &&
+              static_cast<int>(Signal::Sell) == 2, "signal kernels rely on the Signal values");
+
+namespace {
+
+// bars per pass, small enough that a block's scratch columns stay in L1
+// between the element-wise passes and the scalar scan
+constexpr size_t kBlock = 512;
+
+inline Signal signalFrom(bool buy, bool sell) {
+    if (buy) return Signal::Buy;
+    if (sell) return Signal::Sell;
+    return Signal::Hold;
+}
+
+// ---------------- scalar passes (fallback and SIMD tails) ----------------
+
+void subtractScalar(const double* a, const double* b, size_t n, double* out) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = a[i] - b[i];
+    }
+}
+
+void crossoverScalar(const double* shortSum, const double* longSum, size_t n,
+                     double shortPeriod, double longPeriod, Signal* out) {
+    for (size_t i = 0; i < n; i++) {
+        double shortMA = shortSum[i] / shortPeriod;
+        double longMA = longSum[i] / longPeriod;
+        bool live = !(shortMA == 0.0) && !(longMA == 0.0);
+        out[i] = signalFrom(live && shortMA > longMA, live && shortMA < longMA);
+    }
+}
+
+// per-bar increments of RollingRSI's totals and day counts for bars
+// [from, to), all of which drop the change of bar i - period
+void rsiDeltasScalar(const double* close, size_t from, size_t to, size_t period,
+                     double* gain, double* loss, double* gainDays, double* lossDays) {
+    for (size_t i = from; i < to; i++) {
+        double change = close[i] - close[i - 1];
+        double dropped = close[i - period] - close[i - period - 1];
+        size_t j = i - from;
+        gain[j] = gainOf(change) - gainOf(dropped);
+        loss[j] = lossOf(change) - lossOf(dropped);
+        gainDays[j] = (gainOf(change) > 0 ? 1.0 : 0.0) - (gainOf(dropped) > 0 ? 1.0 : 0.0);
+        lossDays[j] = (lossOf(change) > 0 ? 1.0 : 0.0) - (lossOf(dropped) > 0 ? 1.0 : 0.0);
+    }
+}
+
+void rsiScalar(const double* gainSum, const double* lossSum, size_t n, double period,
+               double oversold, double overbought, Signal* out) {
+    for (size_t i = 0; i < n; i++) {
+        double averageGain = gainSum[i] / period;
+        double averageLoss = lossSum[i] / period;
+        double rsi = averageLoss == 0 ? 100.0 : 100.0 - (100.0 / (1.0 + averageGain / averageLoss));
+        out[i] = signalFrom(rsi < oversold, rsi > overbought);
+    }
+}
+
+void thresholdsScalar(const double* values, size_t n, double low, double high, Signal* out) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = signalFrom(values[i] < low, values[i] > high);
+    }
+}
+
+struct KernelSet {
+    void (*subtract)(const double*, const double*, size_t, double*);
+    void (*crossover)(const double*, const double*, size_t, double, double, Signal*);
+    void (*rsiDeltas)(const double*, size_t, size_t, size_t, double*, double*, double*, double*);
+    void (*rsi)(const double*, const double*, size_t, double, double, double, Signal*);
+    void (*thresholds)(const double*, size_t, double, double, Signal*);
+};
+
+const KernelSet kScalarKernels = {subtractScalar, crossoverScalar, rsiDeltasScalar, rsiScalar, thresholdsScalar};
+
+#if BACKTESTER_X86_KERNELS
+
+// four signals packed little endian, indexed by [buy lane bits | sell lane bits << 4]
+struct SignalQuads {
+    uint32_t packed[256];
+
+    constexpr SignalQuads() : packed() {
+        for (int index = 0; index < 256; index++) {
+            uint32_t word = 0;
+            for (int lane = 0; lane < 4; lane++) {
+                int buy = (index >> lane) & 1;
+                int sell = (index >> (lane + 4)) & 1 & (buy ^ 1);  // buy wins, as in analyze()
+                word |= static_cast<uint32_t>(1 - buy + sell) << (8 * lane);
+            }
+            packed[index] = word;
+        }
+    }
+};
+
+constexpr SignalQuads kSignalQuads;
+
+inline void storeQuad(Signal* out, int buyBits, int sellBits) {
+    std::memcpy(out, &kSignalQuads.packed[buyBits | (sellBits << 4)], 4);
+}
+
+// ---------------- SSE2 ----------------
+
+__attribute__((target("sse2")))
+void subtractSse2(const double* a, const double* b, size_t n, double* out) {
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        _mm_storeu_pd(out + i, _mm_sub_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+    }
+    subtractScalar(a + i, b + i, n - i, out + i);
+}
+
+__attribute__((target("sse2")))
+void crossoverSse2(const double* shortSum, const double* longSum, size_t n,
+                   double shortPeriod, double longPeriod, Signal* out) {
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d shortDivisor = _mm_set1_pd(shortPeriod);
+    const __m128d longDivisor = _mm_set1_pd(longPeriod);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        int buy = 0;
+        int sell = 0;
+        for (size_t half = 0; half < 4; half += 2) {
+            __m128d shortMA = _mm_div_pd(_mm_loadu_pd(shortSum + i + half), shortDivisor);
+            __m128d longMA = _mm_div_pd(_mm_loadu_pd(longSum + i + half), longDivisor);
+            __m128d live = _mm_and_pd(_mm_cmpneq_pd(shortMA, zero), _mm_cmpneq_pd(longMA, zero));
+            buy |= _mm_movemask_pd(_mm_and_pd(live, _mm_cmpgt_pd(shortMA, longMA))) << half;
+            sell |= _mm_movemask_pd(_mm_and_pd(live, _mm_cmplt_pd(shortMA, longMA))) << half;
+        }
+        storeQuad(out + i, buy, sell);
+    }
+    crossoverScalar(shortSum + i, longSum + i, n - i, shortPeriod, longPeriod, out + i);
+}
+
+__attribute__((target("sse2")))
+void rsiDeltasSse2(const double* close, size_t from, size_t to, size_t period,
+                   double* gain, double* loss, double* gainDays, double* lossDays) {
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d one = _mm_set1_pd(1.0);
+    const __m128d sign = _mm_set1_pd(-0.0);
+    size_t i = from;
+    for (; i + 2 <= to; i += 2) {
+        __m128d change = _mm_sub_pd(_mm_loadu_pd(close + i), _mm_loadu_pd(close + i - 1));
+        __m128d dropped = _mm_sub_pd(_mm_loadu_pd(close + i - period), _mm_loadu_pd(close + i - period - 1));
+        __m128d changeUp = _mm_cmpgt_pd(change, zero);
+        __m128d droppedUp = _mm_cmpgt_pd(dropped, zero);
+        size_t j = i - from;
+        _mm_storeu_pd(gain + j, _mm_sub_pd(_mm_and_pd(changeUp, change), _mm_and_pd(droppedUp, dropped)));
+        _mm_storeu_pd(loss + j, _mm_sub_pd(_mm_andnot_pd(changeUp, _mm_xor_pd(change, sign)),
+                                           _mm_andnot_pd(droppedUp, _mm_xor_pd(dropped, sign))));
+        _mm_storeu_pd(gainDays + j, _mm_sub_pd(_mm_and_pd(changeUp, one), _mm_and_pd(droppedUp, one)));
+        _mm_storeu_pd(lossDays + j, _mm_sub_pd(_mm_and_pd(_mm_cmplt_pd(change, zero), one),
+                                               _mm_and_pd(_mm_cmplt_pd(dropped, zero), one)));
+    }
+    size_t done = i - from;
+    rsiDeltasScalar(close, i, to, period, gain + done, loss + done, gainDays + done, lossDays + done);
+}
+
+__attribute__((target("sse2")))
+void rsiSse2(const double* gainSum, const double* lossSum, size_t n, double period,
+             double oversold, double overbought, Signal* out) {
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d one = _mm_set1_pd(1.0);
+    const __m128d hundred = _mm_set1_pd(100.0);
+    const __m128d divisor = _mm_set1_pd(period);
+    const __m128d low = _mm_set1_pd(oversold);
+    const __m128d high = _mm_set1_pd(overbought);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        int buy = 0;
+        int sell = 0;
+        for (size_t half = 0; half < 4; half += 2) {
+            __m128d averageGain = _mm_div_pd(_mm_loadu_pd(gainSum + i + half), divisor);
+            __m128d averageLoss = _mm_div_pd(_mm_loadu_pd(lossSum + i + half), divisor);
+            __m128d rsi = _mm_sub_pd(hundred, _mm_div_pd(hundred, _mm_add_pd(one, _mm_div_pd(averageGain, averageLoss))));
+            __m128d flat = _mm_cmpeq_pd(averageLoss, zero);
+            rsi = _mm_or_pd(_mm_and_pd(flat, hundred), _mm_andnot_pd(flat, rsi));
+            buy |= _mm_movemask_pd(_mm_cmplt_pd(rsi, low)) << half;
+            sell |= _mm_movemask_pd(_mm_cmpgt_pd(rsi, high)) << half;
+        }
+        storeQuad(out + i, buy, sell);
+    }
+    rsiScalar(gainSum + i, lossSum + i, n - i, period, oversold, overbought, out + i);
+}
+
+__attribute__((target("sse2")))
+void thresholdsSse2(const double* values, size_t n, double low, double high, Signal* out) {
+    const __m128d lowVector = _mm_set1_pd(low);
+    const __m128d highVector = _mm_set1_pd(high);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128d first = _mm_loadu_pd(values + i);
+        __m128d second = _mm_loadu_pd(values + i + 2);
+        int buy = _mm_movemask_pd(_mm_cmplt_pd(first, lowVector)) | _mm_movemask_pd(_mm_cmplt_pd(second, lowVector)) << 2;
+        int sell = _mm_movemask_pd(_mm_cmpgt_pd(first, highVector)) | _mm_movemask_pd(_mm_cmpgt_pd(second, highVector)) << 2;
+        storeQuad(out + i, buy, sell);
+    }
+    thresholdsScalar(values + i, n - i, low, high, out + i);
+}
+
+const KernelSet kSse2Kernels = {subtractSse2, crossoverSse2, rsiDeltasSse2, rsiSse2, thresholdsSse2};
+
+// ---------------- AVX2 ----------------
+
+__attribute__((target("avx2")))
+void subtractAvx2(const double* a, const double* b, size_t n, double* out) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(out + i, _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    }
+    subtractScalar(a + i, b + i, n - i, out + i);
+}
+
+__attribute__((target("avx2")))
+void crossoverAvx2(const double* shortSum, const double* longSum, size_t n,
+                   double shortPeriod, double longPeriod, Signal* out) {
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d shortDivisor = _mm256_set1_pd(shortPeriod);
+    const __m256d longDivisor = _mm256_set1_pd(longPeriod);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d shortMA = _mm256_div_pd(_mm256_loadu_pd(shortSum + i), shortDivisor);
+        __m256d longMA = _mm256_div_pd(_mm256_loadu_pd(longSum + i), longDivisor);
+        __m256d live = _mm256_and_pd(_mm256_cmp_pd(shortMA, zero, _CMP_NEQ_UQ),
+                                     _mm256_cmp_pd(longMA, zero, _CMP_NEQ_UQ));
+        int buy = _mm256_movemask_pd(_mm256_and_pd(live, _mm256_cmp_pd(shortMA, longMA, _CMP_GT_OQ)));
+        int sell = _mm256_movemask_pd(_mm256_and_pd(live, _mm256_cmp_pd(shortMA, longMA, _CMP_LT_OQ)));
+        storeQuad(out + i, buy, sell);
+    }
+    crossoverScalar(shortSum + i, longSum + i, n - i, shortPeriod, longPeriod, out + i);
+}
+
+__attribute__((target("avx2")))
+void rsiDeltasAvx2(const double* close, size_t from, size_t to, size_t period,
+                   double* gain, double* loss, double* gainDays, double* lossDays) {
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    size_t i = from;
+    for (; i + 4 <= to; i += 4) {
+        __m256d change = _mm256_sub_pd(_mm256_loadu_pd(close + i), _mm256_loadu_pd(close + i - 1));
+        __m256d dropped = _mm256_sub_pd(_mm256_loadu_pd(close + i - period), _mm256_loadu_pd(close + i - period - 1));
+        __m256d changeUp = _mm256_cmp_pd(change, zero, _CMP_GT_OQ);
+        __m256d droppedUp = _mm256_cmp_pd(dropped, zero, _CMP_GT_OQ);
+        __m256d changeDown = _mm256_cmp_pd(change, zero, _CMP_LT_OQ);
+        __m256d droppedDown = _mm256_cmp_pd(dropped, zero, _CMP_LT_OQ);
+        size_t j = i - from;
+        _mm256_storeu_pd(gain + j, _mm256_sub_pd(_mm256_and_pd(changeUp, change), _mm256_and_pd(droppedUp, dropped)));
+        _mm256_storeu_pd(loss + j, _mm256_sub_pd(_mm256_andnot_pd(changeUp, _mm256_xor_pd(change, sign)),
+                                                 _mm256_andnot_pd(droppedUp, _mm256_xor_pd(dropped, sign))));
+        _mm256_storeu_pd(gainDays + j, _mm256_sub_pd(_mm256_and_pd(changeUp, one), _mm256_and_pd(droppedUp, one)));
+        _mm256_storeu_pd(lossDays + j, _mm256_sub_pd(_mm256_and_pd(changeDown, one), _mm256_and_pd(droppedDown, one)));
+    }
+    size_t done = i - from;
+    rsiDeltasScalar(close, i, to, period, gain + done, loss + done, gainDays + done, lossDays + done);
+}
+
+__attribute__((target("avx2")))
+void rsiAvx2(const double* gainSum, const double* lossSum, size_t n, double period,
+             double oversold, double overbought, Signal* out) {
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d hundred = _mm256_set1_pd(100.0);
+    const __m256d divisor = _mm256_set1_pd(period);
+    const __m256d low = _mm256_set1_pd(oversold);
+    const __m256d high = _mm256_set1_pd(overbought);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d averageGain = _mm256_div_pd(_mm256_loadu_pd(gainSum + i), divisor);
+        __m256d averageLoss = _mm256_div_pd(_mm256_loadu_pd(lossSum + i), divisor);
+        __m256d rsi = _mm256_sub_pd(hundred, _mm256_div_pd(hundred, _mm256_add_pd(one, _mm256_div_pd(averageGain, averageLoss))));
+        rsi = _mm256_blendv_pd(rsi, hundred, _mm256_cmp_pd(averageLoss, zero, _CMP_EQ_OQ));
+        int buy = _mm256_movemask_pd(_mm256_cmp_pd(rsi, low, _CMP_LT_OQ));
+        int sell = _mm256_movemask_pd(_mm256_cmp_pd(rsi, high, _CMP_GT_OQ));
+        storeQuad(out + i, buy, sell);
+    }
+    rsiScalar(gainSum + i, lossSum + i, n - i, period, oversold, overbought, out + i);
+}
+
+__attribute__((target("avx2")))
+void thresholdsAvx2(const double* values, size_t n, double low, double high, Signal* out) {
+    const __m256d lowVector = _mm256_set1_pd(low);
+    const __m256d highVector = _mm256_set1_pd(high);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d value = _mm256_loadu_pd(values + i);
+        int buy = _mm256_movemask_pd(_mm256_cmp_pd(value, lowVector, _CMP_LT_OQ));
+        int sell = _mm256_movemask_pd(_mm256_cmp_pd(value, highVector, _CMP_GT_OQ));
+        storeQuad(out + i, buy, sell);
+    }
+    thresholdsScalar(values + i, n - i, low, high, out + i);
+}
+
+const KernelSet kAvx2Kernels = {subtractAvx2, crossoverAvx2, rsiDeltasAvx2, rsiAvx2, thresholdsAvx2};
+
+// ---------------- AVX-512 (F only) ----------------
+
+__attribute__((target("avx512f")))
+void subtractAvx512(const double* a, const double* b, size_t n, double* out) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm512_storeu_pd(out + i, _mm512_sub_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i)));
+    }
+    subtractScalar(a + i, b + i, n - i, out + i);
+}
+
+__attribute__((target("avx512f")))
+void crossoverAvx512(const double* shortSum, const double* longSum, size_t n,
+                     double shortPeriod, double longPeriod, Signal* out) {
+    const __m512d zero = _mm512_setzero_pd();
+    const __m512d shortDivisor = _mm512_set1_pd(shortPeriod);
+    const __m512d longDivisor = _mm512_set1_pd(longPeriod);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512d shortMA = _mm512_div_pd(_mm512_loadu_pd(shortSum + i), shortDivisor);
+        __m512d longMA = _mm512_div_pd(_mm512_loadu_pd(longSum + i), longDivisor);
+        __mmask8 live = _mm512_cmp_pd_mask(shortMA, zero, _CMP_NEQ_UQ) & _mm512_cmp_pd_mask(longMA, zero, _CMP_NEQ_UQ);
+        int buy = live & _mm512_cmp_pd_mask(shortMA, longMA, _CMP_GT_OQ);
+        int sell = live & _mm512_cmp_pd_mask(shortMA, longMA, _CMP_LT_OQ);
+        storeQuad(out + i, buy & 15, sell & 15);
+        storeQuad(out + i + 4, buy >> 4, sell >> 4);
+    }
+    crossoverScalar(shortSum + i, longSum + i, n - i, shortPeriod, longPeriod, out + i);
+}
+
+__attribute__((target("avx512f")))
+void rsiDeltasAvx512(const double* close, size_t from, size_t to, size_t period,
+                     double* gain, double* loss, double* gainDays, double* lossDays) {
+    const __m512d zero = _mm512_setzero_pd();
+    const __m512d one = _mm512_set1_pd(1.0);
+    const __m512i sign = _mm512_set1_epi64(INT64_MIN);
+    size_t i = from;
+    for (; i + 8 <= to; i += 8) {
+        __m512d change = _mm512_sub_pd(_mm512_loadu_pd(close + i), _mm512_loadu_pd(close + i - 1));
+        __m512d dropped = _mm512_sub_pd(_mm512_loadu_pd(close + i - period), _mm512_loadu_pd(close + i - period - 1));
+        __mmask8 changeUp = _mm512_cmp_pd_mask(change, zero, _CMP_GT_OQ);
+        __mmask8 droppedUp = _mm512_cmp_pd_mask(dropped, zero, _CMP_GT_OQ);
+        __mmask8 changeDown = _mm512_cmp_pd_mask(change, zero, _CMP_LT_OQ);
+        __mmask8 droppedDown = _mm512_cmp_pd_mask(dropped, zero, _CMP_LT_OQ);
+        // exact negation, xor of the sign bit (AVX-512F has no xor_pd)
+        __m512d changeNegated = _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(change), sign));
+        __m512d droppedNegated = _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(dropped), sign));
+        size_t j = i - from;
+        _mm512_storeu_pd(gain + j, _mm512_sub_pd(_mm512_maskz_mov_pd(changeUp, change),
+                                                 _mm512_maskz_mov_pd(droppedUp, dropped)));
+        _mm512_storeu_pd(loss + j, _mm512_sub_pd(_mm512_maskz_mov_pd(static_cast<__mmask8>(~changeUp), changeNegated),
+                                                 _mm512_maskz_mov_pd(static_cast<__mmask8>(~droppedUp), droppedNegated)));
+        _mm512_storeu_pd(gainDays + j, _mm512_sub_pd(_mm512_maskz_mov_pd(changeUp, one),
+                                                     _mm512_maskz_mov_pd(droppedUp, one)));
+        _mm512_storeu_pd(lossDays + j, _mm512_sub_pd(_mm512_maskz_mov_pd(changeDown, one),
+                                                     _mm512_maskz_mov_pd(droppedDown, one)));
+    }
+    size_t done = i - from;
+    rsiDeltasScalar(close, i, to, period, gain + done, loss + done, gainDays + done, lossDays + done);
+}
+
+__attribute__((target("avx512f")))
+void rsiAvx512(const double* gainSum, const double* lossSum, size_t n, double period,
+               double oversold, double overbought, Signal* out) {
+    const __m512d zero = _mm512_setzero_pd();
+    const __m512d one = _mm512_set1_pd(1.0);
+    const __m512d hundred = _mm512_set1_pd(100.0);
+    const __m512d divisor = _mm512_set1_pd(period);
+    const __m512d low = _mm512_set1_pd(oversold);
+    const __m512d high = _mm512_set1_pd(overbought);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512d averageGain = _mm512_div_pd(_mm512_loadu_pd(gainSum + i), divisor);
+        __m512d averageLoss = _mm512_div_pd(_mm512_loadu_pd(lossSum + i), divisor);
+        __m512d rsi = _mm512_sub_pd(hundred, _mm512_div_pd(hundred, _mm512_add_pd(one, _mm512_div_pd(averageGain, averageLoss))));
+        rsi = _mm512_mask_mov_pd(rsi, _mm512_cmp_pd_mask(averageLoss, zero, _CMP_EQ_OQ), hundred);
+        int buy = _mm512_cmp_pd_mask(rsi, low, _CMP_LT_OQ);
+        int sell = _mm512_cmp_pd_mask(rsi, high, _CMP_GT_OQ);
+        storeQuad(out + i, buy & 15, sell & 15);
+        storeQuad(out + i + 4, buy >> 4, sell >> 4);
+    }
+    rsiScalar(gainSum + i, lossSum + i, n - i, period, oversold, overbought, out + i);
+}
+
+__attribute__((target("avx512f")))
+void thresholdsAvx512(const double* values, size_t n, double low, double high, Signal* out) {
+    const __m512d lowVector = _mm512_set1_pd(low);
+    const __m512d highVector = _mm512_set1_pd(high);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512d value = _mm512_loadu_pd(values + i);
+        int buy = _mm512_cmp_pd_mask(value, lowVector, _CMP_LT_OQ);
+        int sell = _mm512_cmp_pd_mask(value, highVector, _CMP_GT_OQ);
+        storeQuad(out + i, buy & 15, sell & 15);
+        storeQuad(out + i + 4, buy >> 4, sell >> 4);
+    }
+    thresholdsScalar(values + i, n - i, low, high, out + i);
+}
+
+const KernelSet kAvx512Kernels = {subtractAvx512, crossoverAvx512, rsiDeltasAvx512, rsiAvx512, thresholdsAvx512};
+
+#endif
+
+std::atomic<int>& activeLevelSlot() {
+    static std::atomic<int> level(static_cast<int>(SignalKernels::supportedLevel()));
+    return level;
+}
+
+const KernelSet& activeKernels() {
+    switch (SignalKernels::activeLevel()) {
+#if BACKTESTER_X86_KERNELS
+        case SignalKernels::Level::AVX512: return kAvx512Kernels;
+        case SignalKernels::Level::AVX2: return kAvx2Kernels;
+        case SignalKernels::Level::SSE2: return kSse2Kernels;
+#endif
+        default: return kScalarKernels;
+    }
+}
+
+// out[i - begin] = close[i] - close[i - period] for bars [begin, end), with
+// 0.0 dropping out while the window is still filling (like RollingWindow)
+void windowDifferences(const KernelSet& kernels, const double* close, size_t begin, size_t end,
+                       size_t period, double* out) {
+    size_t split = std::min(end, std::max(begin, period));
+    for (size_t i = begin; i < split; i++) {
+        out[i - begin] = close[i] - 0.0;
+    }
+    if (split < end) {
+        kernels.subtract(close + split, close + split - period, end - split, out + (split - begin));
+    }
+}
+
+}
+
+SignalKernels::Level SignalKernels::supportedLevel() {
+#if BACKTESTER_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return Level::AVX512;
+    if (__builtin_cpu_supports("avx2")) return Level::AVX2;
+    if (__builtin_cpu_supports("sse2")) return Level::SSE2;
+#endif
+    return Level::Scalar;
+}
+
+SignalKernels::Level SignalKernels::activeLevel() {
+    return static_cast<Level>(activeLevelSlot().load(std::memory_order_relaxed));
+}
+
+void SignalKernels::setLevel(Level level) {
+    Level supported = supportedLevel();
+    if (static_cast<int>(level) > static_cast<int>(supported)) {
+        level = supported;
+    }
+    activeLevelSlot().store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+const char* SignalKernels::levelName(Level level) {
+    switch (level) {
+        case Level::Scalar: return "scalar";
+        case Level::SSE2: return "sse2";
+        case Level::AVX2: return "avx2";
+        case Level::AVX512: return "avx512";
+        default: return "unknown";
+    }
+}
+
+void SignalKernels::smaCrossover(const double* close, size_t count, size_t shortPeriod, size_t longPeriod,
+                                 size_t first, Signal* out) {
+    const KernelSet& kernels = activeKernels();
+    // a RollingWindow never holds fewer than one value
+    shortPeriod = std::max<size_t>(shortPeriod, 1);
+    longPeriod = std::max<size_t>(longPeriod, 1);
+    // Hold until both averages have a full window
+    size_t warm = std::max(shortPeriod, longPeriod) - 1;
+
+    alignas(64) double shortDiff[kBlock];
+    alignas(64) double longDiff[kBlock];
+    alignas(64) double shortSum[kBlock];
+    alignas(64) double longSum[kBlock];
+    double shortRunning = 0.0;
+    double longRunning = 0.0;
+
+    for (size_t begin = 0; begin < count; begin += kBlock) {
+        size_t end = std::min(count, begin + kBlock);
+        windowDifferences(kernels, close, begin, end, shortPeriod, shortDiff);
+        windowDifferences(kernels, close, begin, end, longPeriod, longDiff);
+
+        // the only serial part, same additions in the same order as RollingSMA
+        for (size_t j = 0; j < end - begin; j++) {
+            shortRunning += shortDiff[j];
+            shortSum[j] = shortRunning;
+            longRunning += longDiff[j];
+            longSum[j] = longRunning;
+        }
+
+        size_t from = std::max(begin, first);
+        if (from >= end) {
+            continue;
+        }
+        size_t live = std::max(from, std::min(end, warm));
+        std::fill(out + (from - first), out + (live - first), Signal::Hold);
+        kernels.crossover(shortSum + (live - begin), longSum + (live - begin), end - live,
+                          static_cast<double>(shortPeriod), static_cast<double>(longPeriod), out + (live - first));
+    }
+}
+
+void SignalKernels::rsiThreshold(const double* close, size_t count, size_t period,
+                                 double oversold, double overbought, size_t first, Signal* out) {
+    const KernelSet& kernels = activeKernels();
+    period = std::max<size_t>(period, 1);
+
+    alignas(64) double gain[kBlock];
+    alignas(64) double loss[kBlock];
+    alignas(64) double gainDays[kBlock];
+    alignas(64) double lossDays[kBlock];
+    alignas(64) double gainSum[kBlock];
+    alignas(64) double lossSum[kBlock];
+    double totalGain = 0.0;
+    double totalLoss = 0.0;
+    double gainDayCount = 0.0;  // small integers, exact in a double
+    double lossDayCount = 0.0;
+
+    for (size_t begin = 0; begin < count; begin += kBlock) {
+        size_t end = std::min(count, begin + kBlock);
+
+        // bar 0 has no change and the next `period` bars drop nothing
+        size_t split = std::min(end, std::max(begin, period + 1));
+        for (size_t i = begin; i < split; i++) {
+            size_t j = i - begin;
+            if (i == 0) {
+                gain[j] = loss[j] = gainDays[j] = lossDays[j] = 0.0;
+                continue;
+            }
+            double change = close[i] - close[i - 1];
+            gain[j] = gainOf(change) - gainOf(0.0);
+            loss[j] = lossOf(change) - lossOf(0.0);
+            gainDays[j] = gainOf(change) > 0 ? 1.0 : 0.0;
+            lossDays[j] = lossOf(change) > 0 ? 1.0 : 0.0;
+        }
+        if (split < end) {
+            size_t j = split - begin;
+            kernels.rsiDeltas(close, split, end, period, gain + j, loss + j, gainDays + j, lossDays + j);
+        }
+
+        // serial part, mirrors RollingRSI::update() including the reset to exactly 0.0
+        for (size_t j = 0; j < end - begin; j++) {
+            totalGain += gain[j];
+            totalLoss += loss[j];
+            gainDayCount += gainDays[j];
+            lossDayCount += lossDays[j];
+            if (gainDayCount == 0) totalGain = 0.0;
+            if (lossDayCount == 0) totalLoss = 0.0;
+            gainSum[j] = totalGain;
+            lossSum[j] = totalLoss;
+        }
+
+        size_t from = std::max(begin, first);
+        if (from >= end) {
+            continue;
+        }
+        // analyze() uses an RSI of 50 until there are `period` changes
+        size_t ready = std::max(from, std::min(end, period));
+        std::fill(out + (from - first), out + (ready - first), signalFrom(50.0 < oversold, 50.0 > overbought));
+        kernels.rsi(gainSum + (ready - begin), lossSum + (ready - begin), end - ready,
+                    static_cast<double>(period), oversold, overbought, out + (ready - first));
+    }
+}
+
+void SignalKernels::crossover(const double* shortMA, const double* longMA, size_t count, Signal* out) {
+    // dividing by 1.0 is exact, so the averages go through unchanged
+    activeKernels().crossover(shortMA, longMA, count, 1.0, 1.0, out);
+}
+
+void SignalKernels::thresholds(const double* values, size_t count, double low, double high, Signal* out) {
+    activeKernels().thresholds(values, count, low, high, out);
+}
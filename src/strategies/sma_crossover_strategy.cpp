@@ -1,12 +1,83 @@
 #include "sma_crossover_strategy.h"
+#include "signal_kernels.h"
+#include <algorithm>
 #include <iostream>
+#include <stdexcept>
+#include <vector>
 
 SMACrossoverStrategy::SMACrossoverStrategy(int short_period, int long_period):
-short_period_(short_period), long_period_(long_period) {
+short_period_(short_period), long_period_(long_period),
+shortMA_(short_period), longMA_(long_period), series_(nullptr), nextIndex_(0), useCache_(true) {
 //test
 
 }
 
+void SMACrossoverStrategy::advanceTo(const ColumnView<double>& close, size_t index) {
+    bool sameSeries = close.data() == series_;
+    if (sameSeries && index + 1 == nextIndex_) {
+        return;  // same bar asked again
+    }
+
+    if (!sameSeries || index != nextIndex_) {
+        // not the next bar: start over from the oldest bar the longer average needs
+        shortMA_.reset();
+        longMA_.reset();
+        size_t window = static_cast<size_t>(std::max(short_period_, long_period_));
+        series_ = close.data();
+        nextIndex_ = index + 1 >= window ? index + 1 - window : 0;
+    }
+
+    for (; nextIndex_ <= index; nextIndex_++) {
+        shortMA_.update(close[nextIndex_]);
+        longMA_.update(close[nextIndex_]);
+    }
+}
+
+void SMACrossoverStrategy::analyzeRange(const MarketData& data, size_t first, size_t last, Signal* out) {
+    if (first > last || last > data.size()) {
+        throw std::out_of_range("range out of range");
+    }
+    if (first == last) {
+        return;
+    }
+
+    // start where analyze(data, first) would rebuild from
+    size_t window = static_cast<size_t>(std::max(short_period_, long_period_));
+    size_t start = first + 1 >= window ? first + 1 - window : 0;
+
+    if (useCache_) {
+        // keyed by the bars [start, last), so every sweep task over the same
+        // data shares each average
+        MarketData bars = data.slice(start, last - start);
+        IndicatorCache::Series shortMA = bars.indicator(IndicatorKind::SMA, static_cast<size_t>(short_period_));
+        IndicatorCache::Series longMA = bars.indicator(IndicatorKind::SMA, static_cast<size_t>(long_period_));
+        SignalKernels::crossover(shortMA->data() + (first - start), longMA->data() + (first - start),
+                                 last - first, out);
+        return;
+    }
+
+    ColumnView<double> close = data.close().subview(start, last - start);
+
+    // Layout::Rows has no plain close array, gather one
+    std::vector<double> gathered;
+    if (!close.isContiguous()) {
+        gathered.resize(close.size());
+        close.copyTo(gathered.data());
+    }
+    const double* series = close.isContiguous() ? close.data() : gathered.data();
+
+    SignalKernels::smaCrossover(series, close.size(), static_cast<size_t>(short_period_),
+                                static_cast<size_t>(long_period_), first - start, out);
+}
+
+void SMACrossoverStrategy::setIndicatorCache(bool enabled) {
+    useCache_ = enabled;
+}
+
+size_t SMACrossoverStrategy::lookback() const {
+    return static_cast<size_t>(std::max(std::max(short_period_, long_period_), 1));
+}
+
 double SMACrossoverStrategy::calculateMA(const MarketData& data, size_t index, int period) {
     //index: Which day we're currently analyzing (like "Day 5")
     //period: How many recent days to average (like "3 days")
@@ -15,17 +86,46 @@ double SMACrossoverStrategy::calculateMA(const MarketData& data, size_t index, i
         return 0.0;
     }
 
+    // contiguous in Layout::Columns, so only the close prices get pulled into cache
+    ColumnView<double> close = data.close();
     double sum = 0.0;
     for (int i = 0; i < period; i++) {
         size_t bar_index = index - i;
-        sum += data.getBar(bar_index).close;
+        sum += close[bar_index];
     }
     return sum/period;
 }
 
 Signal SMACrossoverStrategy::analyze(const MarketData& data, size_t index) {
-    double short_MA = calculateMA(data, index, short_period_);
-    double long_MA = calculateMA(data, index, long_period_ );
+    if (index >= data.size()) {
+        throw std::out_of_range("index out of range");
+    }
+
+    advanceTo(data.close(), index);
+    return signal();
+}
+
+Signal SMACrossoverStrategy::onBar(const Bar& bar) {
+    if (series_ != nullptr) {
+        // the averages were built by analyze()
+        resetBars();
+    }
+    shortMA_.update(bar.close);
+    longMA_.update(bar.close);
+    return signal();
+}
+
+void SMACrossoverStrategy::resetBars() {
+    shortMA_.reset();
+    longMA_.reset();
+    series_ = nullptr;
+    nextIndex_ = 0;
+}
+
+Signal SMACrossoverStrategy::signal() const {
+    // 0.0 while there aren't enough bars yet, same as calculateMA
+    double short_MA = shortMA_.ready() ? shortMA_.value() : 0.0;
+    double long_MA = longMA_.ready() ? longMA_.value() : 0.0;
     
     if (short_MA == 0.0 || long_MA == 0.0) {
         return Signal::Hold;
@@ -0,0 +1,37 @@
+#include "strategy.h"
+#include <stdexcept>
+
+void Strategy::analyzeRange(const MarketData& data, size_t first, size_t last, Signal* out) {
+    if (first > last || last > data.size()) {
+        throw std::out_of_range("range out of range");
+    }
+    for (size_t i = first; i < last; i++) {
+        out[i - first] = analyze(data, i);
+    }
+}
+
+size_t Strategy::lookback() const {
+    return 0;
+}
+
+std::vector<Signal> Strategy::analyzeAll(const MarketData& data) {
+    std::vector<Signal> signals(data.size());
+    analyzeRange(data, 0, data.size(), signals.data());
+    return signals;
+}
+
+Signal Strategy::onBar(const Bar& bar) {
+    if (!bars_) {
+        size_t bars = lookback();
+        if (bars == 0) {
+            throw std::logic_error("Strategy::onBar: strategy doesn't declare its lookback()");
+        }
+        // small enough to stay in cache, moves every 7 * lookback bars
+        bars_.reset(new BarWindow(bars, 8 * bars));
+    }
+    return analyze(bars_->view(), bars_->push(bar));
+}
+
+void Strategy::resetBars() {
+    bars_.reset();
+}
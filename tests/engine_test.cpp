@@ -0,0 +1,196 @@
+#include "test_util.h"
+#include "backtest_engine.h"
+#include "monte_carlo.h"
+#include "multi_asset_portfolio.h"
+#include "parameter_sweep.h"
+#include "rsi_strategy.h"
+#include "sma_crossover_strategy.h"
+#include "walk_forward.h"
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+void addPair(BacktestEngine& engine) {
+    engine.addStrategy("SMA", std::unique_ptr<Strategy>(new SMACrossoverStrategy(10, 40)), Portfolio(10000.0));
+    engine.addStrategy("RSI", std::unique_ptr<Strategy>(new RSIStrategy(14)), Portfolio(10000.0));
+}
+
+bool sameRuns(const BacktestEngine& a, const BacktestEngine& b) {
+    bool same = a.size() == b.size();
+    for (size_t slot = 0; same && slot < a.size(); slot++) {
+        same = a.getReturn(slot) == b.getReturn(slot)
+            && a.getStats(slot).signalChanges == b.getStats(slot).signalChanges
+            && a.getPortfolio(slot).getTradeHistory().size() == b.getPortfolio(slot).getTradeHistory().size();
+    }
+    return same;
+}
+
+void testBatchMatchesPerBar() {
+    MarketData data(makeBars(5000), MarketData::Layout::Columns);
+
+    // whole-series signal columns equal analyze() bar by bar
+    SMACrossoverStrategy smaByIndex(10, 40), smaBatch(10, 40);
+    RSIStrategy rsiByIndex(14), rsiBatch(14);
+    std::vector<Signal> smaSignals = smaBatch.analyzeAll(data);
+    std::vector<Signal> rsiSignals = rsiBatch.analyzeAll(data);
+    for (size_t i = 0; i < data.size(); i++) {
+        CHECK(smaSignals[i] == smaByIndex.analyze(data, i));
+        CHECK(rsiSignals[i] == rsiByIndex.analyze(data, i));
+    }
+
+    BacktestEngine perBar(data);
+    addPair(perBar);
+    perBar.run(BacktestEngine::Mode::PerBar);
+    BacktestEngine batch(data);
+    addPair(batch);
+    batch.run(BacktestEngine::Mode::Batch);
+    CHECK(sameRuns(perBar, batch));
+    CHECK(perBar.getPortfolio(0).getTradeHistory().size() > 0);
+}
+
+void testStreamingMatchesInMemory() {
+    std::string file = "/tmp/backtester_engine_test_" + std::to_string(::getpid()) + ".csv";
+    std::vector<Bar> bars = makeBars(5000, 11);
+    CHECK(writeCsv(file, bars));
+    MarketData data;
+    CHECK(data.loadFromFileMapped(file));
+
+    BacktestEngine inMemory(data);
+    addPair(inMemory);
+    inMemory.run();
+
+    // a small window, so the newest bars get moved to the front many times
+    BacktestEngine streaming;
+    addPair(streaming);
+    BarSource source;
+    CHECK(source.open(file));
+    streaming.runStreaming(source, 64);
+    CHECK(streaming.barsProcessed() == bars.size());
+    CHECK(sameRuns(inMemory, streaming));
+
+    std::remove(file.c_str());
+}
+
+void testMultiAssetMatchesPortfolio() {
+    MarketData data(makeBars(3000, 5), MarketData::Layout::Columns);
+    BacktestEngine engine(data);
+    engine.addStrategy("SMA", std::unique_ptr<Strategy>(new SMACrossoverStrategy(3, 5)), Portfolio(10000.0));
+    engine.run();
+
+    MultiAssetPortfolio book(10000.0, 1);
+    std::vector<Signal> signals = SMACrossoverStrategy(3, 5).analyzeAll(data);
+    for (size_t i = 0; i < data.size(); i++) {
+        double close = data.close()[i];
+        book.markPrices(&close);
+        book.executeSignals(&signals[i], i);
+    }
+    CHECK(book.getReturn() == engine.getReturn(0));
+}
+
+void testSweepThreadCounts() {
+    MarketData data(makeBars(3000, 3), MarketData::Layout::Columns);
+    std::vector<SMAParams> grid = ParameterSweep::smaGrid(2, 10, 11, 30, 3);
+    ThreadPool single(1);
+    ThreadPool several(4);
+    std::vector<SweepResult> a = ParameterSweep(data, 10000.0, single).runSMA(grid);
+    std::vector<SweepResult> b = ParameterSweep(data, 10000.0, several).runSMA(grid);
+    CHECK(a.size() == grid.size() && b.size() == grid.size());
+    for (size_t i = 0; i < a.size() && i < b.size(); i++) {
+        CHECK(a[i].returnPercent == b[i].returnPercent && a[i].trades == b[i].trades);
+    }
+    // the factory path gives the same results as the typed one
+    std::vector<SweepResult> generic = ParameterSweep(data, 10000.0, single).run(grid.size(), [&grid](size_t i) {
+        return std::unique_ptr<Strategy>(new SMACrossoverStrategy(grid[i].shortPeriod, grid[i].longPeriod));
+    });
+    for (size_t i = 0; i < a.size(); i++) {
+        CHECK(generic[i].returnPercent == a[i].returnPercent);
+    }
+}
+
+void testWalkForwardStitch() {
+    MarketData data(makeBars(1000, 9), MarketData::Layout::Columns);
+    std::vector<SMAParams> grid = ParameterSweep::smaGrid(2, 8, 9, 20, 2);
+
+    // back to back, overlapping and the last fold cut short by the data:
+    // always one equity value per bar from the first test bar on
+    const size_t steps[] = {0, 50, 25, 7};
+    for (size_t step : steps) {
+        WalkForward walkForward(data, 10000.0);
+        walkForward.setWindows(200, 50, step);
+        WalkForwardResult result = walkForward.runSMA(grid);
+        CHECK(!result.folds.empty());
+        if (result.folds.empty()) {
+            continue;
+        }
+        CHECK(result.equity.size() == data.size() - result.folds.front().testBegin);
+        CHECK(result.folds.back().testEnd == data.size());
+    }
+
+    // longer steps would leave bars out of the curve
+    WalkForward walkForward(data, 10000.0);
+    bool threw = false;
+    try {
+        walkForward.setWindows(200, 50, 60);
+    }
+    catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    CHECK(threw);
+}
+
+void testMonteCarloThreadCounts() {
+    MarketData data(makeBars(500, 13), MarketData::Layout::Columns);
+    ThreadPool single(1);
+    ThreadPool several(4);
+    MonteCarlo one(10000.0, single);
+    MonteCarlo many(10000.0, several);
+    one.setBatchSize(7);  // batches split differently on the two pools
+    many.setBatchSize(16);
+
+    MonteCarloResult a = one.bootstrap(data, MonteCarlo::sma(3, 5), 200, 5);
+    MonteCarloResult b = many.bootstrap(data, MonteCarlo::sma(3, 5), 200, 5);
+    CHECK(a.returns == b.returns);
+    CHECK(a.drawdowns == b.drawdowns);
+    CHECK(a.actualReturn == b.actualReturn);
+
+    GBMParams params = MonteCarlo::fitGBM(data);
+    MonteCarloResult c = one.gbm(params, data.size(), MonteCarlo::rsi(14), 200);
+    MonteCarloResult d = many.gbm(params, data.size(), MonteCarlo::rsi(14), 200);
+    CHECK(c.returns == d.returns);
+    CHECK(c.drawdowns == d.drawdowns);
+
+    Portfolio traded(10000.0);
+    std::vector<Signal> signals = SMACrossoverStrategy(3, 5).analyzeAll(data);
+    for (size_t i = 0; i < data.size(); i++) {
+        if (signals[i] != Signal::Hold) {
+            traded.executeSignal(signals[i], data.close()[i], i);
+        }
+    }
+    MonteCarloResult e = one.shuffleTrades(traded.getTradeHistory(), 10000.0, 200);
+    MonteCarloResult f = many.shuffleTrades(traded.getTradeHistory(), 10000.0, 200);
+    CHECK(e.drawdowns == f.drawdowns);
+    // reordering can't move the final return, so there is no interval for it
+    CHECK(!e.hasReturns && e.returns.empty());
+
+    // another seed gives other paths
+    many.setSeed(43);
+    CHECK(many.bootstrap(data, MonteCarlo::sma(3, 5), 200, 5).returns != a.returns);
+}
+
+}
+
+int main() {
+    testBatchMatchesPerBar();
+    testStreamingMatchesInMemory();
+    testMultiAssetMatchesPortfolio();
+    testSweepThreadCounts();
+    testWalkForwardStitch();
+    testMonteCarloThreadCounts();
+    if (testFailures() == 0) {
+        std::cout << "engine_test: all checks passed" << std::endl;
+    }
+    return testFailures() == 0 ? 0 : 1;
+}
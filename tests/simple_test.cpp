@@ -0,0 +1,151 @@
+#include "test_util.h"
+#include "bar_cache.h"
+#include "indicator_cache.h"
+#include "rsi_strategy.h"
+#include "sma_crossover_strategy.h"
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+void testLoadersAgree() {
+    std::string file = dataFile("daily_AAPL.csv");
+    MarketData stream;
+    MarketData mapped;
+    MarketData parallel;
+    CHECK(stream.loadFromFile(file));
+    CHECK(mapped.loadFromFileMapped(file));
+    CHECK(parallel.loadFromFileParallel(file, 3));
+    CHECK(stream.size() > 0);
+    CHECK(sameBars(stream, mapped));
+    CHECK(sameBars(stream, parallel));
+
+    // oldest first whatever the file order
+    for (size_t i = 1; i < stream.size(); i++) {
+        CHECK(stream.getBar(i - 1).timestamp < stream.getBar(i).timestamp);
+    }
+}
+
+void testBinaryCache() {
+    std::string file = "/tmp/backtester_test_" + std::to_string(::getpid()) + ".csv";
+    std::vector<Bar> bars = makeBars(5000);
+    CHECK(writeCsv(file, bars));
+
+    // the first load parses the CSV and writes the sidecar, the second reads it
+    MarketData parsed(file, MarketData::Layout::Columns);
+    MarketData cached;
+    cached.setLayout(MarketData::Layout::Columns);
+    CHECK(cached.loadFromCache(file));
+    CHECK(sameBars(parsed, cached));
+    CHECK(cached.size() == bars.size());
+    for (size_t i = 0; i < bars.size(); i++) {
+        CHECK(sameBar(cached.getBar(i), bars[i]));
+    }
+
+    // a cache whose header promises more rows than the file holds is refused
+    std::string sidecar = BarCache::sidecarPath(file);
+    std::FILE* out = std::fopen(sidecar.c_str(), "r+b");
+    CHECK(out != nullptr);
+    if (out != nullptr) {
+        uint64_t rows = 1ULL << 61;
+        std::fseek(out, 24, SEEK_SET);  // CacheHeader::rowCount
+        std::fwrite(&rows, sizeof(rows), 1, out);
+        std::fclose(out);
+        MarketData corrupt;
+        CHECK(!corrupt.loadFromCache(file));
+    }
+
+    std::remove(sidecar.c_str());
+    std::remove(file.c_str());
+}
+
+void testSliceByTime() {
+    MarketData data(makeBars(100), MarketData::Layout::Columns);
+    const int64_t minute = MarketData::kMinute;
+
+    // [from, to): a bar exactly at `from` is in, one exactly at `to` is out
+    MarketData window = data.sliceByTime(10 * minute, 20 * minute);
+    CHECK(window.size() == 10);
+    CHECK(window.getBar(0).timestamp == 10 * minute);
+    CHECK(window.getBar(window.size() - 1).timestamp == 19 * minute);
+
+    // bounds between bars round up to the next one
+    MarketData between = data.sliceByTime(10 * minute + 1, 20 * minute + 1);
+    CHECK(between.size() == 10);
+    CHECK(between.getBar(0).timestamp == 11 * minute);
+
+    // past either end clamps, an empty or reversed range is empty
+    CHECK(data.sliceByTime(-1000 * minute, 1000 * minute).size() == 100);
+    CHECK(data.sliceByTime(100 * minute, 200 * minute).size() == 0);
+    CHECK(data.sliceByTime(-10 * minute, 0).size() == 0);
+    CHECK(data.sliceByTime(30 * minute, 30 * minute).size() == 0);
+    CHECK(data.sliceByTime(40 * minute, 30 * minute).size() == 0);
+
+    // a slice of a slice stays inside its parent
+    MarketData inner = window.sliceByTime(0, 15 * minute);
+    CHECK(inner.size() == 5);
+    CHECK(inner.getBar(0).timestamp == 10 * minute);
+    CHECK(window.lowerBound(25 * minute) == window.size());
+}
+
+void testIndicatorCache() {
+    MarketData data(makeBars(2000), MarketData::Layout::Columns);
+    IndicatorCache& cache = data.indicatorCache();
+    cache.clear();
+
+    IndicatorCache::Series first = data.indicator(IndicatorKind::SMA, 20);
+    IndicatorCacheStats afterMiss = cache.stats();
+    IndicatorCache::Series second = data.slice(0, data.size()).indicator(IndicatorKind::SMA, 20);
+    IndicatorCacheStats afterHit = cache.stats();
+    CHECK(afterHit.hits == afterMiss.hits + 1);
+    CHECK(first == second);  // the same shared series, not a recompute
+    CHECK(*first == IndicatorCache::compute(IndicatorKind::SMA, 20, data.close()));
+    CHECK(*data.indicator(IndicatorKind::RSI, 14) == IndicatorCache::compute(IndicatorKind::RSI, 14, data.close()));
+
+    // signals from the cached series equal the ones computed without it
+    SMACrossoverStrategy cachedSma(10, 40), plainSma(10, 40);
+    plainSma.setIndicatorCache(false);
+    CHECK(cachedSma.analyzeAll(data) == plainSma.analyzeAll(data));
+    RSIStrategy cachedRsi(14), plainRsi(14);
+    plainRsi.setIndicatorCache(false);
+    CHECK(cachedRsi.analyzeAll(data) == plainRsi.analyzeAll(data));
+}
+
+void testBarWindowIndicators() {
+    // a series asked for after a push covers the new bar, not a cached older one
+    BarWindow window(3, 8);
+    std::vector<Bar> bars = makeBars(20);
+    for (size_t i = 0; i < 4; i++) {
+        window.push(bars[i]);
+    }
+    double before = (*window.view().indicator(IndicatorKind::SMA, 3))[3];
+    CHECK(near(before, (bars[1].close + bars[2].close + bars[3].close) / 3.0));
+    size_t index = window.push(bars[4]);
+    double after = (*window.view().indicator(IndicatorKind::SMA, 3))[index];
+    CHECK(after == IndicatorCache::compute(IndicatorKind::SMA, 3, window.view().close())[index]);
+    CHECK(after != before);
+
+    // and across a move of the newest bars to the front
+    for (size_t i = 5; i < bars.size(); i++) {
+        index = window.push(bars[i]);
+    }
+    CHECK(window.compactions() > 0);
+    CHECK(window.view().getBar(index).close == bars.back().close);
+    double last = (*window.view().indicator(IndicatorKind::SMA, 3))[index];
+    CHECK(near(last, (bars[17].close + bars[18].close + bars[19].close) / 3.0));
+}
+
+}
+
+int main() {
+    testLoadersAgree();
+    testBinaryCache();
+    testSliceByTime();
+    testIndicatorCache();
+    testBarWindowIndicators();
+    if (testFailures() == 0) {
+        std::cout << "simple_test: all checks passed" << std::endl;
+    }
+    return testFailures() == 0 ? 0 : 1;
+}
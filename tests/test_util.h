@@ -0,0 +1,86 @@
+#pragma once
+
+#include "market_data.h"
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// checks count their failures instead of stopping, so one run reports every
+// broken check; a test's main() returns testFailures() for ctest
+inline int& testFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(condition)                                                                    \
+    do {                                                                                    \
+        if (!(condition)) {                                                                 \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #condition ") failed\n"; \
+            testFailures()++;                                                               \
+        }                                                                                   \
+    } while (0)
+
+// the sample data shipped in data/, set by tests/CMakeLists.txt
+inline std::string dataFile(const std::string& name) {
+    return std::string(BACKTESTER_DATA_DIR) + "/" + name;
+}
+
+// a random walk of one minute bars, the same for a seed on every machine
+inline std::vector<Bar> makeBars(size_t count, uint64_t seed = 7) {
+    std::vector<Bar> bars(count);
+    uint64_t state = seed * 0x9E3779B97F4A7C15ULL + 1;
+    double price = 100.0;
+    for (size_t i = 0; i < count; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        double step = (static_cast<double>(state >> 11) / 9007199254740992.0 - 0.5) * 0.02;
+        double open = price;
+        price *= 1.0 + step;
+        bars[i].timestamp = static_cast<int64_t>(i) * MarketData::kMinute;
+        bars[i].open = open;
+        bars[i].high = (open > price ? open : price) * 1.001;
+        bars[i].low = (open < price ? open : price) * 0.999;
+        bars[i].close = price;
+        bars[i].volume = static_cast<double>(1000 + (state & 0xFFF));
+    }
+    return bars;
+}
+
+// bars as a CSV BarSource and the loaders read, %.17g so they round trip
+inline bool writeCsv(const std::string& file, const std::vector<Bar>& bars) {
+    std::FILE* out = std::fopen(file.c_str(), "w");
+    if (!out) {
+        return false;
+    }
+    std::fputs("timestamp,open,high,low,close,volume\n", out);
+    for (const Bar& bar : bars) {
+        std::fprintf(out, "%s,%.17g,%.17g,%.17g,%.17g,%.17g\n", MarketData::formatTimestamp(bar.timestamp).c_str(),
+                     bar.open, bar.high, bar.low, bar.close, bar.volume);
+    }
+    return std::fclose(out) == 0;
+}
+
+// running sums may differ from a fresh window sum in the last bits
+inline bool near(double a, double b, double tolerance = 1e-9) {
+    return a - b <= tolerance && b - a <= tolerance;
+}
+
+inline bool sameBar(const Bar& a, const Bar& b) {
+    return a.timestamp == b.timestamp && a.open == b.open && a.high == b.high && a.low == b.low
+        && a.close == b.close && a.volume == b.volume;
+}
+
+inline bool sameBars(const MarketData& a, const MarketData& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (!sameBar(a.getBar(i), b.getBar(i))) {
+            return false;
+        }
+    }
+    return true;
+}